@@ -15,7 +15,7 @@
 #include "eckit/io/Offset.h"
 #include "eckit/io/PartFileHandle.h"
 
-#include "odc/core/TablesReader.h"
+#include "odc/core/FrameIndex.h"
 #include "odc/core/MetaData.h"
 #include "odc/Reader.h"
 #include "odc/RowsCounter.h"
@@ -32,15 +32,10 @@ BlockOffsets Indexer::offsetsOfBlocks(const PathName &db)
 {
     BlockOffsets r;
 
-    core::TablesReader reader(db);
-    auto it = reader.begin();
-    auto end = reader.end();
-	for (; it != end; ++it)
+    core::FrameIndex index(core::FrameIndex::forFile(db));
+    for (size_t i = 0; i < index.frameCount(); ++i)
     {
-        Offset offset = it->startPosition();
-        Length length = it->nextPosition() - it->startPosition();
-
-        r.push_back(std::make_pair(offset,length));
+        r.push_back(std::make_pair(index.frame(i).offset, index.frame(i).length));
     }
 
 	return r;
@@ -13,10 +13,14 @@
 
 #include <algorithm>
 #include <string>
+#include <thread>
+
+#include "eckit/config/Resource.h"
 
 #include "odc/LibOdc.h"
 
 #include "odc/ODBAPIVersion.h"
+#include "odc/core/ThreadPool.h"
 
 namespace odc {
 
@@ -42,6 +46,13 @@ std::string LibOdc::gitsha1(unsigned int count) const {
     return sha1.substr(0,std::min(count,40u));
 }
 
+core::ThreadPool& LibOdc::threadPool() const {
+    static long size = eckit::Resource<long>("$ODC_THREAD_POOL_SIZE;-threadPoolSize;threadPoolSize",
+                                             std::thread::hardware_concurrency());
+    static core::ThreadPool pool(std::max(size, 0L));
+    return pool;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 } // namespace eckit
@@ -18,6 +18,8 @@
 
 namespace odc {
 
+namespace core { class ThreadPool; }
+
 //----------------------------------------------------------------------------------------------------------------------
 
 class LibOdc : public eckit::system::Library {
@@ -31,6 +33,10 @@ public:
 
     virtual std::string gitsha1(unsigned int count) const;
 
+    /// The persistent pool of worker threads shared by the library for parallel work. Sized
+    /// by $ODC_THREAD_POOL_SIZE, defaulting to the number of hardware threads.
+    core::ThreadPool& threadPool() const;
+
 protected:
 
     const void* addr() const;
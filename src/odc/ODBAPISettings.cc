@@ -111,7 +111,21 @@ ODBAPISettings::ODBAPISettings()
 : headerBufferSize_(Resource<long>("$ODC_HEADER_BUFFER_SIZE;-headerBufferSize;headerBufferSize", 4 * 1024 * 1024)),
   setvbufferSize_(Resource<long>("$ODC_SETVBUFFER_SIZE;-setvbufferSize;setvbufferSize", 8 * 1024 * 1024)),
   useAIO_(Resource<bool>("$ODC_USE_AIO", false)),
-  integersAsDoubles_(Resource<bool>("$ODC_INTEGERS_AS_DOUBLES", true))
+  integersAsDoubles_(Resource<bool>("$ODC_INTEGERS_AS_DOUBLES", true)),
+  decodeBlockSize_(Resource<long>("$ODC_DECODE_BLOCK_SIZE;-decodeBlockSize;decodeBlockSize", 4096)),
+  readAheadFrames_(Resource<long>("$ODC_READ_AHEAD_FRAMES;-readAheadFrames;readAheadFrames", 0)),
+  readAheadMemory_(Resource<long>("$ODC_READ_AHEAD_MEMORY;-readAheadMemory;readAheadMemory", 256 * 1024 * 1024)),
+  writeFrameIndex_(Resource<bool>("$ODC_WRITE_FRAME_INDEX;-writeFrameIndex;writeFrameIndex", false)),
+  asyncWriterFlush_(Resource<bool>("$ODC_ASYNC_WRITER_FLUSH;-asyncWriterFlush;asyncWriterFlush", false)),
+  headerCacheSize_(Resource<long>("$ODC_HEADER_CACHE_SIZE;-headerCacheSize;headerCacheSize", 64)),
+  fastHeaderChecksum_(Resource<bool>("$ODC_FAST_HEADER_CHECKSUM;-fastHeaderChecksum;fastHeaderChecksum", false)),
+  trustedInput_(Resource<bool>("$ODC_TRUSTED_INPUT;-trustedInput;trustedInput", false)),
+  int24Codecs_(Resource<bool>("$ODC_INT24_CODECS;-int24Codecs;int24Codecs", false)),
+  xorRealCodecs_(Resource<bool>("$ODC_XOR_REAL_CODECS;-xorRealCodecs;xorRealCodecs", false)),
+  integerDictionaryCodecs_(Resource<bool>("$ODC_INTEGER_DICTIONARY_CODECS;-integerDictionaryCodecs;integerDictionaryCodecs", false)),
+  codecSampleRows_(Resource<long>("$ODC_CODEC_SAMPLE_ROWS;-codecSampleRows;codecSampleRows", 0)),
+  codecSizeWeight_(Resource<double>("$ODC_CODEC_SIZE_WEIGHT;-codecSizeWeight;codecSizeWeight", 1.0)),
+  codecDecodeWeight_(Resource<double>("$ODC_CODEC_DECODE_WEIGHT;-codecDecodeWeight;codecDecodeWeight", 0.0))
 {}
 
 size_t ODBAPISettings::headerBufferSize() { return headerBufferSize_; }
@@ -120,6 +134,88 @@ void ODBAPISettings::headerBufferSize(size_t n) { headerBufferSize_ = n; }
 size_t ODBAPISettings::setvbufferSize() { return setvbufferSize_; }
 void ODBAPISettings::setvbufferSize(size_t n) { setvbufferSize_ = n; }
 
+size_t ODBAPISettings::decodeBlockSize() const { return decodeBlockSize_; }
+void ODBAPISettings::decodeBlockSize(size_t n) { decodeBlockSize_ = n; }
+
+size_t ODBAPISettings::readAheadFrames() const { return readAheadFrames_; }
+void ODBAPISettings::readAheadFrames(size_t n) { readAheadFrames_ = n; }
+
+size_t ODBAPISettings::readAheadMemory() const { return readAheadMemory_; }
+void ODBAPISettings::readAheadMemory(size_t n) { readAheadMemory_ = n; }
+
+size_t ODBAPISettings::headerCacheSize() const { return headerCacheSize_; }
+
+bool ODBAPISettings::writeFrameIndex() const { return writeFrameIndex_; }
+void ODBAPISettings::writeFrameIndex(bool flag) { writeFrameIndex_ = flag; }
+
+bool ODBAPISettings::asyncWriterFlush() const { return asyncWriterFlush_; }
+void ODBAPISettings::asyncWriterFlush(bool flag) { asyncWriterFlush_ = flag; }
+
+bool ODBAPISettings::fastHeaderChecksum() const { return fastHeaderChecksum_; }
+void ODBAPISettings::fastHeaderChecksum(bool flag) { fastHeaderChecksum_ = flag; }
+
+bool ODBAPISettings::trustedInput() const { return trustedInput_; }
+void ODBAPISettings::trustedInput(bool flag) { trustedInput_ = flag; }
+
+bool ODBAPISettings::int24Codecs() const { return int24Codecs_; }
+void ODBAPISettings::int24Codecs(bool flag) { int24Codecs_ = flag; }
+
+bool ODBAPISettings::xorRealCodecs() const { return xorRealCodecs_; }
+void ODBAPISettings::xorRealCodecs(bool flag) { xorRealCodecs_ = flag; }
+
+bool ODBAPISettings::integerDictionaryCodecs() const { return integerDictionaryCodecs_; }
+void ODBAPISettings::integerDictionaryCodecs(bool flag) { integerDictionaryCodecs_ = flag; }
+
+size_t ODBAPISettings::codecSampleRows() const { return codecSampleRows_; }
+void ODBAPISettings::codecSampleRows(size_t n) { codecSampleRows_ = n; }
+
+double ODBAPISettings::codecSizeWeight() const { return codecSizeWeight_; }
+void ODBAPISettings::codecSizeWeight(double w) { codecSizeWeight_ = w; }
+
+double ODBAPISettings::codecDecodeWeight() const { return codecDecodeWeight_; }
+void ODBAPISettings::codecDecodeWeight(double w) { codecDecodeWeight_ = w; }
+
+void ODBAPISettings::copyFrom(const ODBAPISettings& other) {
+    if (&other == this) return;
+    headerBufferSize_ = other.headerBufferSize_;
+    setvbufferSize_ = other.setvbufferSize_;
+    useAIO_ = other.useAIO_;
+    integersAsDoubles_ = other.integersAsDoubles_;
+    decodeBlockSize_ = other.decodeBlockSize_;
+    readAheadFrames_ = other.readAheadFrames_;
+    readAheadMemory_ = other.readAheadMemory_;
+    writeFrameIndex_ = other.writeFrameIndex_;
+    asyncWriterFlush_ = other.asyncWriterFlush_;
+    headerCacheSize_ = other.headerCacheSize_;
+    fastHeaderChecksum_ = other.fastHeaderChecksum_;
+    trustedInput_ = other.trustedInput_;
+    int24Codecs_ = other.int24Codecs_;
+    xorRealCodecs_ = other.xorRealCodecs_;
+    integerDictionaryCodecs_ = other.integerDictionaryCodecs_;
+    codecSampleRows_ = other.codecSampleRows_;
+    codecSizeWeight_ = other.codecSizeWeight_;
+    codecDecodeWeight_ = other.codecDecodeWeight_;
+    home_ = other.home_;
+}
+
+std::shared_ptr<ODBAPISettings> ODBAPISettings::copy() const {
+    std::shared_ptr<ODBAPISettings> settings(new ODBAPISettings);
+    settings->copyFrom(*this);
+    return settings;
+}
+
+AdoptSettings::AdoptSettings(const ODBAPISettings& other) {
+    ODBAPISettings& current(ODBAPISettings::instance());
+    if (&other == &current) return;
+    saved_.reset(new ODBAPISettings);
+    saved_->copyFrom(current);
+    current.copyFrom(other);
+}
+
+AdoptSettings::~AdoptSettings() {
+    if (saved_) ODBAPISettings::instance().copyFrom(*saved_);
+}
+
 void ODBAPISettings::createDirectories(const PathName& path)
 {
     vector<string> parts (StringTools::split("/", path));
@@ -11,6 +11,8 @@
 #ifndef ODBAPISettings_H
 #define ODBAPISettings_H
 
+#include <memory>
+
 #include "eckit/thread/ThreadSingleton.h"
 #include "eckit/io/Length.h"
 
@@ -41,6 +43,71 @@ public:
     void treatIntegersAsDoubles(bool flag);
     bool integersAsDoubles() const;
 
+    /// Number of rows decoded together by Table::decode. Zero selects row-by-row decoding.
+    size_t decodeBlockSize() const;
+    void decodeBlockSize(size_t);
+
+    /// Number of tables that TablesReader reads ahead in a background thread. Zero disables read-ahead.
+    size_t readAheadFrames() const;
+    void readAheadFrames(size_t);
+
+    /// Maximum number of bytes of encoded data prefetched by each TablesReader
+    size_t readAheadMemory() const;
+    void readAheadMemory(size_t);
+
+    /// Maximum number of parsed table headers held by the HeaderCache. Zero disables the cache.
+    size_t headerCacheSize() const;
+
+    /// Whether writers emit a frame index (<file>.odcidx) alongside the files that they write
+    bool writeFrameIndex() const;
+    void writeFrameIndex(bool);
+
+    /// Whether writers encode and write full buffers of rows in a background thread, while the next
+    /// buffer is filled. The output is unchanged.
+    bool asyncWriterFlush() const;
+    void asyncWriterFlush(bool);
+
+    /// Whether writers checksum table headers with xxHash64 (format version 0.6) rather than MD5
+    bool fastHeaderChecksum() const;
+    void fastHeaderChecksum(bool);
+
+    /// Whether the CodecOptimizer may select the 24-bit integer codecs. Tables that use them are
+    /// written as format version 0.7, and cannot be read by older versions of the library.
+    bool int24Codecs() const;
+    void int24Codecs(bool);
+
+    /// Whether the CodecOptimizer may select the xor_real codec for REAL and DOUBLE columns, where
+    /// it is smaller. Tables that use it are written as format version 0.8.
+    bool xorRealCodecs() const;
+    void xorRealCodecs(bool);
+
+    /// Whether integer statistics track the distinct values in each column, so that the CodecOptimizer
+    /// may select the integer dictionary codecs. Tables that use them are written as format version 0.9.
+    bool integerDictionaryCodecs() const;
+    void integerDictionaryCodecs(bool);
+
+    /// Number of rows of each column that the CodecOptimizer trial-encodes with each candidate codec,
+    /// to choose between them by cost. Zero chooses the codecs from the column statistics alone.
+    size_t codecSampleRows() const;
+    void codecSampleRows(size_t);
+
+    /// Weights of the encoded size (bytes per value) and decode time (nanoseconds per value) in the
+    /// cost of each candidate codec. The default chooses by size alone, so that the output is reproducible.
+    double codecSizeWeight() const;
+    void codecSizeWeight(double);
+    double codecDecodeWeight() const;
+    void codecDecodeWeight(double);
+
+    /// Skip verification of the table header checksums when reading. Only for data from trusted sources.
+    bool trustedInput() const;
+    void trustedInput(bool);
+
+    /// The settings are per-thread. Adopt the settings of another thread, when working on its behalf.
+    void copyFrom(const ODBAPISettings& other);
+
+    /// A copy of the settings, to be adopted by another thread once this thread may have changed them.
+    std::shared_ptr<ODBAPISettings> copy() const;
+
 	static bool debug;
 
 private:
@@ -53,11 +120,39 @@ private:
 
 	bool useAIO_;
     bool integersAsDoubles_;
+    size_t decodeBlockSize_;
+    size_t readAheadFrames_;
+    size_t readAheadMemory_;
+    bool writeFrameIndex_;
+    bool asyncWriterFlush_;
+    size_t headerCacheSize_;
+    bool fastHeaderChecksum_;
+    bool trustedInput_;
+    bool int24Codecs_;
+    bool xorRealCodecs_;
+    bool integerDictionaryCodecs_;
+    size_t codecSampleRows_;
+    double codecSizeWeight_;
+    double codecDecodeWeight_;
 
     friend struct eckit::NewAlloc0<ODBAPISettings>;
+    friend class AdoptSettings;
     std::string home_;
 };
 
+/// Adopts the settings of another thread for the lifetime of the object, restoring the previous
+/// settings of this thread afterwards. For work done on behalf of other threads by a shared thread,
+/// such as a worker of the ThreadPool.
+
+class AdoptSettings : private eckit::NonCopyable {
+public:
+    AdoptSettings(const ODBAPISettings& other);
+    ~AdoptSettings();
+
+private:
+    std::unique_ptr<ODBAPISettings> saved_;
+};
+
 } // namespace odc
 
 #endif
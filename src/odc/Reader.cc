@@ -32,7 +32,8 @@ Reader::Reader()
 Reader::Reader(Reader&& rhs) :
     dataHandle_(rhs.dataHandle_),
     deleteDataHandle_(rhs.deleteDataHandle_),
-    path_(std::move(rhs.path_)) {
+    path_(std::move(rhs.path_)),
+    filter_(std::move(rhs.filter_)) {
 
     rhs.dataHandle_ = 0;
     rhs.deleteDataHandle_ = false;
@@ -42,6 +43,7 @@ Reader& Reader::operator=(Reader&& rhs) {
     std::swap(dataHandle_, rhs.dataHandle_);
     std::swap(deleteDataHandle_, rhs.deleteDataHandle_);
     std::swap(path_, rhs.path_);
+    std::swap(filter_, rhs.filter_);
     return *this;
 }
 
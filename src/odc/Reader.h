@@ -22,6 +22,7 @@
 
 #include "odc/IteratorProxy.h"
 #include "odc/ReaderIterator.h"
+#include "odc/core/RangeFilter.h"
 #include "eckit/filesystem/PathName.h"
 
 namespace eckit { class DataHandle; }
@@ -59,11 +60,17 @@ public:
     // For the iterator to signal all data has been slurped.
     void noMoreData();
 
+    /// Tables whose header statistics show that no row can meet the filter are skipped without
+    /// decoding. The first table is always read, as it describes the columns.
+    void rangeFilter(const core::RangeFilter& filter) { filter_ = filter; }
+    const core::RangeFilter& rangeFilter() const { return filter_; }
+
 private:
 
 	eckit::DataHandle* dataHandle_;
 	bool deleteDataHandle_;
     eckit::PathName path_;
+    core::RangeFilter filter_;
 
 	friend class IteratorProxy<ReaderIterator,Reader,const double>;
 	friend class ReaderIterator;
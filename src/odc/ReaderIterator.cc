@@ -12,6 +12,7 @@
 #include "eckit/log/Log.h"
 
 #include "odc/core/Codec.h"
+#include "odc/core/Encoder.h"
 #include "odc/core/Header.h"
 #include "odc/LibOdc.h"
 #include "odc/Reader.h"
@@ -95,6 +96,11 @@ bool ReaderIterator::loadHeaderAndBufferData() {
         Header header(columns_, properties_);
         header.loadAfterMagic(*f_);
 
+        // If the columns were reordered when they were encoded, present them in the original
+        // order. They are still decoded in the order that they are stored.
+
+        columnPositions_ = restoreColumnOrder(columns_, properties_);
+
         byteOrder_ = header.byteOrder();
         rowDataSizeDoubles_ = rowDataSizeDoublesInternal();
         ++headerCounter_;
@@ -112,6 +118,15 @@ bool ReaderIterator::loadHeaderAndBufferData() {
 
         if (dataSize == 0) {
             ASSERT(header.rowsNumber() == 0);
+        } else if (headerCounter_ > 1 && !owner_.rangeFilter().mayMatch(columns_)) {
+
+            // The header statistics show that no row can meet the filter. Skip over the data.
+
+            if (f_->canSeek()) {
+                f_->seek(f_->position() + eckit::Offset(dataSize));
+            } else if (!readBuffer(dataSize)) {
+                throw SeriousBug("Expected row data to follow table header");
+            }
         } else {
 
             // Read the expected data into the rows buffer.
@@ -158,6 +173,7 @@ void ReaderIterator::initRowBuffer()
 
     codecs_.clear();
     codecs_.resize(nCols, 0);
+    codecOffsets_.resize(nCols);
 
     delete [] columnOffsets_;
     columnOffsets_ = new size_t[nCols];
@@ -165,8 +181,10 @@ void ReaderIterator::initRowBuffer()
     size_t offset = 0;
 	for(size_t i = 0; i < nCols; i++)
 	{
-		codecs_[i] = &columns()[i]->coder();
-        lastValues_[offset] = codecs_[i]->missingValue();
+        size_t stored = columnPositions_.empty() ? i : columnPositions_[i];
+        codecs_[stored] = &columns()[i]->coder();
+        codecOffsets_[stored] = offset;
+        lastValues_[offset] = codecs_[stored]->missingValue();
         columnOffsets_[i] = offset;
         offset += columns()[i]->dataSizeDoubles();
     }
@@ -220,7 +238,7 @@ bool ReaderIterator::next()
 
 	size_t nCols = columns().size();
     for(size_t i = startCol; i < nCols; i++) {
-        codecs_[i]->decode(&lastValues_[columnOffsets_[i]]);
+        codecs_[i]->decode(&lastValues_[codecOffsets_[i]]);
     }
 
 	++nrows_ ;
@@ -108,7 +108,9 @@ private:
 	double* lastValues_;
     size_t* columnOffsets_; // in doubles
     size_t rowDataSizeDoubles_;
-    std::vector<core::Codec*> codecs_;
+    std::vector<core::Codec*> codecs_;        // in the order that the columns are stored
+    std::vector<size_t> codecOffsets_;        // in doubles
+    std::vector<size_t> columnPositions_;     // if the stored columns were reordered
 	unsigned long long nrows_;
     size_t rowsRemainingInTable_;
 
@@ -9,8 +9,8 @@
  */
 
 #include "eckit/eckit.h"
+#include "odc/core/FrameIndex.h"
 #include "odc/core/MetaData.h"
-#include "odc/core/TablesReader.h"
 #include "odc/Reader.h"
 #include "odc/RowsCounter.h"
 
@@ -20,15 +20,8 @@ namespace odc {
 
 unsigned long long RowsCounter::fastRowCount(const PathName &db)
 {
-	unsigned long long n = 0;
-
-    core::TablesReader reader(db);
-
-    auto it = reader.begin();
-    auto end = reader.end();
-	for (; it != end; ++it)
-        n += it->rowCount();
-	return n;
+    // Uses the frame index if available, otherwise scans the headers
+    return core::FrameIndex::forFile(db).rowCount();
 }
 
 
@@ -16,6 +16,9 @@
 #ifndef ODAWRITER_H
 #define ODAWRITER_H
 
+#include <string>
+#include <vector>
+
 #include "odc/IteratorProxy.h"
 #include "odc/WriterBufferingIterator.h"
 
@@ -47,7 +50,11 @@ public:
 	ITERATOR* createWriteIterator(eckit::PathName, bool append = false);
 
 	unsigned long rowsBufferSize() { return rowsBufferSize_; }
-	Writer& rowsBufferSize(unsigned long n) { rowsBufferSize_ = n; }
+	Writer& rowsBufferSize(unsigned long n) { rowsBufferSize_ = n; return *this; }
+
+	/// Columns on which the rows of each table are (stably) sorted before they are encoded
+	const std::vector<std::string>& sortKeys() const { return sortKeys_; }
+	Writer& sortKeys(const std::vector<std::string>& keys) { sortKeys_ = keys; return *this; }
 
 	const eckit::PathName path() { return path_; }
 
@@ -59,6 +66,7 @@ private:
 	const eckit::PathName path_;
 	eckit::DataHandle* dataHandle_;
 	unsigned long rowsBufferSize_;
+	std::vector<std::string> sortKeys_;
 
 	bool openDataHandle_;
 	bool deleteDataHandle_;
@@ -17,8 +17,11 @@
 #include "eckit/io/DataHandle.h"
 #include "eckit/log/Log.h"
 
+#include "odc/core/CodecFactory.h"
+#include "odc/core/Encoder.h"
 #include "odc/core/Header.h"
 #include "odc/LibOdc.h"
+#include "odc/ODBAPISettings.h"
 #include "odc/WriterBufferingIterator.h"
 #include "odc/Writer.h"
 
@@ -44,9 +47,15 @@ WriterBufferingIterator::WriterBufferingIterator(Owner &owner, DataHandle *dh, b
     initialisedColumns_(false),
     properties_(),
     rowsBuffer_(0),
-    nextRowInBuffer_(0),
+    rowCapacity_(0),
+    bufferedRows_(0),
     rowsBufferSize_(owner.rowsBufferSize()),
+    sortKeys_(owner.sortKeys()),
     tableDef_(tableDef),
+    writeFrameIndex_(ODBAPISettings::instance().writeFrameIndex() && !path_.asString().empty() &&
+                     path_.asString() != "/dev/stdout" && path_.asString() != "stdout"),
+    frameOffset_(0),
+    asyncFlush_(ODBAPISettings::instance().asyncWriterFlush()),
     openDataHandle_(openDataHandle)
 {
 	if (openDataHandle)
@@ -67,9 +76,15 @@ WriterBufferingIterator::WriterBufferingIterator(Owner &owner, DataHandle &dh, b
     initialisedColumns_(false),
     properties_(),
     rowsBuffer_(0),
-    nextRowInBuffer_(0),
+    rowCapacity_(0),
+    bufferedRows_(0),
     rowsBufferSize_(owner.rowsBufferSize()),
+    sortKeys_(owner.sortKeys()),
     tableDef_(tableDef),
+    writeFrameIndex_(ODBAPISettings::instance().writeFrameIndex() && !path_.asString().empty() &&
+                     path_.asString() != "/dev/stdout" && path_.asString() != "stdout"),
+    frameOffset_(0),
+    asyncFlush_(ODBAPISettings::instance().asyncWriterFlush()),
     openDataHandle_(openDataHandle)
 {
     if (openDataHandle)
@@ -100,7 +115,17 @@ unsigned long WriterBufferingIterator::gatherStats(const double* values, unsigne
 
 int WriterBufferingIterator::setOptimalCodecs()
 {
-    return codecOptimizer_.setOptimalCodecs<SameByteOrder>(const_cast<MetaData&>(columns()));
+    // The staged rows are supplied, so that the codecs may be chosen by trial encoding (if enabled)
+
+    std::vector<api::ConstStridedData> staged;
+    if (ODBAPISettings::instance().codecSampleRows() != 0) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            size_t width = columns_[i]->dataSizeDoubles() * sizeof(double);
+            staged.emplace_back(stagedColumn(i), bufferedRows_, width, width);
+        }
+    }
+
+    return codecOptimizer_.setOptimalCodecs<SameByteOrder>(const_cast<MetaData&>(columns()), staged);
 }
 
 void WriterBufferingIterator::allocBuffers()
@@ -154,7 +179,8 @@ void WriterBufferingIterator::allocRowsBuffer()
     rowDataSizeDoubles_ = rowDataSizeDoublesInternal();
     rowByteSize_ = rowDataSizeDoubles() * sizeof(double);
     rowsBuffer_ = Buffer(rowsBufferSize_ * rowByteSize_);
-    nextRowInBuffer_ = reinterpret_cast<unsigned char*>(rowsBuffer_.data());
+    rowCapacity_ = rowsBufferSize_;
+    bufferedRows_ = 0;
 }
 
 void WriterBufferingIterator::writeHeader()
@@ -169,7 +195,8 @@ void WriterBufferingIterator::writeHeader()
         rowDataSizeDoubles_ = 0;
         rowByteSize_ = 0;
         rowsBuffer_ = eckit::Buffer(0);
-        nextRowInBuffer_ = nullptr;
+        rowCapacity_ = 0;
+        bufferedRows_ = 0;
     }
 
     for (size_t i = 0; i < columns_.size(); ++i) {
@@ -204,14 +231,18 @@ int WriterBufferingIterator::writeRow(const double* data, unsigned long nCols)
     if (rowsBuffer_.size() == 0)
 		allocRowsBuffer();
 
-	gatherStats(data, nCols);
+    // n.b. The statistics are gathered a column at a time, when the buffer is flushed
 
-    std::copy(data, data + rowDataSizeDoubles(), reinterpret_cast<double*>(nextRowInBuffer_));
-    nextRowInBuffer_ += rowByteSize_;
+    for (size_t i = 0; i < nCols; ++i) {
+        const size_t width = columnByteSizes_[i] / sizeof(double);
+        const double* value = &data[columnOffsets_[i]];
+        std::copy(value, value + width, stagedColumn(i) + bufferedRows_ * width);
+    }
+    ++bufferedRows_;
 
-    ASSERT((char*)nextRowInBuffer_ <= rowsBuffer_ + rowsBuffer_.size());
+    ASSERT(bufferedRows_ <= rowCapacity_);
 
-    if ((char*)nextRowInBuffer_ == rowsBuffer_ + rowsBuffer_.size())
+    if (bufferedRows_ == rowCapacity_)
 		flush();
 
     return 0;
@@ -226,44 +257,6 @@ size_t WriterBufferingIterator::rowDataSizeDoublesInternal() const {
     return total;
 }
 
-int WriterBufferingIterator::doWriteRow(core::DataStream<core::SameByteOrder>& stream, const double* values)
-{
-    if (lastValues_ == 0) allocBuffers();
-
-    // Find where the first changing row is
-
-    // BUG: First row may not be properly encoded if it is zero.
-    uint16_t k = 0;
-    for (; k < columns().size(); ++k) {
-        if (::memcmp(&values[columnOffsets_[k]], &lastValues_[columnOffsets_[k]], columnByteSizes_[k]) != 0) break;
-    }
-
-    // Marker stores the starting column
-    // static_cast eliminates unecessary warnings due to % operator returning an int.
-
-    uint8_t marker[2] {
-        static_cast<uint8_t>((k / 256) % 256),
-        static_cast<uint8_t>(k % 256)
-    };
-    stream.writeBytes(marker, sizeof(marker)); // raw write
-
-    // TODO: Update Codecs to encode to a DataStream directly.
-    // n.b. We are relying on the sizing of the buffer behind stream to have been done correctly.
-    //      This is fundamentally unsafe. TODO: Do it properly.
-
-    char* p = stream.get();
-
-    for (size_t i = k; i < columns().size(); ++i)  {
-        p = columns_[i]->coder().encode(p, values[columnOffsets_[i]]);
-        ::memcpy(&lastValues_[columnOffsets_[i]], &values[columnOffsets_[i]], columnByteSizes_[i]);
-	}
-
-    stream.set(p);
-
-	nrows_++;
-	return 0;
-} 
-
 int WriterBufferingIterator::open()
 {
     //LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::open@" << this << ": Opening data handle " << handle() << std::endl;
@@ -324,62 +317,167 @@ void WriterBufferingIterator::missingValue(size_t i, double missingValue)
 void WriterBufferingIterator::flush()
 {
     ASSERT(initialisedColumns_);
-    if (nextRowInBuffer_ == rowsBuffer_ || rowsBuffer_.size() == 0)
+    if (bufferedRows_ == 0 || rowsBuffer_.size() == 0)
 		return;
 
-    setOptimalCodecs();
+    waitForFlush();
 
-    // n.b. ensure that we leave space for the header in the worst case (data doesn't compress at all)
-    Buffer encodedBuffer(rowsBuffer_.size() + (sizeof(uint16_t) * rowsBufferSize_));
-    core::DataStream<core::SameByteOrder> encodedStream(encodedBuffer);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        columns_[i]->coder().gatherStatsBlock(stagedColumn(i), bufferedRows_);
+    }
 
-    // Iterate over stored rows, and re-encode them into the encodedBuffer
+    setOptimalCodecs();
 
-    size_t rowsWritten = 0;
-    unsigned char* p = reinterpret_cast<unsigned char*>(rowsBuffer_.data());
-    while (p < nextRowInBuffer_) {
-        doWriteRow(encodedStream, reinterpret_cast<double *>(p));
-        p += rowByteSize_;
-        ++rowsWritten;
-    }
+    if (lastValues_ == 0) allocBuffers();
 
-    // Clean up storage buffers for row data
-    allocBuffers();
+    // Capture the buffered rows, and the state of the (optimised) columns needed to encode them.
+    // n.b. the codecs are copied, as the optimised codecs hold state such as string tables.
 
-    std::pair<Buffer, size_t> encodedHeader = serializeHeader(encodedStream.position(), rowsWritten);
-    ASSERT(encodedHeader.second <= encodedHeader.first.size());
+    std::unique_ptr<PendingTable> table(new PendingTable);
+    table->rowCount = bufferedRows_;
+    table->rowCapacity = rowCapacity_;
+    table->properties = properties_;
+    table->sortKeys = sortKeys_;
+    table->columns = columns_;
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        table->columns[i]->coder(CodecFactory::instance().copy(columns_[i]->coder()));
+    }
+    table->lastValues.assign(lastValues_, lastValues_ + rowDataSizeDoubles());
+    table->columnOffsets.assign(columnOffsets_, columnOffsets_ + columns_.size());
+    table->columnByteSizes.assign(columnByteSizes_, columnByteSizes_ + columns_.size());
 
-    LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::flush: header size: " << encodedHeader.second << std::endl;
+    // Swap in the rows buffer of the previously written table, if it is the right size
 
-    ASSERT(dataHandle().write(encodedHeader.first, encodedHeader.second) == long(encodedHeader.second)); // Write header
-    ASSERT(dataHandle().write(encodedBuffer, encodedStream.position()) == encodedStream.position()); // Write encoded data
+    table->rows = std::move(rowsBuffer_);
+    if (pendingTable_ && pendingTable_->rows.size() == table->rows.size()) {
+        rowsBuffer_ = std::move(pendingTable_->rows);
+    } else {
+        rowsBuffer_ = Buffer(table->rows.size());
+    }
+    pendingTable_.reset();
 
-    LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::flush: flushed " << rowsWritten << " rows." << std::endl;
+    // Clean up storage buffers for row data
+    allocBuffers();
 
     // Reset the write buffers
 
-    nextRowInBuffer_ = reinterpret_cast<unsigned char*>(rowsBuffer_.data());
+    bufferedRows_ = 0;
 
     // This is a bad place to be. We need to reset the coders in the columns, not clone
     // the existing ones (which have been optimised).
 
     columns_.resetCodecs<SameByteOrder>();
     columns_.resetStats();
+
+    // And encode and write the table. The settings are per-thread, so the background thread
+    // adopts a copy of those of this one, which may change them while the table is written.
+
+    PendingTable& pending(*table);
+    pendingTable_ = std::move(table);
+
+    if (asyncFlush_) {
+        std::shared_ptr<ODBAPISettings> settings(ODBAPISettings::instance().copy());
+        pendingFlush_ = std::async(std::launch::async, [this, &pending, settings] {
+            AdoptSettings adopt(*settings);
+            writeTable(pending);
+        });
+    } else {
+        writeTable(pending);
+    }
 }
 
+void WriterBufferingIterator::writeTable(PendingTable& table)
+{
+    const MetaData& columns(table.columns);
+    const size_t nrows = table.rowCount;
+    const size_t ncols = columns.size();
+
+    std::vector<ConstStridedData> data;
+    for (size_t i = 0; i < ncols; ++i) {
+        const double* values = reinterpret_cast<const double*>(table.rows.data()) + table.columnOffsets[i] * table.rowCapacity;
+        data.emplace_back(values, nrows, table.columnByteSizes[i], table.columnByteSizes[i]);
+    }
+
+    // Sort the rows, so that repeated values are adjacent (and so are not re-encoded)
+
+    Buffer sortedRows(0);
+    if (!table.sortKeys.empty()) data = core::sortRows(columns, data, table.sortKeys, sortedRows);
+
+    // Find the first column that changes in each row, compared with the previous row. The columns
+    // are visited last to first, so the earliest change is the one that remains.
+
+    // BUG: First row may not be properly encoded if it is zero.
+    std::vector<uint16_t> startCols(nrows, static_cast<uint16_t>(ncols));
+
+    for (size_t i = ncols; i-- > 0;) {
+
+        const size_t byteSize = table.columnByteSizes[i];
+        const char* column = data[i].get(0);
+
+        if (::memcmp(column, &table.lastValues[table.columnOffsets[i]], byteSize) != 0) startCols[0] = static_cast<uint16_t>(i);
+
+        if (byteSize == sizeof(uint64_t)) {
+            for (size_t row = 1; row < nrows; ++row) {
+                uint64_t previous;
+                uint64_t current;
+                ::memcpy(&previous, column + (row - 1) * sizeof(uint64_t), sizeof(uint64_t));
+                ::memcpy(&current, column + row * sizeof(uint64_t), sizeof(uint64_t));
+                startCols[row] = (current != previous) ? static_cast<uint16_t>(i) : startCols[row];
+            }
+        } else {
+            for (size_t row = 1; row < nrows; ++row) {
+                if (data[i].isNewValue(row)) startCols[row] = static_cast<uint16_t>(i);
+            }
+        }
+    }
+
+    // The size of the encoded data is known before encoding, so the header is written first and the
+    // rows are encoded and written out a chunk at a time.
+
+    size_t dataSize = core::encodedDataSize(columns, startCols);
+    std::pair<Buffer, size_t> encodedHeader = core::Header::serializeHeader(dataSize, table.rowCount,
+                                                                            table.properties, table.columns);
+    ASSERT(encodedHeader.second <= encodedHeader.first.size());
+
+    LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::flush: header size: " << encodedHeader.second << std::endl;
+
+    ASSERT(dataHandle().write(encodedHeader.first, encodedHeader.second) == long(encodedHeader.second)); // Write header
+    core::writeEncodedRows(dataHandle(), columns, data, startCols); // Write encoded data
+
+    LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::flush: flushed " << table.rowCount << " rows." << std::endl;
 
-std::pair<Buffer, size_t> WriterBufferingIterator::serializeHeader(size_t dataSize, size_t rowsNumber) {
-    return core::Header::serializeHeader(dataSize, rowsNumber, properties_, columns());
+    Length frameLength(encodedHeader.second + static_cast<long long>(dataSize));
+    if (writeFrameIndex_) frameIndex_.addFrame(frameOffset_, frameLength, table.rowCount, table.columns);
+    frameOffset_ += frameLength;
+}
+
+void WriterBufferingIterator::waitForFlush()
+{
+    if (pendingFlush_.valid()) pendingFlush_.get();
 }
 
 int WriterBufferingIterator::close()
 {
     if (initialisedColumns_) flush();
+    waitForFlush();
 
     if (!openDataHandle_)
 	{
         handle().close();
 	}
+
+    // The index describes the whole file, so it is not written if the frames were appended to
+    // existing data (their offsets are relative to where writing started).
+
+    if (writeFrameIndex_ && frameIndex_.frameCount() != 0)
+    {
+        if (frameIndex_.dataSize() == path_.size()) {
+            frameIndex_.save(path_);
+        } else {
+            LOG_DEBUG_LIB(LibOdc) << "WriterBufferingIterator::close: not indexing appended file " << path_ << std::endl;
+        }
+        frameIndex_.clear();
+    }
 	return 0;
 }
 
@@ -16,11 +16,16 @@
 #ifndef odc_WriterBufferingIterator_H
 #define odc_WriterBufferingIterator_H
 
+#include <future>
+#include <memory>
+#include <vector>
+
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/HandleHolder.h"
 #include "eckit/log/Log.h"
 
 #include "odc/codec/CodecOptimizer.h"
+#include "odc/core/FrameIndex.h"
 #include "odc/IteratorProxy.h"
 #include "odc/LibOdc.h"
 
@@ -93,6 +98,8 @@ public:
 	size_t rowsBufferSize() { return rowsBufferSize_; }
 	void rowsBufferSize(size_t n) { rowsBufferSize_ = n; }
 
+	void sortKeys(const std::vector<std::string>& keys) { sortKeys_ = keys; }
+
 	void flush();
 
     std::vector<eckit::PathName> outputFiles();
@@ -124,28 +131,66 @@ private:
 
 	template <typename T> void pass1init(T&, const T&);
 
-    std::pair<eckit::Buffer, size_t> serializeHeader(size_t dataSize, size_t rowsNumber);
+    // A full buffer of rows, together with everything needed to encode and write it as a table
+    // independently of the iterator (and so, optionally, in the background).
+
+    struct PendingTable {
+        eckit::Buffer rows;
+        size_t rowCount;
+        size_t rowCapacity;
+        core::MetaData columns;
+        core::Properties properties;
+        std::vector<std::string> sortKeys;
+        std::vector<double> lastValues;
+        std::vector<size_t> columnOffsets;
+        std::vector<size_t> columnByteSizes;
+    };
 
     void allocBuffers();
 	void allocRowsBuffer();
 	void resetColumnsBuffer();
 
-    int doWriteRow(core::DataStream<core::SameByteOrder>& stream, const double* values);
+    /// The staged values of a column. Each value occupies dataSizeDoubles() doubles.
+    double* stagedColumn(size_t i) {
+        return reinterpret_cast<double*>(rowsBuffer_.data()) + columnOffsets_[i] * rowCapacity_;
+    }
+
+    void writeTable(PendingTable& table);
+
+    /// Wait for any table being written in the background. Rethrows any errors.
+    void waitForFlush();
 
     bool initialisedColumns_;
     core::Properties properties_;
 
+    // Rows are staged column-major, so that the statistics and the changes between rows can be
+    // found one column at a time when the table is flushed. The values of column i start at
+    // columnOffsets_[i] * rowCapacity_ doubles into the buffer.
+
     eckit::Buffer rowsBuffer_;
-	unsigned char* nextRowInBuffer_;
+    size_t rowCapacity_;
+    size_t bufferedRows_;
 
 	size_t rowsBufferSize_;
     size_t rowDataSizeDoubles_;
+    std::vector<std::string> sortKeys_;
     size_t rowByteSize_;
 
 	codec::CodecOptimizer codecOptimizer_;
 
     const odc::sql::TableDef* tableDef_;
 
+    // Frame index of the output file (if enabled). Offsets assume that the file is written from the start.
+    bool writeFrameIndex_;
+    core::FrameIndex frameIndex_;
+    eckit::Offset frameOffset_;
+
+    // Tables are encoded and written in the background while the next buffer is filled (if
+    // enabled). Only one table is pending at a time, so the tables are written in order.
+    bool asyncFlush_;
+    std::unique_ptr<PendingTable> pendingTable_;
+    std::future<void> pendingFlush_;
+
 private:
     bool openDataHandle_;
 
@@ -74,6 +74,38 @@ template <> struct OdbTypes<DOUBLE> {
 
 //------------------------------------------------------------------------------------------------------------
 
+/** Identifies the type in which decoded values are written to memory. Values outside the range of an
+ *  integer type are clamped to it, so the integer missing value (2147483647) decodes as the largest
+ *  value of the type. */
+enum DecodedType {
+    /** 64-bit values (doubles, or 64-bit integers for integer columns if so configured), or characters for strings */
+    DECODED_DEFAULT = 0,
+    DECODED_INT8    = 1,
+    DECODED_INT16   = 2,
+    DECODED_INT32   = 3,
+    DECODED_INT64   = 4,
+    DECODED_FLOAT32 = 5,
+    DECODED_FLOAT64 = 6,
+    /** For string columns, a 32-bit code indexing the distinct strings decoded (see Decoder::strings) */
+    DECODED_STRING_CODE = 7
+};
+
+/** Returns the size of a value of a decoded type, or zero for DECODED_DEFAULT */
+inline size_t decodedTypeSize(DecodedType type) {
+    switch (type) {
+        case DECODED_INT8:    return sizeof(int8_t);
+        case DECODED_INT16:   return sizeof(int16_t);
+        case DECODED_INT32:   return sizeof(int32_t);
+        case DECODED_INT64:   return sizeof(int64_t);
+        case DECODED_FLOAT32: return sizeof(float);
+        case DECODED_FLOAT64: return sizeof(double);
+        case DECODED_STRING_CODE: return sizeof(int32_t);
+        default:              return 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------
+
 } // namespace api
 } // namespace odc
 
@@ -12,8 +12,8 @@
 
 #include <algorithm>
 #include <numeric>
-#include <mutex>
-#include <future>
+#include <atomic>
+#include <functional>
 
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/HandleBuf.h"
@@ -25,8 +25,14 @@
 #include "odc/core/Column.h"
 #include "odc/core/DecodeTarget.h"
 #include "odc/core/Encoder.h"
+#include "odc/core/FrameIndex.h"
+#include "odc/core/MappedDataHandle.h"
+#include "odc/core/PositionalFileHandle.h"
+#include "odc/core/RangeFilter.h"
+#include "odc/core/StringTable.h"
 #include "odc/core/Table.h"
 #include "odc/core/TablesReader.h"
+#include "odc/core/ThreadPool.h"
 #include "odc/csv/TextReader.h"
 #include "odc/csv/TextReaderIterator.h"
 #include "odc/LibOdc.h"
@@ -65,7 +71,7 @@ public: // methods
     eckit::Offset offset() const;
     eckit::Length length() const;
 
-    void decode(DecoderImpl& target, size_t nthreads);
+    size_t decode(DecoderImpl& target, size_t nthreads, const char* selected=0);
     Span span(const std::vector<std::string>& columns, bool onlyConstantValues);
 
     Frame filter(const std::string& sql);
@@ -88,18 +94,40 @@ class ReaderImpl {
 
 public: // methods
 
-    ReaderImpl(const std::string& path, bool aggregated, long rowlimit);
+    ReaderImpl(const std::string& path, bool aggregated, long rowlimit, bool memoryMapped);
     ReaderImpl(eckit::DataHandle& dh, bool aggregated, long rowlimit);
     ReaderImpl(eckit::DataHandle* dh, bool aggregated, long rowlimit);
 
     void restart();
     Frame next();
 
+    void readAhead(size_t nframes, size_t maxMemory);
+    void readAheadStatistics(size_t& hits, size_t& stalls) const;
+
+    void useIndex(const std::string& path);
+    void seekFrame(size_t n);
+
+    void filterRange(const std::string& column, double minimum, double maximum);
+
+private: // methods
+
+    /// Move the iterator past any tables that the filter excludes
+    void skipExcluded(core::TablesReader::iterator& it);
+
 private: // members
 
-    core::TablesReader tablesReader_;
+    std::unique_ptr<core::TablesReader> tablesReader_;
     core::TablesReader::iterator it_;
 
+    // Sidecar index of the frames in the data (if available)
+    std::unique_ptr<core::FrameIndex> index_;
+
+    size_t readAheadFrames_;
+    size_t readAheadMemory_;
+
+    // Conditions tested against the table headers
+    core::RangeFilter filter_;
+
     long rowlimit_;
 
     bool aggregated_;
@@ -108,44 +136,104 @@ private: // members
 
 //----------------------------------------------------------------------------------------------------------------------
 
-ReaderImpl::ReaderImpl(const std::string& path, bool aggregated, long rowlimit) :
-    tablesReader_(path),
-    it_(tablesReader_.begin()),
+ReaderImpl::ReaderImpl(const std::string& path, bool aggregated, long rowlimit, bool memoryMapped) :
+    tablesReader_(new core::TablesReader(memoryMapped ? new core::MappedDataHandle(path)
+                                                      : core::PositionalFileHandle::open(path))),
+    it_(tablesReader_->begin()),
+    readAheadFrames_(ODBAPISettings::instance().readAheadFrames()),
+    readAheadMemory_(ODBAPISettings::instance().readAheadMemory()),
     rowlimit_(rowlimit),
     aggregated_(aggregated),
-    first_(true) {}
+    first_(true) {
+    useIndex(path);
+}
 
 ReaderImpl::ReaderImpl(eckit::DataHandle& dh, bool aggregated, long rowlimit) :
-    tablesReader_(dh),
-    it_(tablesReader_.begin()),
+    tablesReader_(new core::TablesReader(dh)),
+    it_(tablesReader_->begin()),
+    readAheadFrames_(ODBAPISettings::instance().readAheadFrames()),
+    readAheadMemory_(ODBAPISettings::instance().readAheadMemory()),
     rowlimit_(rowlimit),
     aggregated_(aggregated),
     first_(true) {}
 
 ReaderImpl::ReaderImpl(eckit::DataHandle* dh, bool aggregated, long rowlimit) :
-    tablesReader_(dh),
-    it_(tablesReader_.begin()),
+    tablesReader_(new core::TablesReader(dh)),
+    it_(tablesReader_->begin()),
+    readAheadFrames_(ODBAPISettings::instance().readAheadFrames()),
+    readAheadMemory_(ODBAPISettings::instance().readAheadMemory()),
     rowlimit_(rowlimit),
     aggregated_(aggregated),
     first_(true) {}
 
+void ReaderImpl::readAhead(size_t nframes, size_t maxMemory) {
+    readAheadFrames_ = nframes;
+    readAheadMemory_ = maxMemory;
+    tablesReader_->readAhead(nframes, maxMemory);
+}
+
+void ReaderImpl::readAheadStatistics(size_t& hits, size_t& stalls) const {
+    tablesReader_->readAheadStatistics(hits, stalls);
+}
+
 void ReaderImpl::restart() {
-    it_ = tablesReader_.begin();
+    it_ = tablesReader_->begin();
     first_ = true;
 }
 
-Frame ReaderImpl::next() {
+void ReaderImpl::useIndex(const std::string& path) {
+    index_.reset(new core::FrameIndex);
+    if (!index_->load(path)) index_.reset();
+}
 
-    std::vector<core::Table> tables;
+void ReaderImpl::seekFrame(size_t n) {
 
-    if (it_ == tablesReader_.end()) return Frame();
+    // Without an index, the headers of the preceding tables must be read to find the frame
 
-    if (!first_) {
-        ++it_;
-        if (it_ == tablesReader_.end()) return Frame();
+    if (!index_) {
+        restart();
+        for (size_t i = 0; i < n && it_ != tablesReader_->end(); ++i) ++it_;
+        return;
     }
 
+    eckit::Offset position = (n < index_->frameCount()) ? index_->frame(n).offset : eckit::Offset(index_->dataSize());
+
+    core::ThreadSharedDataHandle dh(tablesReader_->dataHandle());
+    tablesReader_.reset();
+    tablesReader_.reset(new core::TablesReader(dh, position));
+
+    if (readAheadFrames_ != ODBAPISettings::instance().readAheadFrames() ||
+        readAheadMemory_ != ODBAPISettings::instance().readAheadMemory()) {
+        tablesReader_->readAhead(readAheadFrames_, readAheadMemory_);
+    }
+
+    restart();
+}
+
+void ReaderImpl::filterRange(const std::string& column, double minimum, double maximum) {
+    filter_.addRange(column, minimum, maximum);
+}
+
+void ReaderImpl::skipExcluded(core::TablesReader::iterator& it) {
+
+    // Only the headers of the excluded tables are read
+
+    if (filter_.empty()) return;
+    while (it != tablesReader_->end() && !filter_.mayMatch(it->columns())) ++it;
+}
+
+Frame ReaderImpl::next() {
+
+    std::vector<core::Table> tables;
+
+    if (it_ == tablesReader_->end()) return Frame();
+
+    if (!first_) ++it_;
     first_ = false;
+
+    skipExcluded(it_);
+    if (it_ == tablesReader_->end()) return Frame();
+
     tables.emplace_back(*it_);
     long nrows = tables.back().rowCount();
 
@@ -153,13 +241,14 @@ Frame ReaderImpl::next() {
         while (true) {
             auto it_next = it_;
             ++it_next;
-            if (it_next == tablesReader_.end()) break;
+            skipExcluded(it_next);
+            if (it_next == tablesReader_->end()) break;
 
             long next_nrows = nrows + it_next->rowCount();
             if (rowlimit_ >= 0 && next_nrows > rowlimit_) break;
             if (!tables.front().columns().compatible(it_next->columns())) break;
 
-            ++it_;
+            it_ = it_next;
             tables.emplace_back(*it_);
             nrows = next_nrows;
         }
@@ -202,8 +291,8 @@ const std::map<std::string, std::string>& FrameImpl::properties() const {
 
 // API Forwarding
 
-Reader::Reader(const std::string& path, bool aggregated, long rowlimit) :
-    impl_(new ReaderImpl(path, aggregated, rowlimit)) {}
+Reader::Reader(const std::string& path, bool aggregated, long rowlimit, bool memoryMapped) :
+    impl_(new ReaderImpl(path, aggregated, rowlimit, memoryMapped)) {}
 
 Reader::Reader(eckit::DataHandle& dh, bool aggregated, long rowlimit) :
     impl_(new ReaderImpl(dh, aggregated, rowlimit)) {}
@@ -213,35 +302,134 @@ Reader::Reader(eckit::DataHandle* dh, bool aggregated, long rowlimit) :
 
 Reader::~Reader() {}
 
+void Reader::readAhead(size_t nframes, size_t maxMemory) {
+    ASSERT(impl_);
+    impl_->readAhead(nframes, maxMemory);
+}
+
+void Reader::readAheadStatistics(size_t& hits, size_t& stalls) const {
+    ASSERT(impl_);
+    impl_->readAheadStatistics(hits, stalls);
+}
+
 Frame Reader::next() {
     ASSERT(impl_);
     return impl_->next();
 }
 
+void Reader::useIndex(const std::string& path) {
+    ASSERT(impl_);
+    impl_->useIndex(path);
+}
+
+void Reader::seekFrame(size_t n) {
+    ASSERT(impl_);
+    impl_->seekFrame(n);
+}
+
+void Reader::filterRange(const std::string& column, double minimum, double maximum) {
+    ASSERT(impl_);
+    impl_->filterRange(column, minimum, maximum);
+}
+
+void Reader::filterEquals(const std::string& column, double value) {
+    ASSERT(impl_);
+    impl_->filterRange(column, value, value);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 // Shim for decoding
 struct DecoderImpl : public core::DecodeTarget {
 public:
     using core::DecodeTarget::DecodeTarget;
+
+    core::RangeFilter filter_;
 };
 
 Decoder::Decoder(const std::vector<std::string>& columns,
                            std::vector<StridedData>& columnFacades) :
     impl_(new DecoderImpl(columns, columnFacades)) {}
 
+Decoder::Decoder(const std::vector<std::string>& columns,
+                 std::vector<StridedData>& columnFacades,
+                 const std::vector<DecodedType>& types) :
+    impl_(new DecoderImpl(columns, columnFacades, types)) {}
+
+Decoder::Decoder(Decoder&&) = default;
+
 Decoder::~Decoder() {}
 
-void Decoder::decode(const Frame& frame, size_t nthreads) {
+void Decoder::filterRange(const std::string& column, double minimum, double maximum) {
+    ASSERT(impl_);
+    impl_->filter_.addRange(column, minimum, maximum);
+}
+
+void Decoder::filterEquals(const std::string& column, double value) {
+    ASSERT(impl_);
+    impl_->filter_.addEquals(column, value);
+}
+
+void Decoder::filterEquals(const std::string& column, const std::string& value) {
+    ASSERT(impl_);
+    impl_->filter_.addEquals(column, value);
+}
+
+size_t Decoder::decode(const Frame& frame, size_t nthreads) {
+    ASSERT(impl_);
+    ASSERT(frame.impl_);
+    return frame.impl_->decode(*impl_, nthreads);
+}
+
+size_t Decoder::decode(const Frame& frame, const std::vector<size_t>& rows) {
     ASSERT(impl_);
     ASSERT(frame.impl_);
-    frame.impl_->decode(*impl_, nthreads);
+
+    std::vector<char> selected(frame.rowCount(), false);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i] >= selected.size() || (i != 0 && rows[i] <= rows[i-1])) {
+            std::stringstream ss;
+            ss << "Row " << rows[i] << " of frame with " << selected.size()
+               << " rows is out of range, or not in increasing order";
+            throw UserError(ss.str(), Here());
+        }
+        selected[rows[i]] = true;
+    }
+
+    return frame.impl_->decode(*impl_, 1, selected.data());
+}
+
+size_t Decoder::decode(const Frame& frame, const std::vector<bool>& selected) {
+    ASSERT(impl_);
+    ASSERT(frame.impl_);
+
+    if (selected.size() != frame.rowCount()) {
+        std::stringstream ss;
+        ss << "Selection of " << selected.size() << " rows does not match frame with " << frame.rowCount() << " rows";
+        throw UserError(ss.str(), Here());
+    }
+
+    std::vector<char> flags(selected.begin(), selected.end());
+    return frame.impl_->decode(*impl_, 1, flags.data());
 }
 
 Decoder Decoder::slice(size_t rowOffset, size_t nrows) const {
     ASSERT(impl_);
     core::DecodeTarget&& sliced = impl_->slice(rowOffset, nrows);
-    return {sliced.columns(), sliced.dataFacades()};
+    Decoder decoder(sliced.columns(), sliced.dataFacades());
+    static_cast<core::DecodeTarget&>(*decoder.impl_) = sliced; // Includes the types and string tables
+    decoder.impl_->filter_ = impl_->filter_;
+    return decoder;
+}
+
+const std::vector<std::string>& Decoder::strings(size_t column) const {
+    ASSERT(impl_);
+    ASSERT(column < impl_->columns().size());
+    core::StringTable* table = impl_->stringTable(column);
+    if (!table) {
+        throw UserError("Column '" + impl_->columns()[column] + "' is not decoded as string codes", Here());
+    }
+    return table->strings();
 }
 
 
@@ -347,6 +535,16 @@ const std::vector<ColumnInfo>& FrameImpl::columnInfo() const {
                 std::move(bitfield)
             });
         }
+
+        // If the columns were reordered when they were encoded, present them in the original order
+
+        std::vector<size_t> positions(core::encodedColumnPositions(tables_.front().properties(), columnInfo_.size()));
+        if (!positions.empty()) {
+            std::vector<ColumnInfo> ordered;
+            ordered.reserve(positions.size());
+            for (size_t col : positions) ordered.emplace_back(std::move(columnInfo_[col]));
+            columnInfo_.swap(ordered);
+        }
     }
 
     return columnInfo_;
@@ -367,10 +565,36 @@ size_t FrameImpl::columnCount() const {
     return tables_[0].columnCount();
 }
 
-void FrameImpl::decode(DecoderImpl& target, size_t nthreads) {
+size_t FrameImpl::decode(DecoderImpl& target, size_t nthreads, const char* selected) {
+
+    // Filtered tables are decoded one after another, as the output of each table starts where
+    // the output of the previous one ends.
+
+    if (!target.filter_.empty() || selected) {
+        size_t nrows = rowCount();
+        size_t rowOffset = 0;
+        size_t tableStart = 0;
+        for (core::Table& t : tables_) {
+            core::DecodeTarget subTarget(target.slice(rowOffset, nrows - rowOffset));
+            rowOffset += t.decode(subTarget, target.filter_, selected ? selected + tableStart : 0);
+            tableStart += t.rowCount();
+        }
+        return rowOffset;
+    }
+
+    // If there are fewer tables than threads, split the individual tables between the threads
+    // instead.
 
     if (tables_.size() == 1) {
-        tables_[0].decode(target);
+        tables_[0].decode(target, nthreads);
+    } else if (tables_.size() < nthreads) {
+        size_t rowOffset = 0;
+        for (core::Table& t : tables_) {
+            size_t rows = t.rowCount();
+            core::DecodeTarget subTarget(target.slice(rowOffset, rows));
+            t.decode(subTarget, nthreads);
+            rowOffset += rows;
+        }
     } else {
 
         std::vector<core::DecodeTarget> targets;
@@ -388,36 +612,31 @@ void FrameImpl::decode(DecoderImpl& target, size_t nthreads) {
         }
 
         if (nthreads > 1) {
-            std::mutex guard_mutex;
-            std::vector<std::future<void>> threads;
-            size_t next_frame = 0;
 
-            for (size_t i = 0; i < nthreads; i++) {
-                threads.emplace_back(std::async(std::launch::async, [&] {
-                    while (true) {
-                        size_t frame;
-
-                        {
-                            std::lock_guard<std::mutex> guard(guard_mutex);
-                            if (next_frame < tables_.size()) {
-                                frame = next_frame++;
-                            } else {
-                                return;
-                            }
-                        }
+            // The settings (e.g. the decode block size) are per-thread, so the workers adopt
+            // those of this thread while decoding.
+
+            const ODBAPISettings& settings(ODBAPISettings::instance());
+            std::atomic<size_t> next_frame(0);
+            std::vector<std::function<void()>> tasks;
 
+            for (size_t i = 0; i < nthreads; i++) {
+                tasks.emplace_back([&] {
+                    AdoptSettings adopt(settings);
+                    size_t frame;
+                    while ((frame = next_frame++) < tables_.size()) {
                         tables_[frame].decode(targets[frame]);
                     }
-                }));
+                });
             }
 
-            // Waits for the threads. If any exceptions have been thrown, they get thrown into
-            // the main thread here.
-            for (auto& thread : threads) {
-                thread.get();
-            }
+            // Runs the tasks on the library thread pool. If any exceptions have been thrown, they
+            // get thrown into the main thread here.
+            LibOdc::instance().threadPool().run(tasks);
         }
     }
+
+    return rowCount();
 }
 
 namespace {
@@ -634,6 +853,14 @@ double Settings::doubleMissingValue() {
     return odc::MDI::realMDI();
 }
 
+size_t Settings::threadPoolSize() {
+    return LibOdc::instance().threadPool().size();
+}
+
+void Settings::setThreadPoolSize(size_t nthreads) {
+    LibOdc::instance().threadPool().resize(nthreads);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 const char* columnTypeName(const ColumnType& type) {
@@ -688,18 +915,24 @@ void encode(DataHandle& out,
             const std::vector<ColumnInfo>& columns,
             const std::vector<ConstStridedData>& data,
             const std::map<std::string, std::string>& properties,
-            size_t maxRowsPerFrame) {
+            size_t maxRowsPerFrame,
+            size_t nthreads,
+            bool reorderColumns,
+            const std::vector<std::string>& sortKeys) {
 
     ASSERT(columns.size() == data.size());
     ASSERT(data.size() > 0);
+    ASSERT(maxRowsPerFrame > 0);
 
     size_t ncols = data.size();
     size_t nrows = data[0].nelem();
     ASSERT(std::all_of(data.begin(), data.end(), [nrows](const ConstStridedData& d) { return d.nelem() == nrows; }));
 
+    size_t nframes = (nrows + maxRowsPerFrame - 1) / maxRowsPerFrame;
+
     if (nrows <= maxRowsPerFrame) {
-        core::encodeFrame(out, columns, data, properties);
-    } else {
+        core::encodeFrame(out, columns, data, properties, reorderColumns, sortKeys);
+    } else if (nthreads <= 1) {
         std::vector<ConstStridedData> sliced;
         sliced.reserve(ncols);
         size_t start = 0;
@@ -708,14 +941,53 @@ void encode(DataHandle& out,
             for (const ConstStridedData& sd : data) {
                 sliced.emplace_back(sd.slice(start, nelem));
             }
-            core::encodeFrame(out, columns, sliced, properties);
+            core::encodeFrame(out, columns, sliced, properties, reorderColumns, sortKeys);
             start += nelem;
             sliced.clear();
         }
+    } else {
+
+        // The frames are independent, so encode them concurrently into per-frame buffers, in
+        // batches of nthreads frames, and write each batch out in order. The settings are
+        // per-thread, so the workers adopt those of this thread while encoding.
+
+        const ODBAPISettings& settings(ODBAPISettings::instance());
+        std::vector<std::unique_ptr<MemoryHandle>> encoded(nthreads);
+
+        for (size_t firstFrame = 0; firstFrame < nframes; firstFrame += nthreads) {
+
+            size_t batchSize = std::min(nthreads, nframes - firstFrame);
+            std::vector<std::function<void()>> tasks;
+
+            for (size_t i = 0; i < batchSize; ++i) {
+                tasks.emplace_back([&, i] {
+                    AdoptSettings adopt(settings);
+
+                    size_t start = (firstFrame + i) * maxRowsPerFrame;
+                    size_t nelem = std::min(nrows - start, maxRowsPerFrame);
+                    std::vector<ConstStridedData> sliced;
+                    sliced.reserve(ncols);
+                    for (const ConstStridedData& sd : data) {
+                        sliced.emplace_back(sd.slice(start, nelem));
+                    }
+
+                    encoded[i].reset(new MemoryHandle);
+                    encoded[i]->openForWrite(0);
+                    AutoClose closer(*encoded[i]);
+                    core::encodeFrame(*encoded[i], columns, sliced, properties, reorderColumns, sortKeys);
+                });
+            }
+
+            LibOdc::instance().threadPool().run(tasks);
+
+            for (size_t i = 0; i < batchSize; ++i) {
+                long length = encoded[i]->position();
+                ASSERT(out.write(encoded[i]->data(), length) == length);
+            }
+        }
     }
 }
 
-
 size_t filter(const std::string& sql, eckit::DataHandle& in, eckit::DataHandle& out) {
 
     if (sql.empty()) {
@@ -72,6 +72,15 @@ public: // methods
      * \param val Missing double value
      */
     static void setDoubleMissingValue(double val);
+    /** Returns the number of worker threads in the library thread pool
+     * \returns Number of worker threads
+     */
+    static size_t threadPoolSize();
+    /** Sets the number of worker threads in the library thread pool, used for parallel
+     * decoding. Must not be called while the library is decoding or encoding data.
+     * \param nthreads Number of worker threads. If zero, work is done on the calling thread
+     */
+    static void setThreadPoolSize(size_t nthreads);
     /** Returns release version of the library in human-readable format, e.g. ``1.3.0``
      * \returns Release version
      */
@@ -277,8 +286,9 @@ public: // methods
      * \param path File path to open
      * \param aggregated Whether to aggregate compatible data into a logical frame
      * \param rowlimit Maximum number of rows to aggregate into one logical frame
+     * \param memoryMapped Whether to memory-map the file, and decode directly from the mapped data
      */
-    Reader(const std::string& path, bool aggregated=true, long rowlimit=-1);
+    Reader(const std::string& path, bool aggregated=true, long rowlimit=-1, bool memoryMapped=false);
     /** Construct from data handle reference. This does not take ownership of the data handle,
      *  and managing the lifetime of this data handle is the responsibility of the caller.
      * \param dh Data handle (eckit)
@@ -299,6 +309,48 @@ public: // methods
      */
     Frame next();
 
+    /** Reads ahead of the frames being decoded in a background thread, prefetching their encoded data
+     * \param nframes Number of frames to read ahead. If zero, read-ahead is disabled
+     * \param maxMemory Maximum number of bytes of prefetched data to hold
+     */
+    void readAhead(size_t nframes, size_t maxMemory);
+
+    /** Returns statistics describing the effectiveness of read-ahead
+     * \param hits Number of frames whose data had been prefetched by the time it was decoded
+     * \param stalls Number of frames that had to wait for, or read, their own data
+     */
+    void readAheadStatistics(size_t& hits, size_t& stalls) const;
+
+    /** Uses the frame index (.odcidx) of a data file, if one exists and is up to date. This is done
+     *  automatically when the Reader is constructed from a file path.
+     * \param path Path of the data file being read
+     */
+    void useIndex(const std::string& path);
+
+    /** Moves to the specified frame, which will be returned by the next call to next(). Frames are
+     *  counted as stored in the data, before any aggregation. With a frame index this does not read
+     *  the preceding headers.
+     * \param n Index of the frame, counting from zero
+     */
+    void seekFrame(size_t n);
+
+    /** Only returns frames in which some values of a column may lie within a range. Frames whose
+     *  header statistics (the minimum and maximum values of the column, and whether it has missing
+     *  values) show that no value lies within the range are skipped without reading their data.
+     *  A frame must meet all of the conditions added. Conditions on string columns, or on columns
+     *  not present in a frame, are ignored.
+     * \param column Column name
+     * \param minimum Lowest value of the range
+     * \param maximum Highest value of the range
+     */
+    void filterRange(const std::string& column, double minimum, double maximum);
+
+    /** Only returns frames in which some values of a column may equal a value. See filterRange().
+     * \param column Column name
+     * \param value Value to match
+     */
+    void filterEquals(const std::string& column, double value);
+
 private: // members
 
     std::unique_ptr<ReaderImpl> impl_;
@@ -319,6 +371,18 @@ public: // methods
      */
     Decoder(const std::vector<std::string>& columns,
             std::vector<StridedData>& columnFacades);
+
+    /** Constructor, writing the values of each column in the specified type
+     * \param columns The names of the columns to decode
+     * \param columnFacades A description of the periodic data layout for each named column. The
+     *                      data size must be that of the type, unless it is DECODED_DEFAULT.
+     * \param types The type in which to write the values of each column
+     */
+    Decoder(const std::vector<std::string>& columns,
+            std::vector<StridedData>& columnFacades,
+            const std::vector<DecodedType>& types);
+
+    Decoder(Decoder&&);
     ~Decoder();
 
     /** Obtain a sub-decoder associated with a contiguous subset of the rows reference by
@@ -329,11 +393,56 @@ public: // methods
      */
     Decoder slice(size_t rowOffset, size_t nrows) const;
 
+    /** Only decodes the rows in which the value of a column lies within a range. The conditions
+     *  are evaluated on the encoded data, and only the values of the matching rows are decoded,
+     *  packed into the first rows of the output. A row must meet all of the conditions added.
+     * \param column Column name
+     * \param minimum Lowest value of the range
+     * \param maximum Highest value of the range
+     */
+    void filterRange(const std::string& column, double minimum, double maximum);
+
+    /** Only decodes the rows in which the value of a column equals a value. See filterRange().
+     * \param column Column name
+     * \param value Value to match
+     */
+    void filterEquals(const std::string& column, double value);
+
+    /** Only decodes the rows in which the value of a string column equals a string. See filterRange().
+     * \param column Column name
+     * \param value String to match
+     */
+    void filterEquals(const std::string& column, const std::string& value);
+
     /** Decodes passed frame according to current configuration
      * \param frame Frame object
-     * \param nthreads Number of threads
+     * \param nthreads Number of threads. Filtered decoding uses a single thread.
+     * \returns Number of rows decoded
+     */
+    size_t decode(const Frame& frame, size_t nthreads=1);
+
+    /** Decodes only the specified rows of the frame, packed into the first rows of the output.
+     *  The other rows are skipped without being decoded. Any filters also apply.
+     * \param frame Frame object
+     * \param rows Indices of the rows to decode, in increasing order
+     * \returns Number of rows decoded
+     */
+    size_t decode(const Frame& frame, const std::vector<size_t>& rows);
+
+    /** Decodes only the selected rows of the frame. See decode(const Frame&, const std::vector<size_t>&).
+     * \param frame Frame object
+     * \param selected Whether each row of the frame is to be decoded
+     * \returns Number of rows decoded
+     */
+    size_t decode(const Frame& frame, const std::vector<bool>& selected);
+
+    /** Returns the strings indexed by the codes of a column decoded as DECODED_STRING_CODE. The
+     *  strings of every frame decoded (by this decoder and its slices) are added to the one table,
+     *  so the codes may be compared between frames.
+     * \param column Index of the column, in the order supplied to the constructor
+     * \returns Strings, indexed by code
      */
-    void decode(const Frame& frame, size_t nthreads=1);
+    const std::vector<std::string>& strings(size_t column) const;
 
 private: // members
 
@@ -356,12 +465,20 @@ const char* columnTypeName(const ColumnType& type);
  * \param data Description of the periodic data layout for each column to encode
  * \param properties Dictionary of key/value properties to encode
  * \param maxRowsPerFrame Maximum number of rows per frame
+ * \param nthreads Number of frames to encode concurrently. The output is identical for any number of threads.
+ * \param reorderColumns Encode the columns that change least often first, where this makes the output
+ *                       smaller. Frames still present the columns in the original order when read.
+ * \param sortKeys Columns on which to stably sort the rows within each frame before encoding. Runs of
+ *                 repeated values then encode compactly.
  */
 void encode(eckit::DataHandle& out,
             const std::vector<ColumnInfo>& columns,
             const std::vector<ConstStridedData>& data,
             const std::map<std::string, std::string>& properties = {},
-            size_t maxRowsPerFrame=10000);
+            size_t maxRowsPerFrame=10000,
+            size_t nthreads=1,
+            bool reorderColumns=false,
+            const std::vector<std::string>& sortKeys={});
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -22,6 +22,9 @@
 
 #include "odc/api/odc.h"
 #include "odc/api/Odb.h"
+#include "odc/core/MappedDataHandle.h"
+#include "odc/core/PositionalFileHandle.h"
+#include "odc/core/RangeFilter.h"
 
 using namespace odc::api;
 using namespace eckit;
@@ -31,14 +34,28 @@ extern "C" {
 //----------------------------------------------------------------------------------------------------------------------
 
 struct odc_reader_t {
-    odc_reader_t(DataHandle* dh) : impl_(nullptr), dh_(dh) {
+    odc_reader_t(DataHandle* dh, const std::string& path="") :
+        impl_(nullptr), dh_(dh), path_(path), readAheadFrames_(0), readAheadMemory_(0), seekFrame_(-1) {
         dh_->openForRead();
     }
     ~odc_reader_t() noexcept(false) {
+        impl_.reset();
         dh_->close();
     }
+    void createReader(bool aggregated, long rowlimit=-1) {
+        impl_.reset(new Reader(*dh_, aggregated, rowlimit));
+        if (readAheadFrames_ != 0) impl_->readAhead(readAheadFrames_, readAheadMemory_);
+        if (!path_.empty()) impl_->useIndex(path_);
+        if (seekFrame_ >= 0) impl_->seekFrame(seekFrame_);
+        for (const auto& c : filter_.conditions()) impl_->filterRange(c.column, c.min, c.max);
+    }
     std::unique_ptr<Reader> impl_;
     std::unique_ptr<DataHandle> dh_;
+    std::string path_;
+    size_t readAheadFrames_;
+    size_t readAheadMemory_;
+    long seekFrame_;
+    odc::core::RangeFilter filter_;
 };
 
 struct odc_frame_t {
@@ -55,6 +72,8 @@ struct odc_decoder_t {
         size_t elemSize;
         size_t stride;
         bool transpose;
+        DecodedType type;
+        std::vector<std::string> strings; // For string codes
     };
 
     odc_decoder_t() : nrows(0), dataWidth(0), dataHeight(0), externalData(0), columnMajor(false), ownedData() {}
@@ -70,11 +89,13 @@ struct odc_decoder_t {
 
     // n.b. not std::vector. Don't force 0-initialising array.
     std::unique_ptr<char[]> ownedData;
+
+    odc::core::RangeFilter filter;
 };
 
 struct odc_encoder_t {
 
-    odc_encoder_t() : arrayData(0), columnMajorWidth(0), nrows(0), arrayWidth(0), arrayHeight(0), maxRowsPerFrame(10000) {}
+    odc_encoder_t() : arrayData(0), columnMajorWidth(0), nrows(0), arrayWidth(0), arrayHeight(0), maxRowsPerFrame(10000), nthreads(1), reorderColumns(false) {}
 
     struct EncodeColumn {
         const void* data;
@@ -88,6 +109,9 @@ struct odc_encoder_t {
     size_t arrayWidth;
     size_t arrayHeight;
     size_t maxRowsPerFrame;
+    size_t nthreads;
+    bool reorderColumns;
+    std::vector<std::string> sortKeys;
     std::vector<ColumnInfo> columnInfo;
     std::vector<EncodeColumn> columnData;
     std::map<std::string, std::string> properties;
@@ -215,6 +239,15 @@ int odc_initialise_api() {
         ASSERT(ODC_STRING   == static_cast<int>(STRING));
         ASSERT(ODC_BITFIELD == static_cast<int>(BITFIELD));
         ASSERT(ODC_DOUBLE   == static_cast<int>(DOUBLE));
+
+        ASSERT(ODC_DECODED_DEFAULT == static_cast<int>(DECODED_DEFAULT));
+        ASSERT(ODC_DECODED_INT8    == static_cast<int>(DECODED_INT8));
+        ASSERT(ODC_DECODED_INT16   == static_cast<int>(DECODED_INT16));
+        ASSERT(ODC_DECODED_INT32   == static_cast<int>(DECODED_INT32));
+        ASSERT(ODC_DECODED_INT64   == static_cast<int>(DECODED_INT64));
+        ASSERT(ODC_DECODED_FLOAT32 == static_cast<int>(DECODED_FLOAT32));
+        ASSERT(ODC_DECODED_FLOAT64 == static_cast<int>(DECODED_FLOAT64));
+        ASSERT(ODC_DECODED_STRING_CODE == static_cast<int>(DECODED_STRING_CODE));
     });
 }
 
@@ -227,6 +260,15 @@ int odc_integer_behaviour(int integerBehaviour) {
     });
 }
 
+int odc_set_thread_pool_size(int nthreads) {
+    return wrapApiFunction([nthreads] {
+        if (nthreads < 0) {
+            throw UserError("Thread pool size must not be negative", Here());
+        }
+        Settings::setThreadPoolSize(nthreads);
+    });
+}
+
 int odc_set_failure_handler(odc_failure_handler_t handler, void* context) {
     return wrapApiFunction([handler, context] {
         g_failure_handler = handler;
@@ -280,7 +322,13 @@ int odc_vcs_version(const char** sha1) {
 int odc_open_path(odc_reader_t** reader, const char* filename) {
     return wrapApiFunction([reader, filename] {
 //        ASSERT(!(*reader));
-        (*reader) = new odc_reader_t(PathName(filename).fileHandle());
+        (*reader) = new odc_reader_t(odc::core::PositionalFileHandle::open(filename), filename);
+    });
+}
+
+int odc_open_path_mmap(odc_reader_t** reader, const char* filename) {
+    return wrapApiFunction([reader, filename] {
+        (*reader) = new odc_reader_t(new odc::core::MappedDataHandle(filename), filename);
     });
 }
 
@@ -331,6 +379,60 @@ int odc_close(const odc_reader_t* reader) {
     });
 }
 
+int odc_reader_set_read_ahead(odc_reader_t* reader, int nframes, long max_memory) {
+    return wrapApiFunction([reader, nframes, max_memory] {
+        ASSERT(reader);
+        if (nframes < 0 || max_memory < 0) {
+            throw UserError("Read-ahead frames and memory must not be negative", Here());
+        }
+        reader->readAheadFrames_ = nframes;
+        reader->readAheadMemory_ = max_memory;
+        if (reader->impl_) reader->impl_->readAhead(nframes, max_memory);
+    });
+}
+
+int odc_reader_read_ahead_statistics(const odc_reader_t* reader, long* hits, long* stalls) {
+    return wrapApiFunction([reader, hits, stalls] {
+        ASSERT(reader);
+        size_t h = 0;
+        size_t s = 0;
+        if (reader->impl_) reader->impl_->readAheadStatistics(h, s);
+        if (hits) (*hits) = h;
+        if (stalls) (*stalls) = s;
+    });
+}
+
+int odc_reader_seek_frame(odc_reader_t* reader, long n) {
+    return wrapApiFunction([reader, n] {
+        ASSERT(reader);
+        if (n < 0) throw UserError("Frame index must not be negative", Here());
+
+        // If iteration has not started, the seek is applied when the frames are first requested
+
+        if (reader->impl_) {
+            reader->impl_->seekFrame(n);
+        } else {
+            reader->seekFrame_ = n;
+        }
+    });
+}
+
+int odc_reader_filter_range(odc_reader_t* reader, const char* column, double minimum, double maximum) {
+    return wrapApiFunction([reader, column, minimum, maximum] {
+        ASSERT(reader);
+        ASSERT(column);
+
+        // Conditions are retained, so that they are applied however iteration is started
+
+        reader->filter_.addRange(column, minimum, maximum);
+        if (reader->impl_) reader->impl_->filterRange(column, minimum, maximum);
+    });
+}
+
+int odc_reader_filter_equals(odc_reader_t* reader, const char* column, double value) {
+    return odc_reader_filter_range(reader, column, value, value);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 /*
@@ -358,7 +460,7 @@ int odc_next_frame(odc_frame_t* frame) {
         odc_reader_t& r(frame->reader_);
         if (!r.impl_) {
             bool aggregated = false;
-            r.impl_.reset(new Reader(*r.dh_, aggregated));
+            r.createReader(aggregated);
         }
 
         if ((frame->frame_ = r.impl_->next())) {
@@ -379,7 +481,7 @@ int odc_next_frame_aggregated(odc_frame_t* frame, long maximum_rows) {
         odc_reader_t& r(frame->reader_);
         if (!r.impl_) {
             bool aggregated = true;
-            r.impl_.reset(new Reader(*r.dh_, aggregated, maximum_rows));
+            r.createReader(aggregated, maximum_rows);
         }
 
         if ((frame->frame_ = r.impl_->next())) {
@@ -584,7 +686,7 @@ int odc_decoder_add_column(odc_decoder_t* decoder, const char* name) {
         ASSERT(decoder);
         ASSERT(name);
         decoder->columnNames.emplace_back(name);
-        decoder->columnData.emplace_back(odc_decoder_t::DecodeColumn {0, 0, 0, false});
+        decoder->columnData.emplace_back(odc_decoder_t::DecodeColumn {0, 0, 0, false, DECODED_DEFAULT, {}});
     });
 }
 
@@ -596,6 +698,23 @@ int odc_decoder_column_count(const odc_decoder_t* decoder, int* count) {
     });
 }
 
+int odc_decoder_filter_range(odc_decoder_t* decoder, const char* column, double minimum, double maximum) {
+    return wrapApiFunction([decoder, column, minimum, maximum] {
+        ASSERT(decoder);
+        ASSERT(column);
+        decoder->filter.addRange(column, minimum, maximum);
+    });
+}
+
+int odc_decoder_filter_string(odc_decoder_t* decoder, const char* column, const char* value) {
+    return wrapApiFunction([decoder, column, value] {
+        ASSERT(decoder);
+        ASSERT(column);
+        ASSERT(value);
+        decoder->filter.addEquals(column, value);
+    });
+}
+
 int odc_decoder_column_set_data_size(odc_decoder_t* decoder, int col, int element_size) {
     return wrapApiFunction([decoder, col, element_size] {
         ASSERT(decoder);
@@ -606,6 +725,21 @@ int odc_decoder_column_set_data_size(odc_decoder_t* decoder, int col, int elemen
     });
 }
 
+int odc_decoder_column_set_data_type(odc_decoder_t* decoder, int col, int type) {
+    return wrapApiFunction([decoder, col, type] {
+        ASSERT(decoder);
+        ASSERT(col >= 0 && size_t(col) < decoder->columnData.size());
+        if (type < ODC_DECODED_DEFAULT || type > ODC_DECODED_STRING_CODE) {
+            std::stringstream ss;
+            ss << "Invalid decoded type " << type;
+            throw UserError(ss.str(), Here());
+        }
+
+        auto& cd(decoder->columnData[col]);
+        cd.type = static_cast<DecodedType>(type);
+    });
+}
+
 int odc_decoder_column_set_data_array(odc_decoder_t* decoder, int col, int element_size, int stride, void* data) {
     return wrapApiFunction([decoder, col, element_size, stride, data] {
         ASSERT(decoder);
@@ -630,6 +764,28 @@ int odc_decoder_column_data_array(const odc_decoder_t* decoder, int col, int* el
     });
 }
 
+int odc_decoder_column_string_count(const odc_decoder_t* decoder, int col, int* count) {
+    return wrapApiFunction([decoder, col, count] {
+        ASSERT(decoder);
+        ASSERT(col >= 0 && size_t(col) < decoder->columnData.size());
+        ASSERT(count);
+
+        (*count) = decoder->columnData[col].strings.size();
+    });
+}
+
+int odc_decoder_column_string(const odc_decoder_t* decoder, int col, int code, const char** value) {
+    return wrapApiFunction([decoder, col, code, value] {
+        ASSERT(decoder);
+        ASSERT(col >= 0 && size_t(col) < decoder->columnData.size());
+        ASSERT(value);
+
+        const auto& strings(decoder->columnData[col].strings);
+        ASSERT(code >= 0 && size_t(code) < strings.size());
+        (*value) = strings[code].c_str();
+    });
+}
+
 static void fill_in_decoder(odc_decoder_t* decoder, const odc_frame_t* frame) {
 
     if (decoder->nrows == 0) {
@@ -644,7 +800,9 @@ static void fill_in_decoder(odc_decoder_t* decoder, const odc_frame_t* frame) {
         odc_decoder_t::DecodeColumn& col(decoder->columnData[i]);
 
         if (col.elemSize == 0) {
-            if (col.data) {
+            if (col.type != DECODED_DEFAULT) {
+                col.elemSize = decodedTypeSize(col.type);
+            } else if (col.data) {
                 col.elemSize = sizeof(double); // backwards compatible default
             } else {
                 const std::string& colName(decoder->columnNames[i]);
@@ -695,8 +853,12 @@ static void fill_in_decoder(odc_decoder_t* decoder, const odc_frame_t* frame) {
 }
 
 
-int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_decoded, int nthreads) {
-    return wrapApiFunction([decoder, frame, rows_decoded, nthreads] {
+/// Decode the frame into the data arrays of the decoder. The decode function is passed the
+/// C++ decoder, and returns the number of rows decoded.
+
+static int decode_frame(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_decoded,
+                         const std::function<size_t(Decoder&)>& decode) {
+    return wrapApiFunction([decoder, frame, rows_decoded, &decode] {
 
         ASSERT(decoder);
         ASSERT(frame);
@@ -721,6 +883,7 @@ int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long*
         // Construct C++ API adapter
 
         std::vector<StridedData> dataFacade;
+        std::vector<DecodedType> types;
         dataFacade.reserve(decoder->columnNames.size());
 
         for (size_t i = 0; i < decoder->columnData.size(); ++i) {
@@ -735,14 +898,30 @@ int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long*
                 data = temporaryTransposeData.back().second.get();
             }
             dataFacade.emplace_back(StridedData{data, size_t(decoder->nrows), size_t(col.elemSize), size_t(col.stride)});
+            types.push_back(col.type);
         }
 
-        Decoder target(decoder->columnNames, dataFacade);
+        Decoder target(decoder->columnNames, dataFacade, types);
+        for (const auto& c : decoder->filter.conditions()) {
+            if (c.isString) {
+                target.filterEquals(c.column, c.string);
+            } else {
+                target.filterRange(c.column, c.min, c.max);
+            }
+        }
 
         // Do the decoder
 
-        ASSERT(nthreads >= 1);
-        target.decode(frame->frame_, static_cast<size_t>(nthreads));
+        size_t rows = decode(target);
+
+        for (size_t i = 0; i < decoder->columnData.size(); ++i) {
+            auto& col(decoder->columnData[i]);
+            if (col.type == DECODED_STRING_CODE) {
+                col.strings = target.strings(i);
+            } else {
+                col.strings.clear();
+            }
+        }
 
         // For the cases where needed, reorder the data
 
@@ -752,7 +931,7 @@ int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long*
             double* output = static_cast<double*>(decoder->columnData[colIndex].data);
             size_t rows = decoder->nrows;
             size_t cols = decoder->columnData[colIndex].elemSize / sizeof(double);
-            for (size_t row = 0; row < frame_rows; row++) {
+            for (size_t row = 0; row < rows; row++) {
                 for (size_t col = 0; col < cols; col++) {
                     output[row + (col * rows)] = tmpArray[col + (row * cols)];
                 }
@@ -762,7 +941,36 @@ int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long*
         // And return the values
 
 //        decoder->nrows = frame_rows;
-        if (rows_decoded) *(rows_decoded) = frame_rows;
+        if (rows_decoded) *(rows_decoded) = rows;
+    });
+}
+
+int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_decoded, int nthreads) {
+    return decode_frame(decoder, frame, rows_decoded, [frame, nthreads](Decoder& target) {
+        ASSERT(nthreads >= 1);
+        return target.decode(frame->frame_, static_cast<size_t>(nthreads));
+    });
+}
+
+int odc_decode_rows(odc_decoder_t* decoder, const odc_frame_t* frame, const long* rows, long count, long* rows_decoded) {
+    return decode_frame(decoder, frame, rows_decoded, [frame, rows, count](Decoder& target) {
+        ASSERT(count >= 0);
+        ASSERT(rows || count == 0);
+        std::vector<size_t> selected;
+        selected.reserve(count);
+        for (long i = 0; i < count; ++i) {
+            if (rows[i] < 0) throw UserError("Row index must not be negative", Here());
+            selected.push_back(rows[i]);
+        }
+        return target.decode(frame->frame_, selected);
+    });
+}
+
+int odc_decode_mask(odc_decoder_t* decoder, const odc_frame_t* frame, const bool* mask, long* rows_decoded) {
+    return decode_frame(decoder, frame, rows_decoded, [frame, mask](Decoder& target) {
+        ASSERT(mask);
+        std::vector<bool> selected(mask, mask + frame->frame_.rowCount());
+        return target.decode(frame->frame_, selected);
     });
 }
 
@@ -807,6 +1015,29 @@ int odc_encoder_set_rows_per_frame(odc_encoder_t* encoder, long rows_per_frame)
     });
 }
 
+int odc_encoder_set_threads(odc_encoder_t* encoder, int nthreads) {
+    return wrapApiFunction([encoder, nthreads] {
+        ASSERT(encoder);
+        ASSERT(nthreads > 0);
+        encoder->nthreads = nthreads;
+    });
+}
+
+int odc_encoder_set_reorder_columns(odc_encoder_t* encoder, bool reorder) {
+    return wrapApiFunction([encoder, reorder] {
+        ASSERT(encoder);
+        encoder->reorderColumns = reorder;
+    });
+}
+
+int odc_encoder_add_sort_key(odc_encoder_t* encoder, const char* column) {
+    return wrapApiFunction([encoder, column] {
+        ASSERT(encoder);
+        ASSERT(column);
+        encoder->sortKeys.emplace_back(column);
+    });
+}
+
 int odc_encoder_set_data_array(odc_encoder_t* encoder, const void* data, long width, long height, int columnMajorWidth) {
     return wrapApiFunction([encoder, data, width, height, columnMajorWidth] {
         ASSERT(encoder);
@@ -997,7 +1228,8 @@ void odc_encode_to_data_handle(odc_encoder_t* encoder, eckit::DataHandle& dh) {
         stridedData.emplace_back(ConstStridedData {c.data, encoder->nrows, info.decodedSize, c.stride});
     }
 
-    ::odc::api::encode(dh, encoder->columnInfo, stridedData, encoder->properties, encoder->maxRowsPerFrame);
+    ::odc::api::encode(dh, encoder->columnInfo, stridedData, encoder->properties, encoder->maxRowsPerFrame, encoder->nthreads,
+                         encoder->reorderColumns, encoder->sortKeys);
 }
 
 
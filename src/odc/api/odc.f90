@@ -82,6 +82,9 @@ module odc
         procedure :: free => encoder_free
         procedure :: set_row_count => encoder_set_row_count
         procedure :: set_rows_per_frame => encoder_set_rows_per_frame
+        procedure :: set_threads => encoder_set_threads
+        procedure :: set_reorder_columns => encoder_set_reorder_columns
+        procedure :: add_sort_key => encoder_add_sort_key
         procedure :: set_data => encoder_set_data_array
         procedure :: add_column => encoder_add_column
         procedure :: add_property => encoder_add_property
@@ -108,6 +111,7 @@ module odc
     public :: odc_set_missing_integer, odc_set_missing_double
     public :: odc_set_failure_handler
     public :: odc_integer_behaviour
+    public :: odc_set_thread_pool_size
 
     ! Error handling definitions
 
@@ -165,6 +169,13 @@ module odc
             integer(c_int) :: err
         end function
 
+        function odc_set_thread_pool_size(nthreads) result(err) bind(c)
+            use, intrinsic :: iso_c_binding
+            implicit none
+            integer(c_int), intent(in), value :: nthreads
+            integer(c_int) :: err
+        end function
+
         function c_odc_set_failure_handler(handler, context) result(err) bind(c, name='odc_set_failure_handler')
             use, intrinsic :: iso_c_binding
             implicit none
@@ -529,6 +540,30 @@ module odc
             integer(c_int) :: err
         end function
 
+        function odc_encoder_set_threads(encoder, nthreads) result(err) bind(c)
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: encoder
+            integer(c_int), intent(in), value :: nthreads
+            integer(c_int) :: err
+        end function
+
+        function odc_encoder_set_reorder_columns(encoder, reorder) result(err) bind(c)
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: encoder
+            logical(c_bool), intent(in), value :: reorder
+            integer(c_int) :: err
+        end function
+
+        function odc_encoder_add_sort_key(encoder, column) result(err) bind(c)
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: encoder
+            type(c_ptr), intent(in), value :: column
+            integer(c_int) :: err
+        end function
+
         function odc_encoder_set_data_array(encoder, data, width, height, columnMajorWidth) result(err) bind(c)
             use, intrinsic :: iso_c_binding
             implicit none
@@ -1068,6 +1103,31 @@ contains
         err = odc_encoder_set_rows_per_frame(encoder%impl, rows_per_frame)
     end function
 
+    function encoder_set_threads(encoder, nthreads) result(err)
+        class(odc_encoder), intent(inout) :: encoder
+        integer(c_int), intent(in) :: nthreads
+        integer :: err
+        err = odc_encoder_set_threads(encoder%impl, nthreads)
+    end function
+
+    function encoder_set_reorder_columns(encoder, reorder) result(err)
+        class(odc_encoder), intent(inout) :: encoder
+        logical, intent(in) :: reorder
+        integer :: err
+        logical(c_bool) :: l_reorder
+        l_reorder = reorder
+        err = odc_encoder_set_reorder_columns(encoder%impl, l_reorder)
+    end function
+
+    function encoder_add_sort_key(encoder, column) result(err)
+        class(odc_encoder), intent(inout) :: encoder
+        character(*), intent(in) :: column
+        integer :: err
+        character(:), allocatable, target :: nullified_column
+        nullified_column = trim(column) // c_null_char
+        err = odc_encoder_add_sort_key(encoder%impl, c_loc(nullified_column))
+    end function
+
     function encoder_set_data_array(encoder, data, column_major) result(err)
         class(odc_encoder), intent(inout) :: encoder
         real(dp), intent(in), target :: data(:,:)
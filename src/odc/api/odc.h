@@ -48,6 +48,13 @@ int odc_initialise_api();
  * \returns Return code (#OdcErrorValues)
  */
 int odc_integer_behaviour(int integerBehaviour);
+/** Sets the number of worker threads in the library thread pool, used for parallel decoding
+ * \note Must not be called while data is being decoded or encoded. The default size is taken from
+ *       the ODC_THREAD_POOL_SIZE environment variable, or the number of hardware threads.
+ * \param nthreads Number of worker threads. If zero, all work is done on the calling thread
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_set_thread_pool_size(int nthreads);
 
 /** @} */
 
@@ -126,6 +133,20 @@ enum OdcColumnType {
     ODC_DOUBLE   = 5
 };
 
+/** Types in which decoded values may be written. Values outside the range of an integer type are clamped to it. */
+enum OdcDecodedType {
+    /** 64-bit values (doubles, or 64-bit integers according to the integer behaviour), or characters for strings */
+    ODC_DECODED_DEFAULT = 0,
+    ODC_DECODED_INT8    = 1,
+    ODC_DECODED_INT16   = 2,
+    ODC_DECODED_INT32   = 3,
+    ODC_DECODED_INT64   = 4,
+    ODC_DECODED_FLOAT32 = 5,
+    ODC_DECODED_FLOAT64 = 6,
+    /** For string columns, a 32-bit code indexing the distinct strings of the frame (see odc_decoder_column_string) */
+    ODC_DECODED_STRING_CODE = 7
+};
+
 /** Retrieves number of supported column data types
  * \param count Return variable for number of data types
  * \returns Return code (#OdcErrorValues)
@@ -182,6 +203,14 @@ typedef struct odc_reader_t odc_reader_t;
  */
 int odc_open_path(odc_reader_t** reader, const char* filename);
 
+/** Creates a reader that memory-maps the specified file path. Frames are decoded directly from the
+ *  mapped data, avoiding copies and allowing the page cache to be shared between processes.
+ * \param reader Reader instance. Returned instance must be freed using #odc_close.
+ * \param filename File path to open
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_open_path_mmap(odc_reader_t** reader, const char* filename);
+
 /** Creates a reader from an already open file descriptor.
  *
  * The file descriptor will be duplicated so the calling code is safe to close the file descriptor.
@@ -221,6 +250,51 @@ int odc_open_stream(odc_reader_t** reader, void* context, odc_stream_read_t stre
  */
 int odc_close(const odc_reader_t* reader);
 
+/** Reads ahead of the frames being decoded in a background thread, prefetching their encoded data
+ * \param reader Reader instance
+ * \param nframes Number of frames to read ahead. If zero, read-ahead is disabled
+ * \param max_memory Maximum number of bytes of prefetched data to hold
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_reader_set_read_ahead(odc_reader_t* reader, int nframes, long max_memory);
+
+/** Returns statistics describing the effectiveness of read-ahead
+ * \param reader Reader instance
+ * \param hits Number of frames whose data had been prefetched by the time it was decoded
+ * \param stalls Number of frames that had to wait for, or read, their own data
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_reader_read_ahead_statistics(const odc_reader_t* reader, long* hits, long* stalls);
+
+/** Moves the reader to the specified frame, so that it is returned by the next call to odc_next_frame.
+ *  If the reader was opened from a path with an up to date frame index (.odcidx), the preceding
+ *  frame headers are not read.
+ * \param reader Reader instance
+ * \param n Index of the frame, counting from zero
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_reader_seek_frame(odc_reader_t* reader, long n);
+
+/** Only returns frames in which some values of a column may lie within a range. Frames whose header
+ *  statistics show that no value lies within the range are skipped without reading their data.
+ *  A frame must meet all of the conditions added. Conditions on string columns, or on columns not
+ *  present in a frame, are ignored.
+ * \param reader Reader instance
+ * \param column Column name
+ * \param minimum Lowest value of the range
+ * \param maximum Highest value of the range
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_reader_filter_range(odc_reader_t* reader, const char* column, double minimum, double maximum);
+
+/** Only returns frames in which some values of a column may equal a value. See odc_reader_filter_range.
+ * \param reader Reader instance
+ * \param column Column name
+ * \param value Value to match
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_reader_filter_equals(odc_reader_t* reader, const char* column, double value);
+
 /** @} */
 
 
@@ -421,6 +495,16 @@ int odc_decoder_column_count(const odc_decoder_t* decoder, int* count);
  */
 int odc_decoder_column_set_data_size(odc_decoder_t* decoder, int col, int element_size);
 
+/** Sets the type in which the values of a column are decoded. String columns may only be decoded as
+ *  characters (the default) or as codes. Unless otherwise specified, the decoded data size for the
+ *  column is that of the type.
+ * \param decoder Decoder instance
+ * \param col Column index
+ * \param type Decoded type (#OdcDecodedType)
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decoder_column_set_data_type(odc_decoder_t* decoder, int col, int type);
+
 /**
  * Sets an output data array into which the data associated with the column can be decoded
  * \param decoder Decoder instance
@@ -443,6 +527,44 @@ int odc_decoder_column_set_data_array(odc_decoder_t* decoder, int col, int eleme
  */
 int odc_decoder_column_data_array(const odc_decoder_t* decoder, int col, int* element_size, int* stride, const void** data);
 
+/** Retrieves the number of distinct strings found in a column decoded as codes (#ODC_DECODED_STRING_CODE)
+ *  by the last decode
+ * \param decoder Decoder instance
+ * \param col Column index
+ * \param count Return variable for number of strings
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decoder_column_string_count(const odc_decoder_t* decoder, int col, int* count);
+
+/** Retrieves the string corresponding to a code decoded in a column, by the last decode
+ * \param decoder Decoder instance
+ * \param col Column index
+ * \param code String code
+ * \param value Return variable for the (null terminated) string. Valid until the next decode, or the
+ *              decoder object is destroyed.
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decoder_column_string(const odc_decoder_t* decoder, int col, int code, const char** value);
+
+/** Only decodes the rows in which the value of a column lies within a range. The conditions are
+ *  evaluated on the encoded data, and only the values of the matching rows are decoded, packed into
+ *  the first rows of the data array(s). A row must meet all of the conditions added.
+ * \param decoder Decoder instance
+ * \param column Column name
+ * \param minimum Lowest value of the range
+ * \param maximum Highest value of the range
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decoder_filter_range(odc_decoder_t* decoder, const char* column, double minimum, double maximum);
+
+/** Only decodes the rows in which the value of a string column equals a string. See odc_decoder_filter_range.
+ * \param decoder Decoder instance
+ * \param column Column name
+ * \param value String to match
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decoder_filter_string(odc_decoder_t* decoder, const char* column, const char* value);
+
 /**
  * Decodes the data described by the frame into the configured data array(s)
  * \param decoder Decoder instance
@@ -455,7 +577,8 @@ int odc_decode(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_deco
 /**
  * Decodes the data described by the frame into the configured data array(s).
  *
- * If the frame is a logical one, parallelise the decoding over multiple threads.
+ * The decoding is parallelised over multiple threads. Logical frames are split into their
+ * constituent frames, and large frames are split into ranges of rows.
  *
  * \param decoder Decoder instance
  * \param frame Frame instance
@@ -465,6 +588,30 @@ int odc_decode(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_deco
  */
 int odc_decode_threaded(odc_decoder_t* decoder, const odc_frame_t* frame, long* rows_decoded, int nthreads);
 
+/**
+ * Decodes only the specified rows of the frame, packed into the first rows of the configured data
+ * array(s). The other rows are skipped without being decoded. Any filters also apply.
+ *
+ * \param decoder Decoder instance
+ * \param frame Frame instance
+ * \param rows Indices of the rows to decode, in increasing order
+ * \param count Number of row indices
+ * \param rows_decoded (*optional*) Return variable for number of decoded rows
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decode_rows(odc_decoder_t* decoder, const odc_frame_t* frame, const long* rows, long count, long* rows_decoded);
+
+/**
+ * Decodes only the selected rows of the frame. See #odc_decode_rows.
+ *
+ * \param decoder Decoder instance
+ * \param frame Frame instance
+ * \param mask Whether each row of the frame is to be decoded (one entry per row)
+ * \param rows_decoded (*optional*) Return variable for number of decoded rows
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_decode_mask(odc_decoder_t* decoder, const odc_frame_t* frame, const bool* mask, long* rows_decoded);
+
 /** @} */
 
 
@@ -510,6 +657,29 @@ int odc_encoder_set_row_count(odc_encoder_t* encoder, long nrows);
  */
 int odc_encoder_set_rows_per_frame(odc_encoder_t* encoder, long rows_per_frame);
 
+/** Sets number of threads used to encode frames concurrently
+ * \param encoder Encoder instance
+ * \param nthreads Number of threads. The encoded data is identical for any number of threads.
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_encoder_set_threads(odc_encoder_t* encoder, int nthreads);
+
+/** Sets whether columns may be reordered to reduce the size of the encoded data
+ * \param encoder Encoder instance
+ * \param reorder Whether to encode the columns that change least often first. Frames still present
+ *                the columns in the original order when decoded.
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_encoder_set_reorder_columns(odc_encoder_t* encoder, bool reorder);
+
+/** Adds a column on which to sort the rows within each frame before encoding. The rows are sorted
+ *  stably on the sort keys in the order they are added.
+ * \param encoder Encoder instance
+ * \param column Column name
+ * \returns Return code (#OdcErrorValues)
+ */
+int odc_encoder_add_sort_key(odc_encoder_t* encoder, const char* column);
+
 /** Sets input data array from which data may be encoded
  * \param encoder Encoder instance
  * \param data Data array to encode
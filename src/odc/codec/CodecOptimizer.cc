@@ -13,9 +13,16 @@
 ///
 /// @author Piotr Kuchta, Jan 2010
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
 #include "eckit/config/Resource.h"
 #include "eckit/utils/StringTools.h"
 #include "odc/codec/CodecOptimizer.h"
+#include "odc/LibOdc.h"
 
 //
 
@@ -24,11 +31,51 @@ namespace codec {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+    // The decoding of each sample is timed repeatedly, and the fastest taken, to reduce the noise
+
+    const int decodeTrials = 3;
+
+    template <typename ByteOrder>
+    bool realStatsAs(const core::Codec& stats, bool& shortRealMissing, bool& shortReal2Missing, uint64_t& xorReference, uint64_t& xorBits) {
+        const CodecLongReal<ByteOrder>* codec_long = dynamic_cast<const CodecLongReal<ByteOrder>*>(&stats);
+        if (!codec_long) return false;
+        shortRealMissing = codec_long->hasShortRealInternalMissing();
+        shortReal2Missing = codec_long->hasShortReal2InternalMissing();
+        xorReference = codec_long->xorReference();
+        xorBits = codec_long->xorBits();
+        return true;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CodecCostModel::CodecCostModel() :
+    CodecCostModel(ODBAPISettings::instance().codecSizeWeight(), ODBAPISettings::instance().codecDecodeWeight()) {}
+
+CodecCostModel::CodecCostModel(double sizeWeight, double decodeWeight) :
+    sizeWeight_(sizeWeight),
+    decodeWeight_(decodeWeight) {}
+
+CodecCostModel::~CodecCostModel() {}
+
+double CodecCostModel::score(const CodecTrial& trial, size_t sampleRows) const {
+    ASSERT(sampleRows > 0);
+    return (sizeWeight_ * trial.encodedSize) + (decodeWeight_ * trial.decodeTime * 1.0e9 / sampleRows);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 std::map<api::ColumnType, std::string> CodecOptimizer::defaultCodec_;
 
-CodecOptimizer::CodecOptimizer()
+CodecOptimizer::CodecOptimizer() :
+    costModel_(new CodecCostModel)
 {
-    if (defaultCodec_.empty()) {
+    // n.b. Frames may be encoded concurrently, so the defaults must only be initialised once
+
+    static std::once_flag initialised;
+    std::call_once(initialised, [] {
         defaultCodec_[api::REAL] = "short_real2";
         defaultCodec_[api::DOUBLE] = "long_real";
         defaultCodec_[api::STRING] = "chars";
@@ -44,9 +91,90 @@ CodecOptimizer::CodecOptimizer()
             ASSERT("Wrong format of $ODC_DEFAULT_CODEC" && a.size() == 2);
             defaultCodec_[core::Column::type(S::trim(a[0]))] = S::trim(a[1]);
         }
+    });
+}
+
+CodecOptimizer::~CodecOptimizer() {}
+
+void CodecOptimizer::costModel(std::unique_ptr<CodecCostModel> model) {
+    ASSERT(model);
+    costModel_ = std::move(model);
+}
+
+void CodecOptimizer::report(std::ostream& s) const {
+    for (const CodecDecision& decision : decisions_) {
+        s << decision.column << ": " << decision.codec << std::endl;
+        for (const CodecTrial& trial : decision.trials) {
+            s << "    " << std::left << std::setw(20) << trial.codec << std::right
+              << " size=" << trial.encodedSize
+              << " decode=" << trial.decodeTime << "s"
+              << " score=" << trial.score << std::endl;
+        }
     }
 }
 
+bool CodecOptimizer::realStats(const core::Codec& stats, RealStats& real) {
+
+    // The statistics may have been gathered by a codec of either byte order
+
+    return realStatsAs<core::SameByteOrder>(stats, real.shortRealInternalMissing, real.shortReal2InternalMissing, real.xorReference, real.xorBits) ||
+           realStatsAs<core::OtherByteOrder>(stats, real.shortRealInternalMissing, real.shortReal2InternalMissing, real.xorReference, real.xorBits);
+}
+
+void CodecOptimizer::copyStats(const core::Codec& stats, core::Codec& codec) {
+    codec.hasMissing(stats.hasMissing());
+    codec.missingValue(stats.rawMissingValue());
+    codec.min(stats.min());
+    codec.max(stats.max());
+}
+
+api::ConstStridedData CodecOptimizer::sample(const api::ConstStridedData& data, size_t rows) {
+
+    if (data.nelem() == 0 || rows == 0) return api::ConstStridedData();
+
+    size_t step = std::max(size_t(1), data.nelem() / rows);
+    size_t nrows = std::min(rows, (data.nelem() + step - 1) / step);
+    return api::ConstStridedData(data[0], nrows, data.dataSize(), data.stride() * step);
+}
+
+CodecTrial CodecOptimizer::trial(core::Codec& encoder, core::Codec& decoder, const api::ConstStridedData& sample) const {
+
+    // Encode the sample as if each value starts a new row, so that every value is decoded
+
+    const size_t nrows = sample.nelem();
+    const size_t encodedSize = encoder.encodedSize();
+
+    std::vector<char> encoded(nrows * encodedSize + 1);
+    char* p = &encoded[0];
+    for (const char* value : sample) {
+        p = encoder.encode(p, *reinterpret_cast<const double*>(value));
+    }
+    ASSERT(p == &encoded[nrows * encodedSize]);
+
+    std::vector<ptrdiff_t> rowOffsets(nrows);
+    for (size_t i = 0; i < nrows; ++i) rowOffsets[i] = i * encodedSize;
+    std::vector<int> startCols(nrows, 0);
+    size_t columnOffset = 0;
+    core::RowBlock block {&encoded[0], nrows, &rowOffsets[0], &startCols[0], &columnOffset};
+
+    const size_t width = decoder.dataSizeDoubles() * sizeof(double);
+    std::vector<char> decoded(nrows * width);
+    api::StridedData out(&decoded[0], nrows, width, width);
+
+    double best = 0;
+    for (int i = 0; i < decodeTrials; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        decoder.decodeBlock(block, 0, out);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+
+    LOG_DEBUG_LIB(LibOdc) << "CodecOptimizer: " << encoder.name() << " encodes " << nrows << " values in "
+                          << (nrows * encodedSize) << " bytes, decoded in " << best << "s" << std::endl;
+
+    return CodecTrial {encoder.name(), encodedSize, best, 0};
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 } // namespace core
@@ -16,32 +16,222 @@
 #ifndef odc_core_CodecOptimizer_H
 #define odc_core_CodecOptimizer_H
 
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "odc/api/ColumnType.h"
+#include "odc/api/StridedData.h"
 #include "odc/codec/Real.h"
 #include "odc/core/CodecFactory.h"
+#include "odc/core/DataStream.h"
+#include "odc/core/Exceptions.h"
 #include "odc/core/MetaData.h"
+#include "odc/ODBAPISettings.h"
 
 namespace odc {
 namespace codec {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// The result of trial-encoding a sample of the values of a column with a candidate codec
+
+struct CodecTrial {
+    std::string codec;
+    size_t encodedSize;   // bytes per value
+    double decodeTime;    // seconds to decode the sample (the fastest of several attempts)
+    double score;
+};
+
+/// How the codec for a column was chosen. There are no trials if the codec was chosen from the
+/// column statistics alone.
+
+struct CodecDecision {
+    std::string column;
+    std::string codec;
+    std::vector<CodecTrial> trials;
+};
+
+/// Scores the candidate codecs for a column. The lowest score wins. By default, the encoded size
+/// (in bytes per value) and decode time (in nanoseconds per value) are weighted according to the
+/// ODC_CODEC_SIZE_WEIGHT and ODC_CODEC_DECODE_WEIGHT settings.
+
+class CodecCostModel {
+public:
+    CodecCostModel();
+    CodecCostModel(double sizeWeight, double decodeWeight);
+    virtual ~CodecCostModel();
+
+    virtual double score(const CodecTrial& trial, size_t sampleRows) const;
+
+private:
+    double sizeWeight_;
+    double decodeWeight_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 class CodecOptimizer
 {
 public:
 	CodecOptimizer();
+    ~CodecOptimizer();
+
+    /// Choose the codecs from the statistics gathered in the columns. If the data are supplied, and
+    /// ODC_CODEC_SAMPLE_ROWS is non-zero, a sample of the rows of each column is also trial-encoded
+    /// with each of the viable codecs, and the one with the lowest cost is chosen.
 	template <typename DATASTREAM>
-        int setOptimalCodecs(core::MetaData& columns);
+        int setOptimalCodecs(core::MetaData& columns, const std::vector<api::ConstStridedData>& data={});
+
+    void costModel(std::unique_ptr<CodecCostModel> model);
+
+    /// The choices made by the last call to setOptimalCodecs
+    const std::vector<CodecDecision>& decisions() const { return decisions_; }
+    void report(std::ostream& s) const;
+
 private:
+
+    /// The statistics gathered by the long_real codec for REAL and DOUBLE columns
+    struct RealStats {
+        bool shortRealInternalMissing;
+        bool shortReal2InternalMissing;
+        uint64_t xorReference;
+        uint64_t xorBits;
+    };
+    static bool realStats(const core::Codec& stats, RealStats& real);
+
+    /// Replace the chosen codec with xor_real, if that is smaller for the values described by the
+    /// statistics gathered in the (long_real) codec stats.
+    template <typename ByteOrder>
+    static std::unique_ptr<core::Codec> smallerXorReal(const core::Codec& stats, api::ColumnType type, std::unique_ptr<core::Codec> chosen);
+
+    /// Build the named codec, ready to encode the values described by the column statistics
+    template <typename ByteOrder>
+    static std::unique_ptr<core::Codec> buildCodec(core::Column& col, const std::string& name);
+
+    static void copyStats(const core::Codec& stats, core::Codec& codec);
+
+    /// Trial-encode a sample of the data with the chosen codec and each of the named alternatives,
+    /// and return the one with the lowest cost
+    template <typename ByteOrder>
+    std::unique_ptr<core::Codec> cheapestCodec(core::Column& col,
+                                               std::unique_ptr<core::Codec> chosen,
+                                               const std::vector<std::string>& alternatives,
+                                               const api::ConstStridedData& data,
+                                               CodecDecision& decision) const;
+
+    /// A codec able to decode the output of the given one, loaded from its header as a reader would
+    template <typename ByteOrder>
+    static std::unique_ptr<core::Codec> reload(core::Codec& codec, api::ColumnType type);
+
+    /// Evenly spaced rows of the data
+    static api::ConstStridedData sample(const api::ConstStridedData& data, size_t rows);
+
+    CodecTrial trial(core::Codec& encoder, core::Codec& decoder, const api::ConstStridedData& sample) const;
+
     static std::map<api::ColumnType, std::string> defaultCodec_;
+
+    std::unique_ptr<CodecCostModel> costModel_;
+    std::vector<CodecDecision> decisions_;
 };
 
 template <typename ByteOrder>
-int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
+std::unique_ptr<core::Codec> CodecOptimizer::smallerXorReal(const core::Codec& stats, api::ColumnType type, std::unique_ptr<core::Codec> chosen)
+{
+    RealStats real;
+    if (!realStats(stats, real)) return chosen;
+    if (CodecXorReal<ByteOrder>::encodedWidth(real.xorBits) >= chosen->encodedSize()) return chosen;
+
+    std::unique_ptr<core::Codec> xorCodec = core::CodecFactory::instance().build<ByteOrder>(CodecXorReal<ByteOrder>::codec_name(), type);
+    dynamic_cast<CodecXorReal<ByteOrder>&>(*xorCodec).fit(real.xorReference, real.xorBits);
+    return xorCodec;
+}
+
+template <typename ByteOrder>
+std::unique_ptr<core::Codec> CodecOptimizer::buildCodec(core::Column& col, const std::string& name)
+{
+    core::Codec& stats(col.coder());
+    std::unique_ptr<core::Codec> codec = core::CodecFactory::instance().build<ByteOrder>(name, col.type());
+
+    if (name == CodecXorReal<ByteOrder>::codec_name()) {
+        RealStats real;
+        ASSERT(realStats(stats, real));
+        dynamic_cast<CodecXorReal<ByteOrder>&>(*codec).fit(real.xorReference, real.xorBits);
+    } else if (name.find("_dictionary") != std::string::npos) {
+        codec->distinctValues(stats.distinctValues());
+    }
+
+    copyStats(stats, *codec);
+    return codec;
+}
+
+template <typename ByteOrder>
+std::unique_ptr<core::Codec> CodecOptimizer::reload(core::Codec& codec, api::ColumnType type)
+{
+    std::vector<char> header(4096);
+    for (bool saved = false; !saved; ) {
+        try {
+            core::DataStream<ByteOrder> ds(&header[0], header.size());
+            ds.write(codec.name());
+            codec.save(ds);
+            saved = true;
+        } catch (core::ODBEndOfDataStream& e) {
+            header.resize(header.size() * 2);
+        }
+    }
+
+    core::DataStream<ByteOrder> ds(&header[0], header.size());
+    return core::CodecFactory::instance().load(ds, type);
+}
+
+template <typename ByteOrder>
+std::unique_ptr<core::Codec> CodecOptimizer::cheapestCodec(core::Column& col,
+                                                           std::unique_ptr<core::Codec> chosen,
+                                                           const std::vector<std::string>& alternatives,
+                                                           const api::ConstStridedData& data,
+                                                           CodecDecision& decision) const
+{
+    std::vector<std::unique_ptr<core::Codec>> candidates;
+    candidates.push_back(std::move(chosen));
+    copyStats(col.coder(), *candidates.front());
+    for (const std::string& name : alternatives) {
+        if (name != candidates.front()->name()) candidates.push_back(buildCodec<ByteOrder>(col, name));
+    }
+
+    // Ties go to the codec chosen from the statistics, which comes first
+
+    api::ConstStridedData values = sample(data, ODBAPISettings::instance().codecSampleRows());
+    size_t best = 0;
+    if (candidates.size() > 1 && values.nelem() != 0) {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            std::unique_ptr<core::Codec> decoder = reload<ByteOrder>(*candidates[i], col.type());
+            decision.trials.push_back(trial(*candidates[i], *decoder, values));
+            decision.trials.back().score = costModel_->score(decision.trials.back(), values.nelem());
+            if (decision.trials[i].score < decision.trials[best].score) best = i;
+        }
+    }
+
+    // The statistics are applied to the chosen codec by the caller, as for codecs chosen without trials
+
+    candidates[best]->resetStats();
+    return std::move(candidates[best]);
+}
+
+
+template <typename ByteOrder>
+int CodecOptimizer::setOptimalCodecs(core::MetaData& columns, const std::vector<api::ConstStridedData>& data)
 {
         //std::ostream &LOG = eckit::Log::error();
+    const bool int24Codecs = ODBAPISettings::instance().int24Codecs();
+    const bool xorRealCodecs = ODBAPISettings::instance().xorRealCodecs();
+    const bool integerDictionaryCodecs = ODBAPISettings::instance().integerDictionaryCodecs();
+    const bool trials = !data.empty() && ODBAPISettings::instance().codecSampleRows() != 0;
+    ASSERT(data.empty() || data.size() == columns.size());
+    decisions_.clear();
 	for (size_t i = 0; i < columns.size(); i++) {
         core::Column& col = *columns[i];
+        CodecDecision decision {col.name(), std::string(), {}};
 		long long n;
 		double min = col.min();
 		double max = col.max();
@@ -54,20 +244,26 @@ int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
             case api::REAL: {
 
                 // Currently the real data is (whist in the column) encoded using the LongReal codec.
-                // n.b. CodecOptimizer doesn't currently support OtherByteOrder.
-                CodecLongReal<core::SameByteOrder>* codec_long = dynamic_cast<CodecLongReal<core::SameByteOrder>*>(&col.coder());
-                ASSERT(codec_long != 0);
+                RealStats real;
+                ASSERT(realStats(col.coder(), real));
 
                 if (max == min) {
 					codec = col.hasMissing() ? "real_constant_or_missing" : "constant";
-                } else if (codec_long->hasShortReal2InternalMissing()) {
-                    ASSERT(!codec_long->hasShortRealInternalMissing());
+                } else if (real.shortReal2InternalMissing) {
+                    ASSERT(!real.shortRealInternalMissing);
                     codec = "short_real";
-                } else if (codec_long->hasShortRealInternalMissing()) {
+                } else if (real.shortRealInternalMissing) {
                     codec = "short_real2";
                 }
 
-                col.coder(core::CodecFactory::instance().build<ByteOrder>(codec, col.type()));
+                std::unique_ptr<core::Codec> newCodec = core::CodecFactory::instance().build<ByteOrder>(codec, col.type());
+                if (xorRealCodecs && max != min) newCodec = smallerXorReal<ByteOrder>(col.coder(), col.type(), std::move(newCodec));
+                if (trials && max != min) {
+                    std::vector<std::string> alternatives {CodecLongReal<ByteOrder>::codec_name()};
+                    if (xorRealCodecs) alternatives.push_back(CodecXorReal<ByteOrder>::codec_name());
+                    newCodec = cheapestCodec<ByteOrder>(col, std::move(newCodec), alternatives, data[i], decision);
+                }
+                col.coder(std::move(newCodec));
                 col.hasMissing(hasMissing);
 				col.missingValue(missing);
 				col.min(min);
@@ -81,7 +277,14 @@ int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
             case api::DOUBLE:
 				if(max == min)
 					codec = col.hasMissing() ? "real_constant_or_missing" : "constant";
-                col.coder(core::CodecFactory::instance().build<ByteOrder>(codec, col.type()));
+                {
+                    std::unique_ptr<core::Codec> newCodec = core::CodecFactory::instance().build<ByteOrder>(codec, col.type());
+                    if (xorRealCodecs && max != min) newCodec = smallerXorReal<ByteOrder>(col.coder(), col.type(), std::move(newCodec));
+                    if (trials && xorRealCodecs && max != min) {
+                        newCodec = cheapestCodec<ByteOrder>(col, std::move(newCodec), {CodecXorReal<ByteOrder>::codec_name()}, data[i], decision);
+                    }
+                    col.coder(std::move(newCodec));
+                }
 				col.hasMissing(hasMissing);
 				col.missingValue(missing);
 				col.min(min);
@@ -108,6 +311,7 @@ int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
                     } else {
                         newCodec->dataSizeDoubles(col.coder().dataSizeDoubles());
                         newCodec->copyStrings(col.coder());
+
                     }
                     col.coder(std::move(newCodec));
 					col.hasMissing(hasMissing);
@@ -128,14 +332,37 @@ int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
 					if(n == 0) codec = "constant_or_missing";
 					else if(n < 0xff) codec = "int8_missing";
 					else if(n < 0xffff) codec = "int16_missing";
+					else if(n < 0xffffff && int24Codecs) codec = "int24_missing";
 				}
 				else
 				{
 					if(n == 0) codec = "constant";
 					else if(n <= 0xff) codec = "int8";
 					else if(n <= 0xffff) codec = "int16";
+					else if(n <= 0xffffff && int24Codecs) codec = "int24";
 				}
-                col.coder(core::CodecFactory::instance().build<ByteOrder>(codec, col.type()));
+                {
+                    std::unique_ptr<core::Codec> newCodec = core::CodecFactory::instance().build<ByteOrder>(codec, col.type());
+
+                    // Few distinct values spread over a wide range are better indexed in a dictionary
+
+                    std::vector<std::string> alternatives {defaultCodec_[col.type()]};
+                    if (integerDictionaryCodecs) {
+                        size_t ndistinct = col.coder().numDistinctValues();
+                        const char* dictionary = (ndistinct <= 0x100) ? "int8_dictionary"
+                                               : (ndistinct <= 0x10000) ? "int16_dictionary" : 0;
+                        if (dictionary) {
+                            std::unique_ptr<core::Codec> dictionaryCodec = core::CodecFactory::instance().build<ByteOrder>(dictionary, col.type());
+                            if (dictionaryCodec->encodedSize() < newCodec->encodedSize()) {
+                                dictionaryCodec->distinctValues(col.coder().distinctValues());
+                                newCodec = std::move(dictionaryCodec);
+                            }
+                            alternatives.push_back(dictionary);
+                        }
+                    }
+                    if (trials && n != 0) newCodec = cheapestCodec<ByteOrder>(col, std::move(newCodec), alternatives, data[i], decision);
+                    col.coder(std::move(newCodec));
+                }
 				col.hasMissing(hasMissing);
 				col.missingValue(missing);
 				col.min(min);
@@ -152,6 +379,8 @@ int CodecOptimizer::setOptimalCodecs(core::MetaData& columns)
 		}
 
 		//if (odc::ODBAPISettings::debug && i == 28) eckit::Log::info() << ": AFTER " << col << " -> " << col.coder() << std::endl;
+        decision.codec = col.coder().name();
+        decisions_.emplace_back(std::move(decision));
 	}
 	return 0;
 }
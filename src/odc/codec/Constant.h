@@ -43,6 +43,11 @@ private: // methods
     unsigned char* encode(unsigned char* p, const double& d) override;
     void decode(double* out) override;
     void skip() override;
+    size_t encodedSize() const override { return 0; }
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override;
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override;
+    double decodedValue(const char* value) const override;
+    bool decodesIntegers() const override { return std::is_same<ValueType, int64_t>::value; }
 
     void print(std::ostream& s) const override;
 };
@@ -64,6 +69,7 @@ private: // methods
     unsigned char* encode(unsigned char* p, const double& d) override;
     void decode(double* out) override;
     void skip() override;
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override;
 
     void print(std::ostream& s) const override;
     size_t numStrings() const override { return 1; }
@@ -99,6 +105,31 @@ void CodecConstant<ByteOrder, ValueType>::decode(double* out) {
 template <typename ByteOrder, typename ValueType>
 void CodecConstant<ByteOrder, ValueType>::skip() {}
 
+template <typename ByteOrder, typename ValueType>
+void CodecConstant<ByteOrder, ValueType>::decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) {
+    const ValueType value = static_cast<ValueType>(this->min_);
+    core::decodeRowBlock(block, col, out, [value](const char*, char* o) {
+        *reinterpret_cast<ValueType*>(o) = value;
+    });
+}
+
+template <typename ByteOrder, typename ValueType>
+void CodecConstant<ByteOrder, ValueType>::filterBlock(const core::RowBlock& block, size_t col,
+                                                      const core::RangeFilter::Condition& condition, char* result) {
+    // n.b. decode() is virtual, so this also serves CodecConstantString
+    double value;
+    decode(&value);
+    const bool match = this->matchesDecoded(reinterpret_cast<const char*>(&value), condition);
+    core::filterRowBlock(block, col, result, [match](const char*) { return match; });
+}
+
+template <typename ByteOrder, typename ValueType>
+double CodecConstant<ByteOrder, ValueType>::decodedValue(const char* value) const {
+    ValueType v;
+    ::memcpy(&v, value, sizeof(v));
+    return v;
+}
+
 template <typename ByteOrder, typename ValueType>
 void CodecConstant<ByteOrder, ValueType>::print(std::ostream& s) const {
     s << this->name_ << ", value=" << std::fixed << static_cast<ValueType>(this->min_)
@@ -125,6 +156,14 @@ void CodecConstantString<ByteOrder>::decode(double* out) {
 template <typename ByteOrder>
 void CodecConstantString<ByteOrder>::skip() {}
 
+template <typename ByteOrder>
+void CodecConstantString<ByteOrder>::decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) {
+    const double value = this->min_;
+    core::decodeRowBlock(block, col, out, [value](const char*, char* o) {
+        ::memcpy(o, &value, sizeof(value));
+    });
+}
+
 template <typename ByteOrder>
 void CodecConstantString<ByteOrder>::load(core::DataStream<ByteOrder>& ds) {
     core::DataStreamCodec<ByteOrder>::load(ds);
@@ -22,6 +22,7 @@ namespace codec {
 namespace {
     core::IntegerCodecBuilder<CodecInt8> int8Builder;
     core::IntegerCodecBuilder<CodecInt16> int16Builder;
+    core::IntegerCodecBuilder<CodecInt24> int24Builder;
     core::IntegerCodecBuilder<CodecInt32> int32Builder;
 }
 
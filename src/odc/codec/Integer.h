@@ -11,7 +11,13 @@
 #ifndef odc_core_codec_Integer_H
 #define odc_core_codec_Integer_H
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
 #include "odc/core/Codec.h"
+#include "odc/core/Header.h"
 
 /// @note We have some strange behaviour in here. In particular, we support BOTH decoding
 /// and encoding integers from a representation as doubles, and also as integers.
@@ -35,9 +41,14 @@ public: // definitions
 
 public: // methods
 
+    /// No dictionary is possible with more distinct values than can be indexed in 16 bits
+    constexpr static size_t maxDistinctValues = 0x10000;
+
     BaseCodecInteger(api::ColumnType type, const std::string& name, double minmaxmissing=odc::MDI::integerMDI()) :
         core::DataStreamCodec<ByteOrder>(name, type),
-        castedMissingValue_(static_cast<ValueType>(minmaxmissing)) {
+        castedMissingValue_(static_cast<ValueType>(minmaxmissing)),
+        trackDistinct_(ODBAPISettings::instance().integerDictionaryCodecs()),
+        lastDistinct_(0) {
 
             this->min_ = minmaxmissing;
             this->max_ = minmaxmissing;
@@ -46,6 +57,45 @@ public: // methods
 
     ~BaseCodecInteger() override {}
 
+    /// The number of distinct values gathered (including any missing values). Reports more than
+    /// maxDistinctValues if there are too many to track, or they are not being tracked.
+    size_t numDistinctValues() const override {
+        return trackDistinct_ ? distinct_.size() : maxDistinctValues + 1;
+    }
+
+    std::vector<int64_t> distinctValues() const override {
+        ASSERT(trackDistinct_);
+        std::vector<int64_t> values(distinct_.begin(), distinct_.end());
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    double decodedValue(const char* value) const override {
+        ValueType v;
+        ::memcpy(&v, value, sizeof(v));
+        return v;
+    }
+
+    bool decodesIntegers() const override { return std::is_same<ValueType, int64_t>::value; }
+
+protected: // methods
+
+    /// Transform the bounds of a condition on the decoded values into bounds [lo, hi] on the stored
+    /// values of an offset codec (value = stored + offset), which lie in [0, maxStored]. The range is
+    /// empty (lo > hi) if no stored value can meet the condition.
+    static void storedRange(const core::RangeFilter::Condition& condition, double offset, double maxStored,
+                            uint32_t& lo, uint32_t& hi) {
+        double l = std::max(0.0, std::ceil(condition.min - offset));
+        double h = std::min(maxStored, std::floor(condition.max - offset));
+        if (l > h) {
+            lo = 1;
+            hi = 0;
+        } else {
+            lo = static_cast<uint32_t>(l);
+            hi = static_cast<uint32_t>(h);
+        }
+    }
+
 private: // methods
 
     void missingValue(double v) override {
@@ -68,6 +118,29 @@ private: // methods
         static_assert(sizeof(ValueType) == sizeof(v), "unsafe casting check");
         const ValueType& val(reinterpret_cast<const ValueType&>(v));
         core::Codec::gatherStats(val);
+        if (trackDistinct_) gatherDistinct(&val, 1);
+    }
+
+    void gatherStatsBlock(const double* values, size_t count) override {
+        this->gatherStatsRange(reinterpret_cast<const ValueType*>(values), count);
+        if (trackDistinct_) gatherDistinct(reinterpret_cast<const ValueType*>(values), count);
+    }
+
+    void gatherDistinct(const ValueType* values, size_t count) {
+
+        // Runs of repeated values are common, and need not be looked up
+
+        for (size_t i = 0; i < count; ++i) {
+            int64_t v = static_cast<int64_t>(values[i]);
+            if (v == lastDistinct_ && !distinct_.empty()) continue;
+            lastDistinct_ = v;
+            distinct_.insert(v);
+            if (distinct_.size() > maxDistinctValues) {
+                distinct_.clear();
+                trackDistinct_ = false;
+                return;
+            }
+        }
     }
 
 protected: // members
@@ -76,6 +149,12 @@ protected: // members
     ///         directly where needed is to work around a Cray 8.7 compiler bug, where
     ///         where the punned version gets optimised out
     ValueType castedMissingValue_;
+
+private: // members
+
+    bool trackDistinct_;
+    int64_t lastDistinct_;
+    std::unordered_set<int64_t> distinct_;
 };
 
 
@@ -92,6 +171,16 @@ public: // methods
     CodecIntegerOffset(api::ColumnType type) : BaseCodecInteger<ByteOrder, ValueType>(type, DerivedCodec::codec_name()) {}
     ~CodecIntegerOffset() override {}
 
+    /// Decode a single value without going through a DataStream. Used by the block decoders.
+    static ValueType decodeValue(const char* in, double min) {
+        InternalValueType s;
+        ::memcpy(&s, in, sizeof(s));
+        ByteOrder::swap(s);
+        return s + min;
+    }
+
+    size_t encodedSize() const override { return sizeof(InternalValueType); }
+
 private: // methods
 
     unsigned char* encode(unsigned char* p, const double& d) override {
@@ -119,6 +208,27 @@ private: // methods
     void skip() override {
         this->ds().advance(sizeof(InternalValueType));
     }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        const double min = this->min_;
+        core::decodeRowBlock(block, col, out, [min](const char* in, char* o) {
+            *reinterpret_cast<ValueType*>(o) = decodeValue(in, min);
+        });
+    }
+
+    /// Compares the stored values against the bounds of the condition, less the offset
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+        uint32_t lo;
+        uint32_t hi;
+        this->storedRange(condition, this->min_, (uint64_t(1) << (8 * sizeof(InternalValueType))) - 1, lo, hi);
+        core::filterRowBlock(block, col, result, [lo, hi](const char* in) {
+            InternalValueType s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            uint32_t v = s;
+            return v >= lo && v <= hi;
+        });
+    }
 };
 
 
@@ -135,6 +245,8 @@ public: // methods
     CodecIntegerDirect(api::ColumnType type) : BaseCodecInteger<ByteOrder, ValueType>(type, DerivedCodec::codec_name()) {}
     ~CodecIntegerDirect() override {}
 
+    size_t encodedSize() const override { return sizeof(InternalValueType); }
+
 private: // methods
 
     unsigned char* encode(unsigned char* p, const double& d) override {
@@ -159,6 +271,27 @@ private: // methods
     void skip() override {
         this->ds().advance(sizeof(InternalValueType));
     }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        core::decodeRowBlock(block, col, out, [](const char* in, char* o) {
+            InternalValueType s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            *reinterpret_cast<ValueType*>(o) = s;
+        });
+    }
+
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+        const double lo = condition.min;
+        const double hi = condition.max;
+        core::filterRowBlock(block, col, result, [lo, hi](const char* in) {
+            InternalValueType s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            double v = s;
+            return v >= lo && v <= hi;
+        });
+    }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -179,6 +312,64 @@ struct CodecInt16 : public CodecIntegerOffset<ByteOrder, ValueType, uint16_t, Co
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// An unsigned 24-bit integer, stored in three bytes in the native byte order. Byte swapping the
+/// three bytes converts between byte orders, so it can be used as the InternalValueType of the
+/// integer codecs like any other integral type.
+
+class UInt24 {
+
+public: // methods
+
+    UInt24() = default;
+
+    UInt24(uint64_t v) {
+        if (littleEndian()) {
+            bytes_[0] = uint8_t(v);
+            bytes_[1] = uint8_t(v >> 8);
+            bytes_[2] = uint8_t(v >> 16);
+        } else {
+            bytes_[0] = uint8_t(v >> 16);
+            bytes_[1] = uint8_t(v >> 8);
+            bytes_[2] = uint8_t(v);
+        }
+    }
+
+    operator uint32_t() const {
+        if (littleEndian()) {
+            return uint32_t(bytes_[0]) | (uint32_t(bytes_[1]) << 8) | (uint32_t(bytes_[2]) << 16);
+        } else {
+            return (uint32_t(bytes_[0]) << 16) | (uint32_t(bytes_[1]) << 8) | uint32_t(bytes_[2]);
+        }
+    }
+
+private: // methods
+
+    static bool littleEndian() {
+        const uint16_t probe = 1;
+        return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    }
+
+private: // members
+
+    uint8_t bytes_[3];
+};
+
+static_assert(sizeof(UInt24) == 3, "UInt24 must be packed into three bytes");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Fills the gap between int16 and int32, for columns whose range of values needs more than 16 bits.
+/// Requires format version 0.7.
+
+template<typename ByteOrder, typename ValueType>
+struct CodecInt24 : public CodecIntegerOffset<ByteOrder, ValueType, UInt24, CodecInt24<ByteOrder, ValueType>> {
+    constexpr static const char* codec_name() { return "int24"; }
+    using CodecIntegerOffset<ByteOrder, ValueType, UInt24, CodecInt24<ByteOrder, ValueType>>::CodecIntegerOffset;
+    int32_t formatVersionMinor() const override { return core::FORMAT_VERSION_NUMBER_MINOR_INT24; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 template<typename ByteOrder, typename ValueType>
 struct CodecInt32 : public CodecIntegerDirect<ByteOrder, ValueType, int32_t, CodecInt32<ByteOrder, ValueType>> {
     constexpr static const char* codec_name() { return "int32"; }
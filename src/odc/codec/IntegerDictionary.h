@@ -0,0 +1,190 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef odc_core_codec_IntegerDictionary_H
+#define odc_core_codec_IntegerDictionary_H
+
+#include <algorithm>
+#include <vector>
+
+#include "odc/codec/Integer.h"
+
+namespace odc {
+namespace codec {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Integer columns with few distinct values, spread over a wide range, are stored as a (sorted)
+/// table of the distinct values in the header, and an index into that table for each row. Any
+/// missing value is stored in the table like any other value.
+///
+/// Modelled on IntStringCodecBase. Requires format version 0.9.
+
+template<typename ByteOrder, typename ValueType, typename InternalCodec>
+class IntDictionaryCodecBase : public BaseCodecInteger<ByteOrder, ValueType> {
+
+    static_assert(std::is_same<typename InternalCodec::value_type, int64_t>::value, "Safety check");
+    using InternalInt = typename InternalCodec::value_type;
+
+public: // methods
+
+    IntDictionaryCodecBase(api::ColumnType type, const std::string& name) :
+        BaseCodecInteger<ByteOrder, ValueType>(type, name),
+        intCodec_(api::INTEGER) {
+        intCodec_.min(0);
+    }
+    ~IntDictionaryCodecBase() override {}
+
+    size_t encodedSize() const override { return intCodec_.encodedSize(); }
+
+    int32_t formatVersionMinor() const override { return core::FORMAT_VERSION_NUMBER_MINOR_INT_DICTIONARY; }
+
+    size_t numDistinctValues() const override { return values_.size(); }
+    std::vector<int64_t> distinctValues() const override { return values_; }
+
+    void distinctValues(const std::vector<int64_t>& values) override {
+        ASSERT(std::is_sorted(values.begin(), values.end()));
+        ASSERT(values.size() <= (size_t(1) << (8 * intCodec_.encodedSize())));
+        values_ = values;
+        decodedValues_.assign(values.begin(), values.end());
+    }
+
+private: // methods
+
+    std::unique_ptr<core::Codec> clone() override {
+        std::unique_ptr<core::Codec> cdc = core::Codec::clone();
+        cdc->distinctValues(values_);
+        return cdc;
+    }
+
+    /// Ensure that data streams are passed through to the internal coder
+    using core::DataStreamCodec<ByteOrder>::setDataStream;
+    void setDataStream(core::DataStream<ByteOrder>& ds) override {
+        core::DataStreamCodec<ByteOrder>::setDataStream(ds);
+        intCodec_.setDataStream(ds);
+    }
+
+    void clearDataStream() override {
+        core::DataStreamCodec<ByteOrder>::clearDataStream();
+        intCodec_.clearDataStream();
+    }
+
+    unsigned char* encode(unsigned char* p, const double& d) override {
+        static_assert(sizeof(ValueType) == sizeof(d), "unsafe casting check");
+
+        const ValueType& val(reinterpret_cast<const ValueType&>(d));
+        int64_t v = static_cast<int64_t>(val);
+        auto it = std::lower_bound(values_.begin(), values_.end(), v);
+        ASSERT(it != values_.end() && *it == v);
+
+        // n.b. CodecInt*<, int64_t> undoes the reinterpret cast internally
+        InternalInt internal = it - values_.begin();
+        return static_cast<core::Codec&>(intCodec_).encode(p, reinterpret_cast<const double&>(internal));
+    }
+
+    void decode(double* out) override {
+        static_assert(sizeof(ValueType) == sizeof(out), "unsafe casting check");
+
+        InternalInt i;
+        static_cast<core::Codec&>(intCodec_).decode(reinterpret_cast<double*>(&i));
+
+        ASSERT(i < InternalInt(decodedValues_.size()));
+        *reinterpret_cast<ValueType*>(out) = decodedValues_[i];
+    }
+
+    void skip() override {
+        static_cast<core::Codec&>(intCodec_).skip();
+    }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        const ValueType* table = decodedValues_.data();
+        const InternalInt nvalues = decodedValues_.size();
+        core::decodeRowBlock(block, col, out, [table, nvalues](const char* in, char* o) {
+            InternalInt i = InternalCodec::decodeValue(in, 0);
+            ASSERT(i < nvalues);
+            *reinterpret_cast<ValueType*>(o) = table[i];
+        });
+    }
+
+    /// The condition is evaluated once for each entry in the table, and the indices looked up
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+        std::vector<char> matches(decodedValues_.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            matches[i] = (decodedValues_[i] >= condition.min && decodedValues_[i] <= condition.max);
+        }
+        const char* table = matches.data();
+        const InternalInt nvalues = matches.size();
+        core::filterRowBlock(block, col, result, [table, nvalues](const char* in) {
+            InternalInt i = InternalCodec::decodeValue(in, 0);
+            ASSERT(i < nvalues);
+            return table[i];
+        });
+    }
+
+    using core::DataStreamCodec<ByteOrder>::load;
+    void load(core::DataStream<ByteOrder>& ds) override {
+        core::DataStreamCodec<ByteOrder>::load(ds);
+        this->castedMissingValue_ = static_cast<ValueType>(this->missingValue_);
+
+        int32_t numValues;
+        ds.read(numValues);
+        ASSERT(numValues >= 0);
+
+        std::vector<int64_t> values(numValues);
+        for (int64_t& v : values) ds.read(v);
+        distinctValues(values);
+    }
+
+    using core::DataStreamCodec<ByteOrder>::save;
+    void save(core::DataStream<ByteOrder>& ds) override {
+        core::DataStreamCodec<ByteOrder>::save(ds);
+
+        ds.write(static_cast<int32_t>(values_.size()));
+        for (int64_t v : values_) ds.write(v);
+    }
+
+    void print(std::ostream& s) const override {
+        s << this->name_
+          << ", range=<" << std::fixed << this->min_ << "," << this->max_ << ">"
+          << ", hasMissing=" << (this->hasMissing_?"true":"false")
+          << ", #values=" << values_.size();
+    }
+
+private: // members
+
+    InternalCodec intCodec_;
+    std::vector<int64_t> values_;
+    std::vector<ValueType> decodedValues_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template<typename ByteOrder, typename ValueType>
+struct CodecInt8Dictionary : public IntDictionaryCodecBase<ByteOrder, ValueType, CodecInt8<ByteOrder, int64_t>> {
+    constexpr static const char* codec_name() { return "int8_dictionary"; }
+    CodecInt8Dictionary(api::ColumnType type) : IntDictionaryCodecBase<ByteOrder, ValueType, CodecInt8<ByteOrder, int64_t>>(type, codec_name()) {}
+    ~CodecInt8Dictionary() override {}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template<typename ByteOrder, typename ValueType>
+struct CodecInt16Dictionary : public IntDictionaryCodecBase<ByteOrder, ValueType, CodecInt16<ByteOrder, int64_t>> {
+    constexpr static const char* codec_name() { return "int16_dictionary"; }
+    CodecInt16Dictionary(api::ColumnType type) : IntDictionaryCodecBase<ByteOrder, ValueType, CodecInt16<ByteOrder, int64_t>>(type, codec_name()) {}
+    ~CodecInt16Dictionary() override {}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace codec
+} // namespace odc
+
+#endif
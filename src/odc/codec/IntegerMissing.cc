@@ -22,6 +22,7 @@ namespace codec {
 namespace {
     core::IntegerCodecBuilder<CodecInt8Missing> int8MissingBuilder;
     core::IntegerCodecBuilder<CodecInt16Missing> int16MissingBuilder;
+    core::IntegerCodecBuilder<CodecInt24Missing> int24MissingBuilder;
     core::IntegerCodecBuilder<CodecConstantOrMissing> constantOrMissingBuilder;
     core::CodecBuilder<CodecRealConstantOrMissing> realConstantOrMissingBuilder;
 }
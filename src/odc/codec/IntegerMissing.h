@@ -34,6 +34,8 @@ public: // methods
         BaseCodecInteger<ByteOrder, ValueType>(type, name, minmaxmissing) {}
     ~BaseCodecMissing() {}
 
+    size_t encodedSize() const override { return sizeof(InternalValueType); }
+
 private: // methods
 
     static std::string codec_name_str() { return DerivedCodec::codec_name(); }
@@ -66,6 +68,34 @@ private: // methods
     void skip() override {
         this->ds().advance(sizeof(InternalValueType));
     }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        const double missingValue = this->missingValue_;
+        const double min = this->min_;
+        core::decodeRowBlock(block, col, out, [missingValue, min](const char* in, char* o) {
+            InternalValueType s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            *reinterpret_cast<ValueType*>(o) = (s == DerivedCodec::missingMarker ? missingValue : (s + min));
+        });
+    }
+
+    /// Compares the stored values against the bounds of the condition, less the offset. The missing
+    /// marker matches if the missing value meets the condition.
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+        uint32_t lo;
+        uint32_t hi;
+        this->storedRange(condition, this->min_, uint32_t(DerivedCodec::missingMarker) - 1, lo, hi);
+        const ValueType missing = this->castedMissingValue_;
+        const bool matchMissing = (missing >= condition.min && missing <= condition.max);
+        core::filterRowBlock(block, col, result, [lo, hi, matchMissing](const char* in) {
+            InternalValueType s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            uint32_t v = s;
+            return (v == DerivedCodec::missingMarker) ? matchMissing : (v >= lo && v <= hi);
+        });
+    }
 };
 
 
@@ -87,6 +117,14 @@ struct CodecInt16Missing : public BaseCodecMissing<ByteOrder, ValueType, uint16_
     using BaseCodecMissing<ByteOrder, ValueType, uint16_t, CodecInt16Missing<ByteOrder, ValueType>>::BaseCodecMissing;
 };
 
+template<typename ByteOrder, typename ValueType>
+struct CodecInt24Missing : public BaseCodecMissing<ByteOrder, ValueType, UInt24, CodecInt24Missing<ByteOrder, ValueType>> {
+    constexpr static const char* codec_name() { return "int24_missing"; }
+    constexpr static uint32_t missingMarker = 0xffffff;
+    using BaseCodecMissing<ByteOrder, ValueType, UInt24, CodecInt24Missing<ByteOrder, ValueType>>::BaseCodecMissing;
+    int32_t formatVersionMinor() const override { return core::FORMAT_VERSION_NUMBER_MINOR_INT24; }
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 
 
@@ -23,6 +23,7 @@ namespace {
     core::CodecBuilder<CodecLongReal> longRealBuilder;
     core::CodecBuilder<CodecShortReal> shortRealBuilder;
     core::CodecBuilder<CodecShortReal2> shortReal2Builder;
+    core::CodecBuilder<CodecXorReal> xorRealBuilder;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -11,7 +11,11 @@
 #ifndef odc_core_codec_Real_H
 #define odc_core_codec_Real_H
 
+#include <algorithm>
+#include <type_traits>
+
 #include "odc/core/Codec.h"
+#include "odc/core/Header.h"
 
 
 namespace odc {
@@ -37,13 +41,23 @@ public: // methods
     CodecLongReal(api::ColumnType type) :
         core::DataStreamCodec<ByteOrder>(codec_name(), type),
         hasShortRealInternalMissing_(false),
-        hasShortReal2InternalMissing_(false) {}
+        hasShortReal2InternalMissing_(false),
+        hasXorReference_(false),
+        xorReference_(0),
+        xorBits_(0) {}
 
     ~CodecLongReal() override {}
 
     bool hasShortRealInternalMissing() const { return hasShortRealInternalMissing_; }
     bool hasShortReal2InternalMissing() const { return hasShortReal2InternalMissing_; }
 
+    /// The bits of the first value seen, and the bits in which any value differs from them. Used
+    /// by the CodecOptimizer to size the xor_real codec.
+    uint64_t xorReference() const { return xorReference_; }
+    uint64_t xorBits() const { return xorBits_; }
+
+    size_t encodedSize() const override { return sizeof(double); }
+
 private: // methods
 
     unsigned char* encode(unsigned char* p, const double& d) override {
@@ -61,6 +75,26 @@ private: // methods
         this->ds().advance(sizeof(double));
     }
 
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        core::decodeRowBlock(block, col, out, [](const char* in, char* o) {
+            double d;
+            ::memcpy(&d, in, sizeof(d));
+            ByteOrder::swap(d);
+            ::memcpy(o, &d, sizeof(d));
+        });
+    }
+
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+        const double lo = condition.min;
+        const double hi = condition.max;
+        core::filterRowBlock(block, col, result, [lo, hi](const char* in) {
+            double d;
+            ::memcpy(&d, in, sizeof(d));
+            ByteOrder::swap(d);
+            return d >= lo && d <= hi;
+        });
+    }
+
     /// Keep track on internal missing value collisions, to help the CodecOptimizer.
     void gatherStats(const double& v) override {
         core::Codec::gatherStats(v);
@@ -69,12 +103,52 @@ private: // methods
         float realInternalMissing2 = reinterpret_cast<const float&>(maxFloatAsInt);
         if (v == realInternalMissing) hasShortRealInternalMissing_ = true;
         if (v == realInternalMissing2) hasShortReal2InternalMissing_ = true;
+
+        uint64_t bits;
+        ::memcpy(&bits, &v, sizeof(bits));
+        if (!hasXorReference_) {
+            xorReference_ = bits;
+            hasXorReference_ = true;
+        }
+        xorBits_ |= (bits ^ xorReference_);
+    }
+
+    void gatherStatsBlock(const double* values, size_t count) override {
+        this->gatherStatsRange(values, count);
+
+        float realInternalMissing = reinterpret_cast<const float&>(minFloatAsInt);
+        float realInternalMissing2 = reinterpret_cast<const float&>(maxFloatAsInt);
+        bool hasInternalMissing = false;
+        bool hasInternalMissing2 = false;
+        for (size_t i = 0; i < count; ++i) {
+            hasInternalMissing |= (values[i] == realInternalMissing);
+            hasInternalMissing2 |= (values[i] == realInternalMissing2);
+        }
+        if (hasInternalMissing) hasShortRealInternalMissing_ = true;
+        if (hasInternalMissing2) hasShortReal2InternalMissing_ = true;
+
+        if (count == 0) return;
+        const uint64_t* bits = reinterpret_cast<const uint64_t*>(values);
+        if (!hasXorReference_) {
+            xorReference_ = bits[0];
+            hasXorReference_ = true;
+        }
+        const uint64_t reference = xorReference_;
+        uint64_t xorBits = xorBits_;
+        for (size_t i = 0; i < count; ++i) {
+            xorBits |= (bits[i] ^ reference);
+        }
+        xorBits_ = xorBits;
     }
 
 private: // members
 
     bool hasShortRealInternalMissing_;
     bool hasShortReal2InternalMissing_;
+
+    bool hasXorReference_;
+    uint64_t xorReference_;
+    uint64_t xorBits_;
 };
 
 
@@ -88,6 +162,8 @@ public: // methods
     ShortRealBase(api::ColumnType type, const std::string& name) : core::DataStreamCodec<ByteOrder>(name, type) {}
     ~ShortRealBase() override {}
 
+    size_t encodedSize() const override { return sizeof(float); }
+
 private: // methods
 
     unsigned char* encode(unsigned char* p, const double& d) override {
@@ -119,6 +195,18 @@ private: // methods
     void skip() override {
         this->ds().advance(sizeof(float));
     }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        const uint32_t internalMissingInt = InternalMissing;
+        const float internalMissing = reinterpret_cast<const float&>(internalMissingInt);
+        const double missingValue = this->missingValue_;
+        core::decodeRowBlock(block, col, out, [internalMissing, missingValue](const char* in, char* o) {
+            float s;
+            ::memcpy(&s, in, sizeof(s));
+            ByteOrder::swap(s);
+            *reinterpret_cast<double*>(o) = (s == internalMissing ? missingValue : s);
+        });
+    }
 };
 
 
@@ -138,6 +226,172 @@ struct CodecShortReal2 : public ShortRealBase<ByteOrder, real2MissingAsInt> {
 };
 
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Stores the bits of each value XORed with those of a reference value from the column. Correlated
+/// values share their sign, exponent and leading mantissa bits (and often trailing zero bits), so
+/// only the window of bits in which any value differs from the reference is stored, in the minimal
+/// number of bytes. The encoding is lossless, including for the missing value. Requires format
+/// version 0.8.
+
+template <typename ByteOrder>
+class CodecXorReal : public core::DataStreamCodec<ByteOrder> {
+
+public: // definitions
+
+    constexpr static const char* codec_name() { return "xor_real"; }
+
+public: // methods
+
+    CodecXorReal(api::ColumnType type) :
+        core::DataStreamCodec<ByteOrder>(codec_name(), type),
+        reference_(0),
+        shift_(0),
+        width_(sizeof(double)) {}
+
+    ~CodecXorReal() override {}
+
+    /// The number of bytes needed to store the bits in which values differ from the reference
+    static size_t encodedWidth(uint64_t xorBits) {
+        int32_t shift;
+        int32_t width;
+        fitWindow(xorBits, shift, width);
+        return width;
+    }
+
+    /// Configure the codec for values that differ from the reference only in xorBits
+    void fit(uint64_t reference, uint64_t xorBits) {
+        reference_ = reference;
+        fitWindow(xorBits, shift_, width_);
+    }
+
+    void xorParameters(uint64_t reference, int32_t shift, int32_t width) {
+        ASSERT(shift >= 0 && shift < 64);
+        ASSERT(width > 0 && width <= int32_t(sizeof(double)));
+        reference_ = reference;
+        shift_ = shift;
+        width_ = width;
+    }
+
+    size_t encodedSize() const override { return width_; }
+
+    int32_t formatVersionMinor() const override { return core::FORMAT_VERSION_NUMBER_MINOR_XOR_REAL; }
+
+private: // methods
+
+    static void fitWindow(uint64_t xorBits, int32_t& shift, int32_t& width) {
+        int32_t lowBit = 0;
+        int32_t highBit = 0;
+        for (int32_t bit = 0; bit < 64; ++bit) {
+            if (xorBits & (uint64_t(1) << bit)) {
+                if (highBit == 0) lowBit = bit;
+                highBit = bit + 1;
+            }
+        }
+        shift = lowBit;
+        width = std::max((highBit - lowBit + 7) / 8, 1);
+    }
+
+    /// The stored bytes are the least significant bytes of the shifted value, in the byte order of
+    /// the data. This is the offset of those bytes within the (byte swapped) 64-bit value.
+    size_t valueOffset() const {
+        const uint16_t probe = 1;
+        bool littleEndian = (*reinterpret_cast<const uint8_t*>(&probe) == 1);
+        bool dataLittleEndian = (littleEndian != std::is_same<ByteOrder, core::OtherByteOrder>::value);
+        return dataLittleEndian ? 0 : sizeof(uint64_t) - width_;
+    }
+
+    std::unique_ptr<core::Codec> clone() override {
+        std::unique_ptr<core::Codec> cdc = core::Codec::clone();
+        static_cast<CodecXorReal<core::SameByteOrder>&>(*cdc).xorParameters(reference_, shift_, width_);
+        return cdc;
+    }
+
+    unsigned char* encode(unsigned char* p, const double& d) override {
+        uint64_t bits;
+        ::memcpy(&bits, &d, sizeof(bits));
+        uint64_t v = (bits ^ reference_) >> shift_;
+        ASSERT(width_ == sizeof(uint64_t) || (v >> (8 * width_)) == 0);
+        ByteOrder::swap(v);
+        ::memcpy(p, reinterpret_cast<const char*>(&v) + valueOffset(), width_);
+        return p + width_;
+    }
+
+    void decode(double* out) override {
+        uint64_t v = 0;
+        this->ds().readBytes(reinterpret_cast<char*>(&v) + valueOffset(), width_);
+        ByteOrder::swap(v);
+        uint64_t bits = (v << shift_) ^ reference_;
+        ::memcpy(out, &bits, sizeof(bits));
+    }
+
+    void skip() override {
+        this->ds().advance(width_);
+    }
+
+    /// The width is fixed for each kernel, so that the copies are inlined
+    template <size_t WIDTH>
+    void decodeBlockWidth(const core::RowBlock& block, size_t col, api::StridedData& out) {
+        const uint64_t reference = reference_;
+        const int32_t shift = shift_;
+        const size_t offset = valueOffset();
+        core::decodeRowBlock(block, col, out, [reference, shift, offset](const char* in, char* o) {
+            uint64_t v = 0;
+            ::memcpy(reinterpret_cast<char*>(&v) + offset, in, WIDTH);
+            ByteOrder::swap(v);
+            uint64_t bits = (v << shift) ^ reference;
+            ::memcpy(o, &bits, sizeof(bits));
+        });
+    }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+        switch (width_) {
+            case 1: decodeBlockWidth<1>(block, col, out); break;
+            case 2: decodeBlockWidth<2>(block, col, out); break;
+            case 3: decodeBlockWidth<3>(block, col, out); break;
+            case 4: decodeBlockWidth<4>(block, col, out); break;
+            case 5: decodeBlockWidth<5>(block, col, out); break;
+            case 6: decodeBlockWidth<6>(block, col, out); break;
+            case 7: decodeBlockWidth<7>(block, col, out); break;
+            case 8: decodeBlockWidth<8>(block, col, out); break;
+            default: throw eckit::SeriousBug("Invalid xor_real width", Here());
+        }
+    }
+
+    using core::DataStreamCodec<ByteOrder>::load;
+    void load(core::DataStream<ByteOrder>& ds) override {
+        core::DataStreamCodec<ByteOrder>::load(ds);
+        uint64_t reference;
+        int32_t shift;
+        int32_t width;
+        ds.read(reference);
+        ds.read(shift);
+        ds.read(width);
+        xorParameters(reference, shift, width);
+    }
+
+    using core::DataStreamCodec<ByteOrder>::save;
+    void save(core::DataStream<ByteOrder>& ds) override {
+        core::DataStreamCodec<ByteOrder>::save(ds);
+        ds.write(reference_);
+        ds.write(shift_);
+        ds.write(width_);
+    }
+
+    void print(std::ostream& s) const override {
+        s << this->name_
+          << ", range=<" << std::fixed << this->min_ << "," << this->max_ << ">"
+          << ", hasMissing=" << (this->hasMissing_?"true":"false")
+          << ", width=" << width_;
+    }
+
+private: // members
+
+    uint64_t reference_;
+    int32_t shift_;
+    int32_t width_;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 
 } // namespace codec
@@ -12,7 +12,9 @@
 #define odc_core_codec_String_H
 
 #include "odc/core/Codec.h"
+#include "odc/core/StringTable.h"
 #include "odc/codec/Integer.h"
+#include "odc/codec/StringInterner.h"
 #include "eckit/memory/Zero.h"
 
 namespace odc {
@@ -50,19 +52,40 @@ private: // methods
     unsigned char* encode(unsigned char* p, const double& d) override;
     void decode(double* out) override;
     void skip() override;
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override;
     void gatherStats(const double& v) override;
+    void gatherStatsBlock(const double* values, size_t count) override;
+
+    /// Add the string in the cell to the table of strings, if it is not already present
+    void internString(const char* cell) {
+        bool added;
+        interner_.intern(cell, added);
+        if (added) strings_.emplace_back(cell, ::strnlen(cell, decodedSizeDoubles_*sizeof(double)));
+    }
+
+    size_t encodedSize() const override { return decodedSizeDoubles_ * sizeof(double); }
 
     size_t numStrings() const override { return strings_.size(); }
     void copyStrings(core::Codec& rhs) override;
 
     size_t dataSizeDoubles() const override { return decodedSizeDoubles_; }
-    void dataSizeDoubles(size_t count) override { decodedSizeDoubles_ = count; }
+    void dataSizeDoubles(size_t count) override {
+        decodedSizeDoubles_ = count;
+        if (interner_.width() != count * sizeof(double)) rebuildInterner();
+    }
 
     void print(std::ostream &s) const override;
 
+protected: // methods
+
+    /// Re-intern the strings, for cells of the current width
+    void rebuildInterner();
+
 protected: // members
 
-    std::map<std::string, int64_t> stringLookup_;
+    template <typename> friend class CodecChars;
+
+    StringInterner interner_;
     std::vector<std::string> strings_;
     size_t decodedSizeDoubles_;
 };
@@ -81,7 +104,8 @@ public: // methods
 
     IntStringCodecBase(api::ColumnType type, const std::string& name) :
         CodecChars<ByteOrder>(type, name),
-        intCodec_(api::INTEGER) {
+        intCodec_(api::INTEGER),
+        dictionary_(core::StringTable::newDictionary()) {
 
         this->min_ = odc::MDI::integerMDI();
         this->max_ = this->min_;
@@ -119,16 +143,13 @@ private: // methods
         /// n.b. Yes this is ugly. This is a hack into the existing API - and it assumes
         ///      that the double& provided actually is the first element of a longer string.
 
-        size_t len = ::strnlen(reinterpret_cast<const char*>(&d), this->decodedSizeDoubles_*sizeof(double));
-        std::string s(reinterpret_cast<const char*>(&d), len);
-
-        auto it = this->stringLookup_.find(s);
-        ASSERT(it != this->stringLookup_.end());
+        int64_t index = this->interner_.find(reinterpret_cast<const char*>(&d));
+        ASSERT(index >= 0);
 
         // n.b. Reinterpret cast is yucky, but is for backward compatibility with old interface.
         // CodecInt*<, int64_t> undoes that internally.
         // WARNING: This is very type unsafe
-        InternalInt internal = it->second;
+        InternalInt internal = index;
         return static_cast<core::Codec&>(intCodec_).encode(p, reinterpret_cast<const double&>(internal));
     }
 
@@ -152,6 +173,70 @@ private: // methods
         static_cast<core::Codec&>(intCodec_).skip();
     }
 
+    size_t encodedSize() const override { return intCodec_.encodedSize(); }
+
+    void decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) override {
+
+        // The string table is expanded into fixed width, zero padded, entries when it is loaded,
+        // so each value can be decoded with a single copy. If we have no expanded table (e.g. a
+        // codec used for encoding) the strings are padded as they are copied. Neither path
+        // modifies the codec, so blocks may be decoded concurrently.
+
+        const size_t width = this->decodedSizeDoubles_ * sizeof(double);
+        const InternalInt nstrings = this->strings_.size();
+
+        if (paddedStrings_.size() != width * this->strings_.size()) {
+            const std::vector<std::string>& strings(this->strings_);
+            core::decodeRowBlock(block, col, out, [&strings, width, nstrings](const char* in, char* o) {
+                InternalInt i = InternalCodec::decodeValue(in, 0);
+                ASSERT(i < nstrings);
+                const std::string& s(strings[i]);
+                ::memset(o, 0, width);
+                ::memcpy(o, s.data(), std::min(s.length(), width));
+            });
+            return;
+        }
+
+        const char* table = paddedStrings_.data();
+        core::decodeRowBlock(block, col, out, [table, width, nstrings](const char* in, char* o) {
+            InternalInt i = InternalCodec::decodeValue(in, 0);
+            ASSERT(i < nstrings);
+            ::memcpy(o, &table[i * width], width);
+        });
+    }
+
+    /// The strings of the table are merged into the output table once, and the indices mapped
+    /// to its codes, so no characters are copied per value
+    void decodeBlockCodes(const core::RowBlock& block, size_t col, api::StridedData& out, core::StringTable& strings) override {
+
+        const int32_t* codes = strings.merge(dictionary_, this->strings_).data();
+        const InternalInt nstrings = this->strings_.size();
+        core::decodeRowBlock(block, col, out, [codes, nstrings](const char* in, char* o) {
+            InternalInt i = InternalCodec::decodeValue(in, 0);
+            ASSERT(i < nstrings);
+            ::memcpy(o, &codes[i], sizeof(int32_t));
+        });
+    }
+
+    /// The condition is evaluated once for each string in the table, and the indices looked up
+    void filterBlock(const core::RowBlock& block, size_t col, const core::RangeFilter::Condition& condition, char* result) override {
+
+        const size_t width = this->decodedSizeDoubles_ * sizeof(double);
+        std::vector<char> matches(this->strings_.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            const std::string& s(this->strings_[i]);
+            matches[i] = condition.isString && this->matchesString(s.data(), std::min(s.length(), width), condition);
+        }
+
+        const char* table = matches.data();
+        const InternalInt nstrings = matches.size();
+        core::filterRowBlock(block, col, result, [table, nstrings](const char* in) {
+            InternalInt i = InternalCodec::decodeValue(in, 0);
+            ASSERT(i < nstrings);
+            return table[i];
+        });
+    }
+
     using CodecChars<ByteOrder>::load;
     void load(core::DataStream<ByteOrder>& ds) override {
         core::DataStreamCodec<ByteOrder>::load(ds);
@@ -161,8 +246,10 @@ private: // methods
         int32_t numStrings;
         ds.read(numStrings);
         ASSERT(numStrings >= 0);
+        ASSERT(size_t(numStrings) <= (size_t(1) << (8 * intCodec_.encodedSize())));
 
         this->strings_.resize(numStrings);
+        dictionary_ = core::StringTable::newDictionary();
 
         // How many doubles-worth of memory is needed to decode the largest string?
         this->decodedSizeDoubles_ = 1;
@@ -186,7 +273,28 @@ private: // methods
         }
 
         // Ensure that the string lookup is EMPTY. We don't use it after reading
-        ASSERT(this->stringLookup_.size() == 0);
+        ASSERT(this->interner_.size() == 0);
+
+        expandStrings();
+    }
+
+    /// If the width of the decoded strings is changed (e.g. to match other tables in an aggregated
+    /// frame), the expanded table must be rebuilt rather than falling back to a slower path
+    void dataSizeDoubles(size_t count) override {
+        this->decodedSizeDoubles_ = count;
+        if (this->interner_.width() != count * sizeof(double)) this->rebuildInterner();
+        if (!paddedStrings_.empty()) expandStrings();
+    }
+    size_t dataSizeDoubles() const override { return this->decodedSizeDoubles_; }
+
+    /// Expand the string table into fixed width, zero padded, entries for use by decodeBlock
+    void expandStrings() {
+        const size_t width = this->decodedSizeDoubles_ * sizeof(double);
+        paddedStrings_.assign(width * this->strings_.size(), 0);
+        for (size_t i = 0; i < this->strings_.size(); ++i) {
+            const std::string& s(this->strings_[i]);
+            ::memcpy(&paddedStrings_[i * width], s.data(), std::min(s.length(), width));
+        }
     }
 
     using CodecChars<ByteOrder>::save;
@@ -206,6 +314,8 @@ private: // methods
 private: // members
 
     InternalCodec intCodec_;
+    std::vector<char> paddedStrings_;
+    uint64_t dictionary_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -257,17 +367,19 @@ void CodecChars<ByteOrder>::skip() {
     this->ds().advance(sizeof(double) * decodedSizeDoubles_);
 }
 
+template <typename ByteOrder>
+void CodecChars<ByteOrder>::decodeBlock(const core::RowBlock& block, size_t col, api::StridedData& out) {
+    const size_t width = sizeof(double) * decodedSizeDoubles_;
+    core::decodeRowBlock(block, col, out, [width](const char* in, char* o) {
+        ::memcpy(o, in, width);
+    });
+}
+
 template<typename ByteOrder>
 void CodecChars<ByteOrder>::gatherStats(const double& v) {
 
+    internString(reinterpret_cast<const char*>(&v));
     size_t len = ::strnlen(reinterpret_cast<const char*>(&v), decodedSizeDoubles_*sizeof(double));
-    std::string s(reinterpret_cast<const char*>(&v), len);
-
-    if (stringLookup_.find(s) == stringLookup_.end()) {
-        size_t index = strings_.size();
-        strings_.push_back(s);
-        stringLookup_[s] = index;
-    }
 
     // In case the column is const, the const value will be copied and used by the optimized codec.
     // n.b. we don't just do this->min_ = minVal as there is no guarantee that the length of the
@@ -276,6 +388,23 @@ void CodecChars<ByteOrder>::gatherStats(const double& v) {
     ::memcpy(&this->min_, &v, std::min(sizeof(double), len));
 }
 
+template<typename ByteOrder>
+void CodecChars<ByteOrder>::gatherStatsBlock(const double* values, size_t count) {
+
+    if (count == 0) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        internString(reinterpret_cast<const char*>(&values[i * decodedSizeDoubles_]));
+    }
+
+    // As for gatherStats, the last value is retained in case the column is constant
+
+    const double& last(values[(count - 1) * decodedSizeDoubles_]);
+    size_t len = ::strnlen(reinterpret_cast<const char*>(&last), decodedSizeDoubles_*sizeof(double));
+    eckit::zero(this->min_);
+    ::memcpy(&this->min_, &last, std::min(sizeof(double), len));
+}
+
 
 template<typename ByteOrder>
 void CodecChars<ByteOrder>::load(core::DataStream<ByteOrder>& ds) {
@@ -298,7 +427,7 @@ std::unique_ptr<core::Codec> CodecChars<ByteOrder>::clone() {
 
     std::unique_ptr<core::Codec> cdc = core::Codec::clone();
     auto& c = static_cast<CodecChars&>(*cdc);
-    c.stringLookup_ = stringLookup_;
+    c.interner_ = interner_;
     c.strings_ = strings_;
     c.decodedSizeDoubles_ = decodedSizeDoubles_;
     ASSERT(c.min() == this->min_);
@@ -308,10 +437,38 @@ std::unique_ptr<core::Codec> CodecChars<ByteOrder>::clone() {
 
 template<typename ByteOrder>
 void CodecChars<ByteOrder>::copyStrings(core::Codec& rhs) {
-    CodecChars<ByteOrder>* c = dynamic_cast<CodecChars<ByteOrder>*>(&rhs);
-    ASSERT(c);
-    strings_ = c->strings_;
-    stringLookup_ = c->stringLookup_;
+
+    // n.b. The strings may have been gathered by a codec of either byte order
+
+    if (CodecChars<core::SameByteOrder>* c = dynamic_cast<CodecChars<core::SameByteOrder>*>(&rhs)) {
+        strings_ = c->strings_;
+        interner_ = c->interner_;
+    } else {
+        CodecChars<core::OtherByteOrder>* o = dynamic_cast<CodecChars<core::OtherByteOrder>*>(&rhs);
+        ASSERT(o);
+        strings_ = o->strings_;
+        interner_ = o->interner_;
+    }
+
+    if (interner_.width() != decodedSizeDoubles_ * sizeof(double)) rebuildInterner();
+}
+
+template<typename ByteOrder>
+void CodecChars<ByteOrder>::rebuildInterner() {
+
+    const size_t width = decodedSizeDoubles_ * sizeof(double);
+    interner_.reset(width);
+
+    std::vector<char> cell(width);
+    for (const std::string& s : strings_) {
+        ASSERT(s.length() <= width);
+        std::fill(cell.begin(), cell.end(), 0);
+        ::memcpy(&cell[0], s.data(), s.length());
+
+        bool added;
+        interner_.intern(&cell[0], added);
+        ASSERT(added);
+    }
 }
 
 template<typename ByteOrder>
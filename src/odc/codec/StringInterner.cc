@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#include "odc/codec/StringInterner.h"
+
+#include <limits>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace odc {
+namespace codec {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+    const size_t initialSlots = 64;
+}
+
+StringInterner::StringInterner(size_t width) :
+    words_(0),
+    count_(0) {
+    reset(width);
+}
+
+void StringInterner::reset(size_t width) {
+    ASSERT(width > 0 && width % sizeof(uint64_t) == 0);
+    words_ = width / sizeof(uint64_t);
+    count_ = 0;
+    arena_.clear();
+    slots_.assign(initialSlots, 0);
+    key_.assign(words_, 0);
+}
+
+int32_t StringInterner::insert(const uint64_t* key) {
+
+    ASSERT(count_ < size_t(std::numeric_limits<int32_t>::max()));
+    arena_.insert(arena_.end(), key, key + words_);
+    int32_t value = int32_t(++count_);
+
+    // Keep the table at most half full, so that the probe sequences remain short
+
+    if (count_ * 2 > slots_.size()) {
+        grow();
+    } else {
+        slots_[slot(key)] = value;
+    }
+    return value;
+}
+
+void StringInterner::grow() {
+
+    slots_.assign(slots_.size() * 2, 0);
+    for (size_t i = 0; i < count_; ++i) {
+        slots_[slot(&arena_[i * words_])] = int32_t(i + 1);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace codec
+} // namespace odc
@@ -0,0 +1,122 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_codec_StringInterner_H
+#define odc_core_codec_StringInterner_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace odc {
+namespace codec {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Numbers the distinct strings found in fixed width (multiple of 8 byte) string cells, in the
+/// order that they are first seen. As for the string codecs, a string ends at the first null
+/// character (or the end of the cell).
+///
+/// The strings are held zero padded in a contiguous arena, and are found by open addressing
+/// with the cells compared as 64-bit words, so that looking up a string that has already been
+/// seen does not allocate.
+
+class StringInterner {
+
+public: // methods
+
+    StringInterner(size_t width=sizeof(uint64_t));
+
+    /// The width of the string cells, in bytes
+    size_t width() const { return words_ * sizeof(uint64_t); }
+
+    /// Discard all of the strings, and change the width of the cells
+    void reset(size_t width);
+
+    size_t size() const { return count_; }
+
+    /// The index of the string in the cell, or -1 if it has not been seen
+    int64_t find(const char* cell) const {
+        const uint64_t* key = canonical(cell);
+        return slots_[slot(key)] - 1;
+    }
+
+    /// The index of the string in the cell, adding it if it has not been seen
+    size_t intern(const char* cell, bool& added) {
+        const uint64_t* key = canonical(cell);
+        int32_t s = slots_[slot(key)];
+        added = (s == 0);
+        if (added) s = insert(key);
+        return size_t(s - 1);
+    }
+
+private: // methods
+
+    /// Copy the string in the cell into the scratch key, zero padded
+    const uint64_t* canonical(const char* cell) const {
+        const size_t width = words_ * sizeof(uint64_t);
+        size_t len = ::strnlen(cell, width);
+        if (len == width) {
+            ::memcpy(&key_[0], cell, width);
+        } else {
+            std::fill(key_.begin(), key_.end(), 0);
+            ::memcpy(&key_[0], cell, len);
+        }
+        return &key_[0];
+    }
+
+    static uint64_t hash(const uint64_t* key, size_t words) {
+        uint64_t h = 0;
+        for (size_t i = 0; i < words; ++i) {
+            h = (h ^ key[i]) * 0x9e3779b97f4a7c15ULL;
+            h ^= (h >> 29);
+        }
+        return h;
+    }
+
+    /// The slot holding the key, or the empty slot where it belongs
+    size_t slot(const uint64_t* key) const {
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = hash(key, words_) & mask; ; i = (i + 1) & mask) {
+            int32_t s = slots_[i];
+            if (s == 0) return i;
+            const uint64_t* entry = &arena_[size_t(s - 1) * words_];
+            bool equal = true;
+            for (size_t w = 0; w < words_; ++w) equal &= (entry[w] == key[w]);
+            if (equal) return i;
+        }
+    }
+
+    /// Add the key to the arena, returning its slot value (index + 1)
+    int32_t insert(const uint64_t* key);
+
+    void grow();
+
+private: // members
+
+    size_t words_;
+    size_t count_;
+
+    std::vector<uint64_t> arena_;
+    std::vector<int32_t> slots_; // index + 1, or 0 if empty
+
+    mutable std::vector<uint64_t> key_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace codec
+} // namespace odc
+
+#endif
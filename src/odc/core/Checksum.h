@@ -0,0 +1,34 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_Checksum_H
+#define odc_core_Checksum_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The 64-bit xxHash (XXH64) of the data. This is a fast non-cryptographic hash, used to check the
+/// integrity of table headers. The result does not depend on the byte order of the machine.
+
+uint64_t xxHash64(const void* data, size_t length, uint64_t seed=0);
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -10,9 +10,12 @@
 
 #include "odc/core/Codec.h"
 
+#include <type_traits>
+
 #include "eckit/exception/Exceptions.h"
 
 #include "odc/core/CodecFactory.h"
+#include "odc/core/StringTable.h"
 
 using namespace eckit;
 
@@ -107,6 +110,190 @@ void Codec::gatherStats(const double& v)
     }
 }
 
+void Codec::gatherStatsBlock(const double* values, size_t count)
+{
+    const size_t stride = dataSizeDoubles();
+    for (size_t i = 0; i < count; ++i) {
+        gatherStats(values[i * stride]);
+    }
+}
+
+namespace {
+
+    /// Conversion of decoded values to the requested type. Values are clamped to the range of
+    /// integer types.
+
+    template <typename Target, bool integral = std::is_integral<Target>::value>
+    struct Convert {
+
+        static Target value(double v) {
+            constexpr Target lo = std::numeric_limits<Target>::min();
+            constexpr Target hi = std::numeric_limits<Target>::max();
+            return (v < double(hi)) ? ((v > double(lo)) ? static_cast<Target>(v) : lo) : hi;
+        }
+
+        static Target value(int64_t v) {
+            constexpr Target lo = std::numeric_limits<Target>::min();
+            constexpr Target hi = std::numeric_limits<Target>::max();
+            return (v < int64_t(hi)) ? ((v > int64_t(lo)) ? static_cast<Target>(v) : lo) : hi;
+        }
+    };
+
+    template <typename Target>
+    struct Convert<Target, false> {
+        template <typename Source>
+        static Target value(Source v) { return static_cast<Target>(v); }
+    };
+
+    /// Convert the values of the rows of the block that encode the column. As for decodeRowBlock,
+    /// the other rows repeat the previous output value.
+
+    template <typename Source, typename Target>
+    void convertRowBlock(const RowBlock& block, size_t col, const char* values, api::StridedData& out) {
+        for (size_t i = 0; i < block.nrows; ++i) {
+            if (block.startCol[i] <= int(col)) {
+                Source s;
+                ::memcpy(&s, &values[i * sizeof(double)], sizeof(s));
+                Target t = Convert<Target>::value(s);
+                ::memcpy(out[i], &t, sizeof(t));
+            } else if (i != 0) {
+                ::memcpy(out[i], out[i-1], sizeof(Target));
+            }
+        }
+    }
+
+    template <typename Source>
+    void convertRowBlock(const RowBlock& block, size_t col, const char* values, api::StridedData& out, api::DecodedType type) {
+        switch (type) {
+            case api::DECODED_INT8:    convertRowBlock<Source, int8_t>(block, col, values, out); break;
+            case api::DECODED_INT16:   convertRowBlock<Source, int16_t>(block, col, values, out); break;
+            case api::DECODED_INT32:   convertRowBlock<Source, int32_t>(block, col, values, out); break;
+            case api::DECODED_INT64:   convertRowBlock<Source, int64_t>(block, col, values, out); break;
+            case api::DECODED_FLOAT32: convertRowBlock<Source, float>(block, col, values, out); break;
+            case api::DECODED_FLOAT64: convertRowBlock<Source, double>(block, col, values, out); break;
+            default:
+                throw SeriousBug("Unexpected decoded type", Here());
+        }
+    }
+}
+
+void Codec::decodeBlockAs(const RowBlock& block, size_t col, api::StridedData& out, api::DecodedType type,
+                          StringTable* strings) {
+
+    if (type == api::DECODED_DEFAULT) {
+        decodeBlock(block, col, out);
+        return;
+    }
+
+    if (type == api::DECODED_STRING_CODE) {
+        ASSERT(strings);
+        ASSERT(out.dataSize() == sizeof(int32_t));
+        decodeBlockCodes(block, col, out, *strings);
+        return;
+    }
+
+    ASSERT(dataSizeDoubles() == 1);
+    ASSERT(out.dataSize() == api::decodedTypeSize(type));
+
+    std::vector<double> buffer(block.nrows);
+    api::StridedData values(&buffer[0], block.nrows, sizeof(double), sizeof(double));
+    decodeBlock(block, col, values);
+
+    const char* data = reinterpret_cast<const char*>(&buffer[0]);
+    if (decodesIntegers()) {
+        convertRowBlock<int64_t>(block, col, data, out, type);
+    } else {
+        convertRowBlock<double>(block, col, data, out, type);
+    }
+}
+
+void Codec::decodeMissing(char* out, api::DecodedType type, StringTable* strings) {
+
+    double missing = missingValue();
+
+    if (type == api::DECODED_DEFAULT) {
+        ::memcpy(out, &missing, sizeof(missing));
+        return;
+    }
+
+    if (type == api::DECODED_STRING_CODE) {
+        ASSERT(strings);
+        const size_t width = dataSizeDoubles() * sizeof(double);
+        std::vector<char> cell(width, 0);
+        ::memcpy(&cell[0], &missing, sizeof(missing));
+        int32_t code;
+        strings->codes(&cell[0], 1, width, &code);
+        ::memcpy(out, &code, sizeof(code));
+        return;
+    }
+
+    // A single row block, in which the value is present
+
+    ptrdiff_t offset = 0;
+    int startCol = 0;
+    size_t columnOffset = 0;
+    RowBlock block { reinterpret_cast<const char*>(&missing), 1, &offset, &startCol, &columnOffset };
+    api::StridedData value(out, 1, api::decodedTypeSize(type), api::decodedTypeSize(type));
+
+    if (decodesIntegers()) {
+        convertRowBlock<int64_t>(block, 0, block.data, value, type);
+    } else {
+        convertRowBlock<double>(block, 0, block.data, value, type);
+    }
+}
+
+void Codec::decodeBlockCodes(const RowBlock& block, size_t col, api::StridedData& out, StringTable& strings) {
+
+    ASSERT(out.dataSize() == sizeof(int32_t));
+
+    const size_t width = dataSizeDoubles() * sizeof(double);
+    std::vector<double> buffer(block.nrows * dataSizeDoubles());
+    api::StridedData values(&buffer[0], block.nrows, width, width);
+    decodeBlock(block, col, values);
+
+    // Look up only the values encoded in the block, gathered to the start of the buffer. Other
+    // rows repeat the code of the previous row.
+
+    size_t npresent = 0;
+    for (size_t i = 0; i < block.nrows; ++i) {
+        if (block.startCol[i] <= int(col)) {
+            if (npresent != i) ::memcpy(values[npresent], values[i], width);
+            ++npresent;
+        }
+    }
+
+    std::vector<int32_t> codes(npresent);
+    if (npresent != 0) strings.codes(values[0], npresent, width, &codes[0]);
+
+    size_t n = 0;
+    for (size_t i = 0; i < block.nrows; ++i) {
+        if (block.startCol[i] <= int(col)) {
+            ::memcpy(out[i], &codes[n++], sizeof(int32_t));
+        } else if (i != 0) {
+            ::memcpy(out[i], out[i-1], sizeof(int32_t));
+        }
+    }
+}
+
+bool Codec::matchesDecoded(const char* value, const RangeFilter::Condition& condition) const {
+    if (condition.isString) {
+        return matchesString(value, dataSizeDoubles() * sizeof(double), condition);
+    }
+    double v = decodedValue(value);
+    return v >= condition.min && v <= condition.max;
+}
+
+bool Codec::matchesMissing(const RangeFilter::Condition& condition) const {
+    double missing = missingValue();
+    if (condition.isString) {
+        const size_t width = dataSizeDoubles() * sizeof(double);
+        std::vector<char> cell(width, 0);
+        ::memcpy(&cell[0], &missing, sizeof(missing));
+        return matchesString(&cell[0], width, condition);
+    }
+    return missing >= condition.min && missing <= condition.max;
+}
+
 void Codec::print(std::ostream& s) const {
     s << name_
       << ", range=<" << std::fixed << min_ << "," << max_ << ">"
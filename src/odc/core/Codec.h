@@ -14,10 +14,13 @@
 
 #include <cstring>
 #include <limits>
+#include <vector>
 
 #include "odc/api/ColumnType.h"
+#include "odc/api/StridedData.h"
 #include "odc/core/CodecFactory.h"
 #include "odc/core/DataStream.h"
+#include "odc/core/RangeFilter.h"
 #include "odc/MDI.h"
 
 namespace eckit { class DataHandle; }
@@ -25,6 +28,24 @@ namespace eckit { class DataHandle; }
 namespace odc {
 namespace core {
 
+class StringTable;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Describes a block of consecutive encoded rows, located by a scan over the row markers.
+/// Only the columns from startCol[i] onwards are encoded in row i, so the value of column col
+/// in row i (if present) is found at data + rowOffset[i] + columnOffset[col].
+///
+/// n.b. rowOffset[i] already has columnOffset[startCol[i]] subtracted, and so may be negative.
+
+struct RowBlock {
+    const char* data;
+    size_t nrows;
+    const ptrdiff_t* rowOffset;
+    const int* startCol;
+    const size_t* columnOffset;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 
 
@@ -44,6 +65,53 @@ public:
     virtual void decode(double* out) = 0;
     virtual void skip() = 0;
 
+    /// The number of bytes occupied by each encoded value
+    virtual size_t encodedSize() const = 0;
+
+    /// Decode the values of this column for all of the rows in a block. Rows that do not
+    /// contain an encoded value repeat the previous output value. The first output row must
+    /// already hold the correct value if it is not encoded in the block.
+    /// Implementations must not modify the codec, as the ranges of a table are decoded concurrently.
+    virtual void decodeBlock(const RowBlock& block, size_t col, api::StridedData& out) = 0;
+
+    /// As decodeBlock, but writing the values in the specified type. The block is decoded into a
+    /// temporary buffer, and converted from there while it is still in cache. String codes are
+    /// decoded with decodeBlockCodes, into the table of strings supplied.
+    void decodeBlockAs(const RowBlock& block, size_t col, api::StridedData& out, api::DecodedType type,
+                       StringTable* strings=0);
+
+    /// Write the missing value in the specified type
+    void decodeMissing(char* out, api::DecodedType type, StringTable* strings=0);
+
+    /// For string columns, decode the code (int32_t) of each value in a table of the distinct strings,
+    /// adding the strings to the table as required. By default the block is decoded, and the
+    /// decoded strings looked up. Codecs holding a dictionary of strings map its indices instead.
+    virtual void decodeBlockCodes(const RowBlock& block, size_t col, api::StridedData& out, StringTable& strings);
+
+    /// Whether decode() writes 64-bit integers rather than doubles
+    virtual bool decodesIntegers() const { return false; }
+
+    /// Evaluate a condition on the values of this column for all of the rows in a block, setting
+    /// result[i] to whether the value in row i meets it. Where possible the encoded values are
+    /// compared directly. As for decodeBlock, rows that do not contain an encoded value repeat the
+    /// previous result, and result[0] must already be set if the first row is not encoded.
+    virtual void filterBlock(const RowBlock& block, size_t col, const RangeFilter::Condition& condition, char* result) = 0;
+
+    /// Interpret a value written by decode() as a double. Integer codecs may decode to int64_t.
+    virtual double decodedValue(const char* value) const { return *reinterpret_cast<const double*>(value); }
+
+    /// Whether a value written by decode() meets the condition
+    bool matchesDecoded(const char* value, const RangeFilter::Condition& condition) const;
+
+    /// Whether the missing value of the column meets the condition
+    bool matchesMissing(const RangeFilter::Condition& condition) const;
+
+    /// Whether a zero padded string, of the given maximum width, equals the condition's string
+    static bool matchesString(const char* value, size_t width, const RangeFilter::Condition& condition) {
+        size_t len = ::strnlen(value, width);
+        return len == condition.string.size() && ::memcmp(value, condition.string.data(), len) == 0;
+    }
+
     void setDataStream(GeneralDataStream& ds);
     virtual void setDataStream(DataStream<SameByteOrder>& ds);
     virtual void setDataStream(DataStream<OtherByteOrder>& ds);
@@ -60,6 +128,10 @@ public:
 
     virtual void gatherStats(const double& v);
 
+    /// Gather statistics over count contiguous values, each of dataSizeDoubles() doubles. Equivalent
+    /// to calling gatherStats() for each value in turn.
+    virtual void gatherStatsBlock(const double* values, size_t count);
+
 	void hasMissing(bool h) { hasMissing_ = h; }
 	int32_t hasMissing() const { return hasMissing_; }
 
@@ -77,6 +149,16 @@ public:
     virtual size_t numStrings() const { NOTIMP; }
     virtual void copyStrings(Codec& rhs) { NOTIMP; }
 
+    // And for integer dictionaries. The distinct values are only tracked, up to a limit, if the
+    // integer dictionary codecs are enabled.
+    virtual size_t numDistinctValues() const { NOTIMP; }
+    virtual std::vector<int64_t> distinctValues() const { NOTIMP; }
+    virtual void distinctValues(const std::vector<int64_t>& values) { NOTIMP; }
+
+    /// The minimum format version (minor number) able to describe data encoded with this codec.
+    /// Zero for codecs that are readable by all versions.
+    virtual int32_t formatVersionMinor() const { return 0; }
+
     virtual size_t dataSizeDoubles() const { return 1; }
     virtual void dataSizeDoubles(size_t count) {
         if (count != 1)
@@ -92,6 +174,17 @@ private: // methods
         return s;
     }
 
+protected: // methods
+
+    /// Helper for implementing gatherStatsBlock, for codecs that hold one value per double. Gives
+    /// the same result as calling Codec::gatherStats() for each value, in a form the compiler can
+    /// vectorise.
+    template <typename T>
+    void gatherStatsRange(const T* values, size_t count);
+
+    /// Used by the CodecFactory to copy codecs, including the state of the derived classes
+    Codec(const Codec&) = default;
+
 protected:
 
 	std::string name_;
@@ -104,11 +197,86 @@ protected:
     api::ColumnType type_;
 	
 private:
-	Codec(const Codec&);
 	Codec& operator=(const Codec&);
 };
 
 
+template <typename T>
+void Codec::gatherStatsRange(const T* values, size_t count) {
+
+    const double missing = missingValue_;
+    double minValue = min_;
+    double maxValue = max_;
+    bool hasMissing = hasMissing_;
+
+    // Until a non-missing value is found, min and max hold the missing value. Once found, they
+    // never do again, so the remaining values need only the comparisons.
+
+    size_t i = 0;
+    for (; i < count && (minValue == missing || maxValue == missing); ++i) {
+        double v = values[i];
+        if (v == missing) {
+            hasMissing = true;
+        } else {
+            if (v < minValue || minValue == missing) minValue = v;
+            if (v > maxValue || maxValue == missing) maxValue = v;
+        }
+    }
+
+    for (; i < count; ++i) {
+        double v = values[i];
+        bool isMissing = (v == missing);
+        hasMissing |= isMissing;
+        minValue = (v < minValue && !isMissing) ? v : minValue;
+        maxValue = (v > maxValue && !isMissing) ? v : maxValue;
+    }
+
+    min_ = minValue;
+    max_ = maxValue;
+    hasMissing_ = hasMissing;
+}
+
+
+/// Helper for implementing Codec::decodeBlock. The kernel is called as kernel(in, out) for each
+/// value present in the block, and is resolved at compile time so that it can be inlined.
+
+template <typename Kernel>
+inline void decodeRowBlock(const RowBlock& block, size_t col, api::StridedData& out, Kernel kernel) {
+
+    const size_t columnOffset = block.columnOffset[col];
+    const size_t dataSize = out.dataSize();
+
+    for (size_t i = 0; i < block.nrows; ++i) {
+        char* o = out[i];
+        if (block.startCol[i] <= int(col)) {
+            kernel(block.data + (block.rowOffset[i] + ptrdiff_t(columnOffset)), o);
+        } else if (i != 0) {
+            if (dataSize == sizeof(uint64_t)) {
+                *reinterpret_cast<uint64_t*>(o) = *reinterpret_cast<const uint64_t*>(out[i-1]);
+            } else {
+                ::memcpy(o, out[i-1], dataSize);
+            }
+        }
+    }
+}
+
+/// Helper for implementing Codec::filterBlock. The predicate is called as predicate(in) for each
+/// value present in the block.
+
+template <typename Predicate>
+inline void filterRowBlock(const RowBlock& block, size_t col, char* result, Predicate predicate) {
+
+    const size_t columnOffset = block.columnOffset[col];
+
+    for (size_t i = 0; i < block.nrows; ++i) {
+        if (block.startCol[i] <= int(col)) {
+            result[i] = predicate(block.data + (block.rowOffset[i] + ptrdiff_t(columnOffset)));
+        } else if (i != 0) {
+            result[i] = result[i-1];
+        }
+    }
+}
+
 //template <typename DATASTREAM>
 //Codec* Codec::findCodec(const std::string& name, bool differentByteOrder)
 //{
@@ -131,6 +299,21 @@ public: // methods
     }
     void clearDataStream() override { ds_ = 0; }
 
+    /// Fallback implementation, decoding the block and comparing the decoded values.
+    void filterBlock(const RowBlock& block, size_t col, const RangeFilter::Condition& condition, char* result) override {
+        const size_t width = dataSizeDoubles() * sizeof(double);
+        std::vector<double> buffer(block.nrows * dataSizeDoubles());
+        api::StridedData values(&buffer[0], block.nrows, width, width);
+        decodeBlock(block, col, values);
+        for (size_t i = 0; i < block.nrows; ++i) {
+            if (block.startCol[i] <= int(col)) {
+                result[i] = matchesDecoded(values[i], condition);
+            } else if (i != 0) {
+                result[i] = result[i-1];
+            }
+        }
+    }
+
 protected: // methods
 
     using Codec::load;
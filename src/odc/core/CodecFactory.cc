@@ -12,6 +12,8 @@
 
 #include "eckit/exception/Exceptions.h"
 
+#include "odc/core/Codec.h"
+
 
 namespace odc {
 namespace core {
@@ -44,6 +46,14 @@ void CodecFactory::deregister(const std::string& name, CodecBuilderBase& builder
     builders_.erase(it);
 }
 
+std::unique_ptr<Codec> CodecFactory::copy(const Codec& codec) const {
+    std::lock_guard<std::mutex> lock(m_);
+
+    auto it = builders_.find(codec.name());
+    if (it == builders_.end()) throw ODBDecodeError(std::string("Codec '") + codec.name() + "' not found", Here());
+    return it->second.get().copy(codec);
+}
+
 CodecBuilderBase::CodecBuilderBase(const std::string& name) :
     name_(name) {
     CodecFactory::instance().enregister(name, *this);
@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <typeinfo>
 #include <cstdint>
 
 #include "eckit/memory/NonCopyable.h"
@@ -57,6 +58,9 @@ public: // methods
     template <typename ByteOrder>
     std::unique_ptr<Codec> load(DataStream<ByteOrder>& ds, api::ColumnType type) const;
 
+    /// Create a copy of a codec, with the same parameters (including any string table)
+    std::unique_ptr<Codec> copy(const Codec& codec) const;
+
 private: // members
 
     mutable std::mutex m_;
@@ -79,6 +83,21 @@ public: // methods
     virtual std::unique_ptr<Codec> make(const SameByteOrder&, api::ColumnType) const = 0;
     virtual std::unique_ptr<Codec> make(const OtherByteOrder&, api::ColumnType) const = 0;
 
+    virtual std::unique_ptr<Codec> copy(const Codec&) const = 0;
+
+protected: // methods
+
+    /// If the codec is of exactly the type CODEC, copy it. n.b. Codec is incomplete here, so is
+    /// passed as a template parameter.
+    template <typename CODEC, typename BASE>
+    static bool copyAs(const BASE& codec, std::unique_ptr<Codec>& out) {
+        if (typeid(codec) != typeid(CODEC)) return false;
+        CODEC* copied = new CODEC(static_cast<const CODEC&>(codec));
+        static_cast<BASE*>(copied)->clearDataStream();
+        out.reset(copied);
+        return true;
+    }
+
 private: // members
 
     std::string name_;
@@ -106,6 +125,13 @@ private: // methods
     std::unique_ptr<Codec> make(const OtherByteOrder&, api::ColumnType type) const override {
         return std::unique_ptr<Codec>(new CODEC<OtherByteOrder>(type));
     }
+    std::unique_ptr<Codec> copy(const Codec& codec) const override {
+        std::unique_ptr<Codec> c;
+        if (!copyAs<CODEC<SameByteOrder>>(codec, c) && !copyAs<CODEC<OtherByteOrder>>(codec, c)) {
+            throw ODBDecodeError("Codec type does not match its builder", Here());
+        }
+        return c;
+    }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -137,6 +163,16 @@ private: // methods
             return std::unique_ptr<Codec>(new CODEC_T<OtherByteOrder, double>(type));
         }
     }
+    std::unique_ptr<Codec> copy(const Codec& codec) const override {
+        std::unique_ptr<Codec> c;
+        if (!copyAs<CODEC_T<SameByteOrder, double>>(codec, c) &&
+            !copyAs<CODEC_T<SameByteOrder, int64_t>>(codec, c) &&
+            !copyAs<CODEC_T<OtherByteOrder, double>>(codec, c) &&
+            !copyAs<CODEC_T<OtherByteOrder, int64_t>>(codec, c)) {
+            throw ODBDecodeError("Codec type does not match its builder", Here());
+        }
+        return c;
+    }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
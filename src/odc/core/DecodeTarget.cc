@@ -9,6 +9,7 @@
  */
 
 #include "odc/core/DecodeTarget.h"
+#include "odc/core/StringTable.h"
 
 
 namespace odc {
@@ -26,6 +27,19 @@ DecodeTarget::DecodeTarget(const std::vector<std::string>& columns,
     columns_(columns),
     columnFacades_(std::move(facades)) {}
 
+DecodeTarget::DecodeTarget(const std::vector<std::string>& columns,
+                           const std::vector<api::StridedData>& facades,
+                           const std::vector<api::DecodedType>& types) :
+    columns_(columns),
+    columnFacades_(facades),
+    types_(types) {
+    ASSERT(types_.empty() || types_.size() == columns_.size());
+
+    for (api::DecodedType type : types_) {
+        stringTables_.emplace_back(type == api::DECODED_STRING_CODE ? new StringTable : 0);
+    }
+}
+
 DecodeTarget::~DecodeTarget() {}
 
 const std::vector<std::string>&DecodeTarget::columns() const {
@@ -36,6 +50,14 @@ std::vector<api::StridedData>& DecodeTarget::dataFacades() {
     return columnFacades_;
 }
 
+const std::vector<api::DecodedType>& DecodeTarget::types() const {
+    return types_;
+}
+
+StringTable* DecodeTarget::stringTable(size_t column) const {
+    return stringTables_.empty() ? 0 : stringTables_[column].get();
+}
+
 DecodeTarget DecodeTarget::slice(size_t rowOffset, size_t nrows) {
 
     std::vector<api::StridedData> newFacades;
@@ -44,7 +66,10 @@ DecodeTarget DecodeTarget::slice(size_t rowOffset, size_t nrows) {
         newFacades.emplace_back(facade.slice(rowOffset, nrows));
     }
 
-    return DecodeTarget(columns_, std::move(newFacades));
+    DecodeTarget sliced(columns_, newFacades);
+    sliced.types_ = types_;
+    sliced.stringTables_ = stringTables_;
+    return sliced;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
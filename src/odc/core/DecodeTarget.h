@@ -14,14 +14,18 @@
 #ifndef odc_core_DecodeTarget_H
 #define odc_core_DecodeTarget_H
 
+#include <memory>
 #include <vector>
 
+#include "odc/api/ColumnType.h"
 #include "odc/api/StridedData.h"
 
 
 namespace odc {
 namespace core {
 
+class StringTable;
+
 //----------------------------------------------------------------------------------------------------------------------
 
 
@@ -33,17 +37,29 @@ public: // methods
                  const std::vector<api::StridedData>& facades);
     DecodeTarget(const std::vector<std::string> & columns,
                  std::vector<api::StridedData>&& facades);
+    DecodeTarget(const std::vector<std::string> & columns,
+                 const std::vector<api::StridedData>& facades,
+                 const std::vector<api::DecodedType>& types);
     ~DecodeTarget();
 
     const std::vector<std::string>& columns() const;
     std::vector<api::StridedData>& dataFacades();
 
+    /// The type in which the values of each column are written. Empty if all columns use the default.
+    const std::vector<api::DecodedType>& types() const;
+
+    /// The table of strings indexed by the codes of a column decoded as DECODED_STRING_CODE, or
+    /// null for other columns. Slices share the tables of the target that they are taken from.
+    StringTable* stringTable(size_t column) const;
+
     DecodeTarget slice(size_t rowOffset, size_t nrows);
 
 private: // members
 
     std::vector<std::string> columns_;
     std::vector<api::StridedData> columnFacades_;
+    std::vector<api::DecodedType> types_;
+    std::vector<std::shared_ptr<StringTable>> stringTables_;
 };
 
 
@@ -10,22 +10,79 @@
 
 #include "odc/core/Encoder.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+#include "eckit/utils/StringTools.h"
+
 #include "odc/LibOdc.h"
 #include "odc/codec/CodecOptimizer.h"
 #include "odc/core/Header.h"
+#include "odc/ODBAPISettings.h"
 
 using namespace eckit;
 
-
 namespace odc {
 namespace core {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void encodeFrame(eckit::DataHandle& out,
-                 const std::vector<api::ColumnInfo>& columns,
-                 const std::vector<api::ConstStridedData>& data,
-                 const std::map<std::string, std::string>& properties) {
+namespace {
+
+// Encoded rows are written out in chunks of (at least) this size
+const size_t encodeChunkSize = 1024 * 1024;
+
+// Find the first column, by position in the given order, that changes in each row. The columns are
+// visited last to first, so the earliest change is the one that remains.
+
+std::vector<uint16_t> startColumns(const std::vector<api::ConstStridedData>& data,
+                                   const std::vector<size_t>& order,
+                                   size_t nrows) {
+
+    std::vector<uint16_t> startCols(nrows, static_cast<uint16_t>(order.size()));
+    if (nrows != 0) startCols[0] = 0;
+
+    for (size_t pos = order.size(); pos-- > 0;) {
+        const api::ConstStridedData& column(data[order[pos]]);
+        for (size_t row = 1; row < nrows; ++row) {
+            if (column.isNewValue(row)) startCols[row] = static_cast<uint16_t>(pos);
+        }
+    }
+
+    return startCols;
+}
+
+size_t encodedDataSize(const std::vector<size_t>& columnSizes, const std::vector<uint16_t>& startCols) {
+
+    // The size of a row depends only on the first column encoded in it
+
+    size_t ncols = columnSizes.size();
+    std::vector<size_t> rowSizes(ncols + 1);
+    rowSizes[ncols] = sizeof(uint16_t); // all rows contain a marker
+    for (size_t col = ncols; col-- > 0;) {
+        rowSizes[col] = rowSizes[col + 1] + columnSizes[col];
+    }
+
+    size_t total = 0;
+    for (uint16_t startCol : startCols) {
+        ASSERT(startCol <= ncols);
+        total += rowSizes[startCol];
+    }
+    return total;
+}
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t encodeFrame(eckit::DataHandle& out,
+                   const std::vector<api::ColumnInfo>& columns,
+                   const std::vector<api::ConstStridedData>& data,
+                   const std::map<std::string, std::string>& properties,
+                   bool reorderColumns,
+                   const std::vector<std::string>& sortKeys) {
 
     ASSERT(columns.size() == data.size());
     ASSERT(columns.size() > 0);
@@ -52,9 +109,15 @@ void encodeFrame(eckit::DataHandle& out,
         }
     }
 
-    // Gather statistics over all the columns
+    // Sort the rows, so that repeated values are adjacent (and so are not re-encoded), and encode
+    // the sorted data
 
-    size_t maxRowSize = sizeof(uint16_t); // all rows contain a marker
+    if (!sortKeys.empty()) {
+        Buffer sorted(0);
+        return encodeFrame(out, columns, sortRows(md, data, sortKeys, sorted), properties, reorderColumns);
+    }
+
+    // Gather statistics over all the columns
 
     for (size_t col = 0; col < ncols; ++col) {
         ASSERT(data[col].nelem() == nrows);
@@ -63,62 +126,257 @@ void encodeFrame(eckit::DataHandle& out,
         for (const char* d : data[col]) {
             coder.gatherStats(*reinterpret_cast<const double*>(d));
         }
-        maxRowSize += data[col].dataSize();
     }
 
     // Optimise the codecs
 
-    codec::CodecOptimizer().setOptimalCodecs<SameByteOrder>(md);
+    codec::CodecOptimizer optimizer;
+    optimizer.setOptimalCodecs<SameByteOrder>(md, data);
+
+    std::vector<size_t> order(ncols);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint16_t> startCols = startColumns(data, order, nrows);
+
+    Properties props {properties};
+    props["encoder"] = std::string("odc version ") + LibOdc::instance().version();
+
+    size_t dataSize = encodedDataSize(md, startCols);
+    size_t saved = 0;
+
+    // Each row only encodes the columns from the first one that changes, so placing the columns that
+    // change least often first shrinks the data. Columns that change equally often keep their order.
+
+    if (reorderColumns) {
+
+        std::vector<size_t> changes(ncols, 0);
+        for (size_t col = 0; col < ncols; ++col) {
+            for (size_t row = 1; row < nrows; ++row) {
+                if (data[col].isNewValue(row)) ++changes[col];
+            }
+        }
+
+        std::vector<size_t> sorted(order);
+        std::stable_sort(sorted.begin(), sorted.end(), [&changes](size_t a, size_t b) { return changes[a] < changes[b]; });
+
+        std::vector<size_t> sortedSizes;
+        for (size_t col : sorted) sortedSizes.push_back(md[col]->coder().encodedSize());
+        std::vector<uint16_t> sortedStartCols = startColumns(data, sorted, nrows);
+        size_t sortedDataSize = encodedDataSize(sortedSizes, sortedStartCols);
+
+        if (sortedDataSize < dataSize) {
+
+            MetaDataBase sortedColumns;
+            std::vector<size_t> positions(ncols);
+            for (size_t pos = 0; pos < ncols; ++pos) {
+                sortedColumns.push_back(md[sorted[pos]]);
+                positions[sorted[pos]] = pos;
+            }
+            std::copy(sortedColumns.begin(), sortedColumns.end(), md.begin());
+
+            // Record where each of the caller's columns is found, so that readers can present the
+            // columns in the original order
+
+            std::ostringstream ss;
+            for (size_t col = 0; col < ncols; ++col) ss << (col == 0 ? "" : ",") << positions[col];
+            props[COLUMN_ORDER_PROPERTY] = ss.str();
+
+            saved = dataSize - sortedDataSize;
+            dataSize = sortedDataSize;
+            order.swap(sorted);
+            startCols.swap(sortedStartCols);
+        }
+
+        LOG_DEBUG_LIB(LibOdc) << "encodeFrame: reordering columns saves " << saved << " of "
+                              << (dataSize + saved) << " bytes" << std::endl;
+    }
 
-    // TODO: Sort the columns into the optimal order for encoding
+    std::vector<api::ConstStridedData> sortedData;
+    for (size_t col : order) sortedData.push_back(data[col]);
 
-//    std::sort(md.begin(), md.end(), [](Column* a, Column* b) { ASSERT(false); });
+    // Encode the header. The size of the encoded data is known in advance, so the rows can be
+    // encoded and written out a chunk at a time.
 
-    // TODO: Sort the data columns as well.
-//    ASSERT(false);
+    std::pair<Buffer, size_t> encodedHeader = Header::serializeHeader(dataSize, nrows, props, md);
+
+    // And output the data
+
+    ASSERT(out.write(encodedHeader.first, encodedHeader.second) == long(encodedHeader.second));
+    writeEncodedRows(out, md, sortedData, startCols);
+
+    return saved;
+}
+
+std::vector<size_t> encodedColumnPositions(const Properties& properties, size_t ncols) {
+
+    std::vector<size_t> positions;
+
+    auto it = properties.find(COLUMN_ORDER_PROPERTY);
+    if (it != properties.end()) {
+        std::vector<bool> found(ncols, false);
+        for (const std::string& pos : eckit::StringTools::split(",", it->second)) {
+            size_t col = std::stoul(pos);
+            ASSERT(col < ncols && !found[col]);
+            found[col] = true;
+            positions.push_back(col);
+        }
+        ASSERT(positions.size() == ncols);
+    }
+
+    return positions;
+}
+
+std::vector<size_t> restoreColumnOrder(MetaDataBase& columns, const Properties& properties) {
+
+    std::vector<size_t> positions(encodedColumnPositions(properties, columns.size()));
+
+    if (!positions.empty()) {
+        MetaDataBase stored(columns);
+        for (size_t col = 0; col < columns.size(); ++col) columns[col] = stored[positions[col]];
+    }
+
+    return positions;
+}
+
+std::vector<api::ConstStridedData> sortRows(const MetaData& columns,
+                                            const std::vector<api::ConstStridedData>& data,
+                                            const std::vector<std::string>& sortKeys,
+                                            eckit::Buffer& sorted) {
+
+    ASSERT(columns.size() == data.size());
+    ASSERT(!data.empty());
+    size_t nrows = data[0].nelem();
+
+    // How each of the key columns is compared. Integers are only stored as integers if they are not
+    // being treated as doubles.
+
+    enum class Comparison { Numeric, Integer, Bytes };
+    std::vector<std::pair<const api::ConstStridedData*, Comparison>> keys;
+
+    for (const std::string& name : sortKeys) {
+        size_t col = columns.columnIndex(name);
+        Comparison comparison = Comparison::Numeric;
+        switch (columns[col]->type()) {
+            case api::STRING:
+                comparison = Comparison::Bytes;
+                break;
+            case api::INTEGER:
+            case api::BITFIELD:
+                if (!ODBAPISettings::instance().integersAsDoubles()) comparison = Comparison::Integer;
+                break;
+            default:
+                break;
+        }
+        ASSERT(comparison == Comparison::Bytes || data[col].dataSize() == sizeof(double));
+        keys.emplace_back(&data[col], comparison);
+    }
+
+    auto less = [&keys](size_t a, size_t b) {
+        for (const auto& key : keys) {
+            const char* x = key.first->get(a);
+            const char* y = key.first->get(b);
+            if (key.second == Comparison::Bytes) {
+                int c = ::memcmp(x, y, key.first->dataSize());
+                if (c != 0) return c < 0;
+            } else if (key.second == Comparison::Integer) {
+                int64_t i, j;
+                ::memcpy(&i, x, sizeof(i));
+                ::memcpy(&j, y, sizeof(j));
+                if (i != j) return i < j;
+            } else {
+                double d, e;
+                ::memcpy(&d, x, sizeof(d));
+                ::memcpy(&e, y, sizeof(e));
+                if (std::isnan(d) || std::isnan(e)) {
+                    if (std::isnan(d) != std::isnan(e)) return std::isnan(e);
+                } else if (d != e) {
+                    return d < e;
+                }
+            }
+        }
+        return false;
+    };
+
+    std::vector<size_t> order(nrows);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), less);
+
+    // Copy the columns into the buffer in the sorted order
+
+    size_t rowSize = 0;
+    for (const auto& column : data) rowSize += column.dataSize();
+    sorted = Buffer(rowSize * nrows);
+
+    std::vector<api::ConstStridedData> result;
+    char* p = sorted;
+    for (const auto& column : data) {
+        size_t dataSize = column.dataSize();
+        result.emplace_back(p, nrows, dataSize, dataSize);
+        for (size_t row : order) {
+            ::memcpy(p, column.get(row), dataSize);
+            p += dataSize;
+        }
+    }
+
+    return result;
+}
+
+size_t encodedDataSize(const MetaData& columns, const std::vector<uint16_t>& startCols) {
+
+    std::vector<size_t> columnSizes;
+    for (const auto& col : columns) columnSizes.push_back(col->coder().encodedSize());
+    return encodedDataSize(columnSizes, startCols);
+}
+
+void writeEncodedRows(eckit::DataHandle& out,
+                      const MetaData& columns,
+                      const std::vector<api::ConstStridedData>& data,
+                      const std::vector<uint16_t>& startCols) {
+
+    size_t ncols = columns.size();
+    size_t nrows = startCols.size();
+    ASSERT(data.size() == ncols);
 
-    // Encode the data
-    const std::vector<api::ConstStridedData>& sortedData(data);
     std::vector<Codec*> coders;
-    for (const auto& col : md) coders.push_back(&col->coder());
+    size_t maxRowSize = sizeof(uint16_t); // all rows contain a marker
+    for (const auto& col : columns) {
+        coders.push_back(&col->coder());
+        maxRowSize += col->coder().encodedSize();
+    }
+
+    // There must always be space in the buffer for the largest possible row
+
+    Buffer chunk(std::max(encodeChunkSize, 4 * maxRowSize));
+    char* const begin = chunk;
+    char* const limit = begin + (chunk.size() - maxRowSize);
+    char* p = begin;
 
-    Buffer encodedBuffer(maxRowSize * nrows);
-    DataStream<SameByteOrder> encodedStream(encodedBuffer);
+    size_t written = 0;
 
     for (size_t row = 0; row < nrows; row++) {
-        size_t startCol = 0;
 
-        if (row != 0) {
-            for (; startCol < ncols; ++startCol) {
-                if (sortedData[startCol].isNewValue(row)) break;
-            }
+        if (p > limit) {
+            ASSERT(out.write(begin, p - begin) == p - begin);
+            written += p - begin;
+            p = begin;
         }
 
-        // Write the marker
-        uint8_t marker[2] {
-            static_cast<uint8_t>((startCol / 256) % 256),
-            static_cast<uint8_t>(startCol % 256)
-        };
-        encodedStream.writeBytes(marker, sizeof(marker)); // n.b. raw write
+        // Write the marker (n.b. raw write)
+        size_t startCol = startCols[row];
+        *p++ = static_cast<char>((startCol / 256) % 256);
+        *p++ = static_cast<char>(startCol % 256);
 
         // Write the updated values
-        char* p = encodedStream.get();
         for (size_t col = startCol; col < ncols; col++) {
-            p = coders[col]->encode(p, *reinterpret_cast<const double*>(sortedData[col].get(row)));
+            p = coders[col]->encode(p, *reinterpret_cast<const double*>(data[col].get(row)));
         }
-        encodedStream.set(p);
     }
 
-    // Encode the header
-
-    Properties props {properties};
-    props["encoder"] = std::string("odc version ") + LibOdc::instance().version();
-    std::pair<Buffer, size_t> encodedHeader = Header::serializeHeader(encodedStream.position(), nrows, props, md);
+    ASSERT(out.write(begin, p - begin) == p - begin);
+    written += p - begin;
 
-    // And output the data
+    // The header has already been written, with the predicted size
 
-    ASSERT(out.write(encodedHeader.first, encodedHeader.second) == long(encodedHeader.second));
-    ASSERT(out.write(encodedBuffer, encodedStream.position()) == encodedStream.position());
+    ASSERT(written == encodedDataSize(columns, startCols));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -14,22 +14,72 @@
 #ifndef odc_core_Encoder_H
 #define odc_core_Encoder_H
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "eckit/io/Buffer.h"
 #include "eckit/io/DataHandle.h"
 
 #include "odc/api/ColumnInfo.h"
 #include "odc/api/StridedData.h"
+#include "odc/core/MetaData.h"
 
 namespace odc {
 namespace core {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void encodeFrame(eckit::DataHandle& out,
-                 const std::vector<api::ColumnInfo>& columns,
-                 const std::vector<api::ConstStridedData>& data,
-                 const std::map<std::string, std::string>& properties);
+/// The frame property recording the order of the columns passed to encodeFrame, if the columns
+/// have been reordered. It lists the position in the frame of each of the original columns.
+
+constexpr const char* COLUMN_ORDER_PROPERTY = "columnOrder";
+
+/// The position in the frame of each of the columns passed to encodeFrame, as recorded in the
+/// frame properties. Empty if the columns were not reordered.
+
+std::vector<size_t> encodedColumnPositions(const Properties& properties, size_t ncols);
+
+/// Put the columns of a frame back into the order that they were passed to encodeFrame, if they
+/// were reordered. Returns the position in the frame of each column, as encodedColumnPositions().
+
+std::vector<size_t> restoreColumnOrder(MetaDataBase& columns, const Properties& properties);
+
+/// Encode the data as a single frame. If reorderColumns is set, the columns that change least often
+/// are placed first, if that reduces the size of the encoded data. If sort keys are given, the rows
+/// are stably sorted on those columns before encoding. Returns the number of bytes that reordering
+/// the columns saved.
+
+size_t encodeFrame(eckit::DataHandle& out,
+                   const std::vector<api::ColumnInfo>& columns,
+                   const std::vector<api::ConstStridedData>& data,
+                   const std::map<std::string, std::string>& properties,
+                   bool reorderColumns=false,
+                   const std::vector<std::string>& sortKeys={});
+
+/// Stably sort the rows on the values of the named key columns, copying the sorted data into the
+/// buffer. Strings are compared bytewise, and other values numerically (with NaNs last). Returns
+/// the layout of the sorted data, with the values of each column contiguous.
+
+std::vector<api::ConstStridedData> sortRows(const MetaData& columns,
+                                            const std::vector<api::ConstStridedData>& data,
+                                            const std::vector<std::string>& sortKeys,
+                                            eckit::Buffer& sorted);
+
+/// The size in bytes of the encoded data of a table, given the (optimised) columns and the first
+/// column that is encoded in each row. Each codec encodes values of a fixed size, so this can be
+/// known before the rows are encoded and the header is written.
+
+size_t encodedDataSize(const MetaData& columns, const std::vector<uint16_t>& startCols);
+
+/// Encode the rows of a table and write them to the DataHandle. The rows are encoded into a buffer
+/// that is written out and reused each time it fills, so the memory used does not depend on the
+/// number of rows.
+
+void writeEncodedRows(eckit::DataHandle& out,
+                      const MetaData& columns,
+                      const std::vector<api::ConstStridedData>& data,
+                      const std::vector<uint16_t>& startCols);
 
 //----------------------------------------------------------------------------------------------------------------------
 
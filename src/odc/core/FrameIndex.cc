@@ -0,0 +1,375 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/FrameIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <exception>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/utils/MD5.h"
+
+#include "odc/core/Column.h"
+#include "odc/core/DataStream.h"
+#include "odc/core/Exceptions.h"
+#include "odc/core/MetaData.h"
+#include "odc/core/TablesReader.h"
+#include "odc/LibOdc.h"
+
+using namespace eckit;
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// The sidecar is a cache of information held in the data file, so it is written in the native
+// byte order. An index written on a machine with the other byte order is ignored.
+//
+// Layout:
+//     char[8]  magic
+//     int32    byte order marker (1)
+//     int32    format version
+//     int64    size of the data file
+//     int64    modification time of the data file
+//     string   digest of the start of the first and last frames
+//     int32    number of schemas
+//       string   fingerprint
+//       int32    number of columns
+//         string   column name
+//         int32    column type
+//     int64    number of frames
+//       int64    offset
+//       int64    length
+//       int64    number of rows
+//       int32    schema
+//         double   min (for each column in the schema)
+//         double   max
+//         int32    has missing values
+
+const char indexMagic[8] = {'\xff', '\xff', 'O', 'D', 'C', 'I', 'D', 'X'};
+const int32_t indexByteOrder = 1;
+const int32_t indexVersion = 2;
+
+// The start of each frame header includes its checksum, so a digest of the start of the first
+// and last frames identifies the data, even if the file was rewritten without changing its size
+// or modification time (which has a resolution of one second).
+
+const size_t frameDigestSize = 64;
+
+size_t stringSize(const std::string& s) {
+    return sizeof(int32_t) + s.length();
+}
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+FrameIndex::FrameIndex() {}
+
+void FrameIndex::scan(DataHandle& dh) {
+
+    clear();
+
+    TablesReader reader(dh);
+    for (const auto& table : reader) {
+        addFrame(table.startPosition(), table.nextPosition() - table.startPosition(), table.rowCount(), table.columns());
+    }
+}
+
+void FrameIndex::scan(const PathName& dataFile) {
+
+    clear();
+
+    TablesReader reader(dataFile);
+    for (const auto& table : reader) {
+        addFrame(table.startPosition(), table.nextPosition() - table.startPosition(), table.rowCount(), table.columns());
+    }
+}
+
+bool FrameIndex::load(const PathName& dataFile) {
+
+    clear();
+
+    PathName path(indexPath(dataFile));
+    if (!path.exists()) return false;
+
+    try {
+
+        Length size = path.size();
+        Buffer buffer(size);
+
+        FileHandle fh(path);
+        fh.openForRead();
+        AutoClose closer(fh);
+        if (fh.read(buffer, size) != long(size)) return false;
+
+        DataStream<SameByteOrder> ds(static_cast<const Buffer&>(buffer));
+
+        char magic[sizeof(indexMagic)];
+        int32_t byteOrder;
+        int32_t version;
+        ds.readBytes(magic, sizeof(magic));
+        ds.read(byteOrder);
+        ds.read(version);
+        if (::memcmp(magic, indexMagic, sizeof(magic)) != 0 || byteOrder != indexByteOrder || version != indexVersion) {
+            LOG_DEBUG_LIB(LibOdc) << "FrameIndex: unsupported index file " << path << std::endl;
+            return false;
+        }
+
+        // The data file has changed since the index was written
+
+        int64_t indexedSize;
+        int64_t indexedModified;
+        std::string indexedDigest;
+        ds.read(indexedSize);
+        ds.read(indexedModified);
+        ds.read(indexedDigest);
+        if (Length(indexedSize) != dataFile.size() || indexedModified != int64_t(dataFile.lastModified())) {
+            LOG_DEBUG_LIB(LibOdc) << "FrameIndex: index " << path << " is out of date" << std::endl;
+            return false;
+        }
+
+        int32_t nschemas;
+        ds.read(nschemas);
+        for (int32_t i = 0; i < nschemas; ++i) {
+            Schema schema;
+            int32_t ncols;
+            ds.read(schema.fingerprint);
+            ds.read(ncols);
+            for (int32_t c = 0; c < ncols; ++c) {
+                std::string name;
+                int32_t type;
+                ds.read(name);
+                ds.read(type);
+                schema.names.push_back(name);
+                schema.types.push_back(api::ColumnType(type));
+            }
+            schemas_.emplace_back(std::move(schema));
+        }
+
+        int64_t nframes;
+        ds.read(nframes);
+        for (int64_t i = 0; i < nframes; ++i) {
+            int64_t offset;
+            int64_t length;
+            int64_t rows;
+            int32_t schema;
+            ds.read(offset);
+            ds.read(length);
+            ds.read(rows);
+            ds.read(schema);
+            if (schema < 0 || schema >= int32_t(schemas_.size())) throw ODBInvalid(path, "Invalid schema in frame index", Here());
+
+            Frame frame {offset, length, size_t(rows), size_t(schema), {}};
+            for (size_t c = 0; c < schemas_[schema].names.size(); ++c) {
+                ColumnRange range;
+                int32_t hasMissing;
+                ds.read(range.min);
+                ds.read(range.max);
+                ds.read(hasMissing);
+                range.hasMissing = (hasMissing != 0);
+                frame.ranges.push_back(range);
+            }
+            frames_.emplace_back(std::move(frame));
+        }
+
+        if (dataSize() != Length(indexedSize)) throw ODBInvalid(path, "Frames do not match the data size", Here());
+
+        if (framesDigest(dataFile) != indexedDigest) {
+            LOG_DEBUG_LIB(LibOdc) << "FrameIndex: index " << path << " does not match the data" << std::endl;
+            clear();
+            return false;
+        }
+
+    } catch (std::exception& e) {
+        Log::warning() << "Ignoring invalid frame index " << path << ": " << e.what() << std::endl;
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void FrameIndex::save(const PathName& dataFile) const {
+
+    // Determine the size of the encoded index
+
+    int64_t modified = dataFile.lastModified();
+    std::string digest = framesDigest(dataFile);
+
+    size_t size = sizeof(indexMagic) + 2 * sizeof(int32_t) + 2 * sizeof(int64_t) + stringSize(digest)
+                + sizeof(int32_t) + sizeof(int64_t);
+    for (const Schema& schema : schemas_) {
+        size += stringSize(schema.fingerprint) + sizeof(int32_t);
+        for (const std::string& name : schema.names) size += stringSize(name) + sizeof(int32_t);
+    }
+    for (const Frame& frame : frames_) {
+        size += 3 * sizeof(int64_t) + sizeof(int32_t);
+        size += frame.ranges.size() * (2 * sizeof(double) + sizeof(int32_t));
+    }
+
+    Buffer buffer(size);
+    DataStream<SameByteOrder> ds(buffer);
+
+    ds.writeBytes(indexMagic, sizeof(indexMagic));
+    ds.write(indexByteOrder);
+    ds.write(indexVersion);
+    ds.write(static_cast<int64_t>(dataSize()));
+    ds.write(modified);
+    ds.write(digest);
+
+    ds.write(static_cast<int32_t>(schemas_.size()));
+    for (const Schema& schema : schemas_) {
+        ds.write(schema.fingerprint);
+        ds.write(static_cast<int32_t>(schema.names.size()));
+        for (size_t c = 0; c < schema.names.size(); ++c) {
+            ds.write(schema.names[c]);
+            ds.write(static_cast<int32_t>(schema.types[c]));
+        }
+    }
+
+    ds.write(static_cast<int64_t>(frames_.size()));
+    for (const Frame& frame : frames_) {
+        ds.write(static_cast<int64_t>(frame.offset));
+        ds.write(static_cast<int64_t>(frame.length));
+        ds.write(static_cast<int64_t>(frame.rowCount));
+        ds.write(static_cast<int32_t>(frame.schema));
+        for (const ColumnRange& range : frame.ranges) {
+            ds.write(range.min);
+            ds.write(range.max);
+            ds.write(static_cast<int32_t>(range.hasMissing));
+        }
+    }
+
+    ASSERT(size_t(ds.position()) == size);
+
+    // Write via a temporary file, so that readers never see a partially written index
+
+    PathName path(indexPath(dataFile));
+    PathName tmp(path + ".tmp");
+
+    {
+        FileHandle fh(tmp, true);
+        fh.openForWrite(size);
+        AutoClose closer(fh);
+        ASSERT(fh.write(buffer, size) == long(size));
+    }
+
+    PathName::rename(tmp, path);
+}
+
+FrameIndex FrameIndex::forFile(const PathName& dataFile) {
+
+    FrameIndex index;
+    if (!index.load(dataFile)) index.scan(dataFile);
+    return index;
+}
+
+PathName FrameIndex::indexPath(const PathName& dataFile) {
+    return dataFile + ".odcidx";
+}
+
+std::string FrameIndex::fingerprint(const MetaData& columns) {
+
+    MD5 md5;
+
+    for (const Column* col : columns) {
+        int32_t type = col->type();
+        md5.add(col->name().c_str(), col->name().length() + 1);
+        md5.add(&type, sizeof(type));
+        for (const std::string& field : col->bitfieldDef().first) md5.add(field.c_str(), field.length() + 1);
+        for (int32_t size : col->bitfieldDef().second) md5.add(&size, sizeof(size));
+    }
+
+    return md5.digest();
+}
+
+std::string FrameIndex::framesDigest(const PathName& dataFile) const {
+
+    MD5 md5;
+
+    if (!frames_.empty()) {
+
+        FileHandle fh(dataFile);
+        fh.openForRead();
+        AutoClose closer(fh);
+
+        char buffer[frameDigestSize];
+        for (const Frame* frame : {&frames_.front(), &frames_.back()}) {
+            long length = std::min(size_t(frame->length), frameDigestSize);
+            fh.seek(frame->offset);
+            if (fh.read(buffer, length) != length) throw ODBIncomplete(dataFile, Here());
+            md5.add(buffer, length);
+        }
+    }
+
+    return md5.digest();
+}
+
+void FrameIndex::addFrame(const Offset& offset, const Length& length, size_t rowCount, const MetaData& columns) {
+
+    // Frames written consecutively normally share a schema, so check the most recent first
+
+    std::string digest = fingerprint(columns);
+
+    size_t schema = schemas_.size();
+    for (size_t i = schemas_.size(); i > 0; --i) {
+        if (schemas_[i-1].fingerprint == digest) {
+            schema = i - 1;
+            break;
+        }
+    }
+
+    if (schema == schemas_.size()) {
+        Schema s;
+        s.fingerprint = digest;
+        for (const Column* col : columns) {
+            s.names.push_back(col->name());
+            s.types.push_back(col->type());
+        }
+        schemas_.emplace_back(std::move(s));
+    }
+
+    Frame frame {offset, length, rowCount, schema, {}};
+    for (const Column* col : columns) {
+        frame.ranges.push_back(ColumnRange {col->min(), col->max(), col->hasMissing() != 0});
+    }
+    frames_.emplace_back(std::move(frame));
+}
+
+void FrameIndex::clear() {
+    frames_.clear();
+    schemas_.clear();
+}
+
+size_t FrameIndex::rowCount() const {
+    size_t n = 0;
+    for (const Frame& frame : frames_) n += frame.rowCount;
+    return n;
+}
+
+Length FrameIndex::dataSize() const {
+    if (frames_.empty()) return 0;
+    return Length(frames_.back().offset + frames_.back().length);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
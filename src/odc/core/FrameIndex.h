@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_FrameIndex_H
+#define odc_core_FrameIndex_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+#include "odc/api/ColumnType.h"
+
+namespace eckit { class DataHandle; }
+
+namespace odc {
+namespace core {
+
+class MetaData;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// An index of the frames (tables) in an ODB-2 file, which is stored in a sidecar file alongside
+/// the data (<file>.odcidx). It allows frames to be located, and rows counted, without reading
+/// every header in the file.
+///
+/// The sidecar records the size and modification time of the data file that it describes, and a
+/// digest of the start of its first and last frames. If the data file has since been modified (or
+/// the sidecar is unreadable) it is ignored, and the headers must be scanned.
+
+class FrameIndex {
+
+public: // types
+
+    struct Schema {
+        std::string fingerprint;
+        std::vector<std::string> names;
+        std::vector<api::ColumnType> types;
+    };
+
+    /// The range of values in a column of one frame, as recorded in the frame header
+    struct ColumnRange {
+        double min;
+        double max;
+        bool hasMissing;
+    };
+
+    struct Frame {
+        eckit::Offset offset;
+        eckit::Length length;
+        size_t rowCount;
+        size_t schema;
+        std::vector<ColumnRange> ranges;
+    };
+
+public: // methods
+
+    FrameIndex();
+
+    /// Build the index by reading the headers of all of the frames in the data
+    void scan(eckit::DataHandle& dh);
+    void scan(const eckit::PathName& dataFile);
+
+    /// Load the sidecar index of the data file. Returns false if there is no valid, up to date, index.
+    bool load(const eckit::PathName& dataFile);
+
+    /// Write the sidecar index of the data file
+    void save(const eckit::PathName& dataFile) const;
+
+    /// Load the sidecar index of the data file if it is valid, otherwise scan the data file
+    static FrameIndex forFile(const eckit::PathName& dataFile);
+
+    static eckit::PathName indexPath(const eckit::PathName& dataFile);
+
+    /// A digest of the column names, types and bitfield definitions. Frames with the same
+    /// fingerprint share a schema.
+    static std::string fingerprint(const MetaData& columns);
+
+    void addFrame(const eckit::Offset& offset, const eckit::Length& length, size_t rowCount, const MetaData& columns);
+    void clear();
+
+    size_t frameCount() const { return frames_.size(); }
+    const Frame& frame(size_t i) const { return frames_[i]; }
+    const Schema& schema(size_t i) const { return schemas_[i]; }
+
+    /// The total number of rows in all of the frames
+    size_t rowCount() const;
+
+    /// The size of the data described by the index
+    eckit::Length dataSize() const;
+
+private: // methods
+
+    /// A digest of the start of the first and last frames, which includes their header checksums
+    std::string framesDigest(const eckit::PathName& dataFile) const;
+
+private: // members
+
+    std::vector<Frame> frames_;
+    std::vector<Schema> schemas_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -10,14 +10,20 @@
 
 #include "odc/core/Header.h"
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/Buffer.h"
 #include "eckit/log/Log.h"
 #include "eckit/types/FixedString.h"
 #include "eckit/utils/MD5.h"
 
+#include "odc/core/Checksum.h"
 #include "odc/core/DataStream.h"
 #include "odc/core/Exceptions.h"
+#include "odc/core/HeaderCache.h"
 #include "odc/core/MetaData.h"
 #include "odc/LibOdc.h"
 #include "odc/ODBAPISettings.h"
@@ -52,7 +58,9 @@ bool Header::readMagic(DataHandle& dh) {
 template <typename ByteOrder>
 void Header::load(DataHandle& dh) {
 
-    // There must be at least 56 bytes available to read the basic header.
+    // There must be at least 48 bytes available to read the basic header. This is the size of
+    // the fixed part of a version 0.5 header, and the fixed part of a version 0.6 header is
+    // shorter, so the excess is the start of the variable header.
 
     constexpr size_t basic_header_size = 12 + 32 + 4;
     char basicBuffer[basic_header_size];
@@ -70,22 +78,46 @@ void Header::load(DataHandle& dh) {
     ASSERT("File format version not supported" && formatVersionMinor <= FORMAT_VERSION_NUMBER_MINOR && formatVersionMinor > 3);
 
     std::string headerDigest;
-    ds1.read(headerDigest);
+    int32_t checksumAlgorithm = 0;
+    uint64_t headerChecksum = 0;
+
+    if (formatVersionMinor > FORMAT_VERSION_NUMBER_MINOR_MD5) {
+        ds1.read(checksumAlgorithm);
+        ds1.read(headerChecksum);
+    } else {
+        ds1.read(headerDigest);
+    }
 
     int32_t headerSize;
     ds1.read(headerSize);
 
     // Read the remaining header data
 
-    eckit::Buffer buffer(headerSize);
-    if (dh.read(buffer, headerSize) != headerSize) throw ODBIncomplete(dh.title(), Here());
-
-    // Calculate the MD5
+    size_t carried = sizeof(basicBuffer) - size_t(ds1.position());
+    if (headerSize < 0 || size_t(headerSize) < carried) throw ODBInvalid(dh.title(), "Header size incorrect", Here());
 
-    MD5 md5;
-    md5.add(buffer.data(), buffer.size());
-    std::string actualHeaderDigest = md5.digest();
-    if (headerDigest != actualHeaderDigest) throw ODBInvalid(dh.title(), "Header digest incorrect", Here());
+    eckit::Buffer buffer(headerSize);
+    ::memcpy(buffer, basicBuffer + size_t(ds1.position()), carried);
+    long remaining = headerSize - long(carried);
+    if (dh.read(buffer + carried, remaining) != remaining) throw ODBIncomplete(dh.title(), Here());
+
+    // Verify the header checksum, unless the data is explicitly trusted
+
+    if (!ODBAPISettings::instance().trustedInput()) {
+        if (formatVersionMinor > FORMAT_VERSION_NUMBER_MINOR_MD5) {
+            if (checksumAlgorithm != HEADER_CHECKSUM_XXH64) {
+                throw ODBInvalid(dh.title(), "Unsupported header checksum algorithm", Here());
+            }
+            if (headerChecksum != xxHash64(buffer.data(), buffer.size())) {
+                throw ODBInvalid(dh.title(), "Header checksum incorrect", Here());
+            }
+        } else {
+            MD5 md5;
+            md5.add(buffer.data(), buffer.size());
+            std::string actualHeaderDigest = md5.digest();
+            if (headerDigest != actualHeaderDigest) throw ODBInvalid(dh.title(), "Header digest incorrect", Here());
+        }
+    }
 
     DataStream<ByteOrder> ds2(buffer, buffer.size());
 
@@ -109,6 +141,23 @@ void Header::load(DataHandle& dh) {
 
     LOG_DEBUG_LIB(LibOdc) << "Header::load: numberOfRows = " << numberOfRows << std::endl;
 
+    // The remainder of the header (flags, properties and column metadata) is commonly identical
+    // between consecutive tables, so the parsed metadata is cached. n.b. The header digest cannot be
+    // used as the key, as it also covers the data size and row count.
+
+    HeaderCache& cache(HeaderCache::instance());
+    std::string key;
+
+    if (cache.capacity() != 0) {
+        size_t remaining = buffer.size() - size_t(ds2.position());
+        key.reserve(remaining + 2);
+        key += (std::is_same<ByteOrder, SameByteOrder>::value ? 'S' : 'O');
+        key += (ODBAPISettings::instance().integersAsDoubles() ? 'D' : 'I');
+        key.append(static_cast<const char*>(buffer.data()) + size_t(ds2.position()), remaining);
+
+        if (cache.lookup(key, md_, props_)) return;
+    }
+
     // Flags -> ODAFlags
     Flags flags;
     ds2.read(flags);
@@ -116,6 +165,8 @@ void Header::load(DataHandle& dh) {
     ds2.read(props_);
 
     md_.load(ds2);
+
+    if (!key.empty()) cache.insert(key, md_, props_);
 }
 
 void Header::loadAfterMagic(DataHandle& dh) {
@@ -140,7 +191,20 @@ std::pair<eckit::Buffer, size_t> serializeHeaderInternal(size_t dataSize, size_t
     // Serialise the variable size part of the header first. Use the configured buffer size
     // but allow expansion if needed.
 
-    constexpr size_t initial_header_size = 9 + 8 + 4 + 32 + 4;
+    // Version 0.6 headers replace the (string) MD5 digest with an algorithm and a 64-bit checksum.
+    // Tables using codecs introduced since then record the version that they require, which
+    // implies the newer header layout.
+
+    int32_t formatVersionMinor = ODBAPISettings::instance().fastHeaderChecksum()
+                                    ? FORMAT_VERSION_NUMBER_MINOR_XXH64
+                                    : FORMAT_VERSION_NUMBER_MINOR_MD5;
+    for (const Column* col : columns) {
+        formatVersionMinor = std::max(formatVersionMinor, col->coder().formatVersionMinor());
+    }
+    ASSERT(formatVersionMinor <= FORMAT_VERSION_NUMBER_MINOR);
+
+    bool fastChecksum = (formatVersionMinor > FORMAT_VERSION_NUMBER_MINOR_MD5);
+    const size_t initial_header_size = 9 + 8 + (fastChecksum ? (4 + 8) : (4 + 32)) + 4;
 
     eckit::Buffer buffer(ODBAPISettings::instance().headerBufferSize());
     bool serialised = false;
@@ -171,11 +235,18 @@ std::pair<eckit::Buffer, size_t> serializeHeaderInternal(size_t dataSize, size_t
         }
     }
 
-    // Calculate MD5 of the variable portion of header data
+    // Calculate the checksum of the variable portion of header data
+
+    std::string headerDigest;
+    uint64_t headerChecksum = 0;
 
-    MD5 md5;
-    md5.add(variableHeaderStart, variableHeaderSize);
-    std::string headerDigest = md5.digest();
+    if (fastChecksum) {
+        headerChecksum = xxHash64(variableHeaderStart, variableHeaderSize);
+    } else {
+        MD5 md5;
+        md5.add(variableHeaderStart, variableHeaderSize);
+        headerDigest = md5.digest();
+    }
 
     // Now Serialise everything into the final buffer
 
@@ -190,9 +261,14 @@ std::pair<eckit::Buffer, size_t> serializeHeaderInternal(size_t dataSize, size_t
 
     ds.write(static_cast<int32_t>(BYTE_ORDER_INDICATOR));
     ds.write(static_cast<int32_t>(FORMAT_VERSION_NUMBER_MAJOR));
-    ds.write(static_cast<int32_t>(FORMAT_VERSION_NUMBER_MINOR));
-
-    ds.write(headerDigest); // MD5
+    if (fastChecksum) {
+        ds.write(formatVersionMinor);
+        ds.write(static_cast<int32_t>(HEADER_CHECKSUM_XXH64));
+        ds.write(headerChecksum);
+    } else {
+        ds.write(static_cast<int32_t>(FORMAT_VERSION_NUMBER_MINOR_MD5));
+        ds.write(headerDigest); // MD5
+    }
 
     ds.write(static_cast<int32_t>(variableHeaderSize)); // How much header data follows
 
@@ -41,7 +41,27 @@ const int32_t BYTE_ORDER_INDICATOR = 1;
 const uint16_t ODA_MAGIC_NUMBER = 0xffff;
 
 const int32_t FORMAT_VERSION_NUMBER_MAJOR = 0;
-const int32_t FORMAT_VERSION_NUMBER_MINOR = 5;
+const int32_t FORMAT_VERSION_NUMBER_MINOR = 9;
+
+/// Files are written with the MD5 header digest (format version 0.5) unless a faster header
+/// checksum is requested. Version 0.6 headers record the checksum algorithm explicitly.
+const int32_t FORMAT_VERSION_NUMBER_MINOR_MD5 = 5;
+const int32_t FORMAT_VERSION_NUMBER_MINOR_XXH64 = 6;
+
+/// Version 0.7 adds the 24-bit integer codecs. The header layout is that of version 0.6, and it is
+/// only written for tables that use the new codecs, so that other tables remain readable by older
+/// versions of the library.
+const int32_t FORMAT_VERSION_NUMBER_MINOR_INT24 = 7;
+
+/// Version 0.8 adds the xor_real codec, and likewise is only written for tables that use it.
+const int32_t FORMAT_VERSION_NUMBER_MINOR_XOR_REAL = 8;
+
+/// Version 0.9 adds the integer dictionary codecs (int8_dictionary, int16_dictionary).
+const int32_t FORMAT_VERSION_NUMBER_MINOR_INT_DICTIONARY = 9;
+
+enum HeaderChecksum : int32_t {
+    HEADER_CHECKSUM_XXH64 = 1
+};
 
 //----------------------------------------------------------------------------------------------------------------------
 
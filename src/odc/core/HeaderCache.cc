@@ -0,0 +1,143 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/HeaderCache.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include "odc/core/Codec.h"
+#include "odc/core/CodecFactory.h"
+#include "odc/core/Column.h"
+#include "odc/ODBAPISettings.h"
+
+using namespace eckit;
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HeaderCache& HeaderCache::instance() {
+    static HeaderCache theInstance(ODBAPISettings::instance().headerCacheSize());
+    return theInstance;
+}
+
+HeaderCache::HeaderCache(size_t capacity) :
+    capacity_(capacity),
+    hits_(0),
+    misses_(0) {}
+
+bool HeaderCache::lookup(const std::string& key, MetaData& md, Properties& props) {
+
+    std::shared_ptr<const Entry> entry;
+
+    {
+        std::lock_guard<std::mutex> lock(m_);
+
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++misses_;
+            return false;
+        }
+
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        entry = it->second.entry;
+        ++hits_;
+    }
+
+    // The prototype is immutable, so it can be copied without holding the lock
+
+    copyColumns(entry->md, md);
+    props = entry->props;
+    return true;
+}
+
+void HeaderCache::insert(const std::string& key, const MetaData& md, const Properties& props) {
+
+    if (capacity() == 0) return;
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    copyColumns(md, entry->md);
+    entry->props = props;
+
+    std::lock_guard<std::mutex> lock(m_);
+
+    // Another thread may have inserted the same header in the meantime
+
+    auto inserted = entries_.emplace(key, Slot());
+    if (!inserted.second) return;
+
+    recency_.push_front(&inserted.first->first);
+    inserted.first->second.entry = entry;
+    inserted.first->second.recency = recency_.begin();
+
+    trim();
+}
+
+void HeaderCache::capacity(size_t n) {
+    std::lock_guard<std::mutex> lock(m_);
+    capacity_ = n;
+    trim();
+}
+
+size_t HeaderCache::capacity() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return capacity_;
+}
+
+void HeaderCache::clear() {
+    std::lock_guard<std::mutex> lock(m_);
+    recency_.clear();
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+size_t HeaderCache::hits() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return hits_;
+}
+
+size_t HeaderCache::misses() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return misses_;
+}
+
+void HeaderCache::trim() {
+    while (entries_.size() > capacity_) {
+        auto it = entries_.find(*recency_.back());
+        ASSERT(it != entries_.end());
+        recency_.pop_back();
+        entries_.erase(it);
+    }
+}
+
+void HeaderCache::copyColumns(const MetaData& from, MetaData& to) {
+
+    // n.b. Column's copy constructor uses Codec::clone(), which only preserves the codec statistics.
+    //      The CodecFactory copies the complete state needed for decoding.
+
+    to.setSize(0);
+    to.setSize(from.size());
+
+    for (size_t i = 0; i < from.size(); ++i) {
+        const Column& src(*from[i]);
+        Column& dst(*to[i]);
+        dst.name(src.name());
+        dst.type(src.type());
+        dst.bitfieldDef(src.bitfieldDef());
+        dst.coder(CodecFactory::instance().copy(src.coder()));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
@@ -0,0 +1,104 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_HeaderCache_H
+#define odc_core_HeaderCache_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "eckit/memory/NonCopyable.h"
+
+#include "odc/core/Header.h"
+#include "odc/core/MetaData.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A least-recently-used cache of parsed table headers (column metadata, including the codecs,
+/// and properties). Long files commonly contain many tables whose headers differ only in their
+/// data size and row count, and these then share one parsed prototype that is copied, rather
+/// than rebuilding every codec (and string table) from the header data.
+///
+/// Entries are keyed on the serialised header data that describes the columns and properties.
+
+class HeaderCache : private eckit::NonCopyable {
+
+public: // methods
+
+    static HeaderCache& instance();
+
+    HeaderCache(size_t capacity);
+
+    /// If the key is cached, copy the cached columns and properties into md and props.
+    bool lookup(const std::string& key, MetaData& md, Properties& props);
+
+    void insert(const std::string& key, const MetaData& md, const Properties& props);
+
+    /// Change the maximum number of entries. Zero disables the cache.
+    void capacity(size_t n);
+    size_t capacity() const;
+
+    void clear();
+
+    size_t hits() const;
+    size_t misses() const;
+
+private: // types
+
+    struct Entry {
+        MetaData md;
+        Properties props;
+    };
+
+    // n.b. the recency list refers to the keys held in the map, which are not moved by rehashing
+
+    using RecencyList = std::list<const std::string*>;
+
+    struct Slot {
+        std::shared_ptr<const Entry> entry;
+        RecencyList::iterator recency;
+    };
+
+private: // methods
+
+    /// Copy the columns of the prototype, including the state of their codecs
+    static void copyColumns(const MetaData& from, MetaData& to);
+
+    void trim();
+
+private: // members
+
+    mutable std::mutex m_;
+
+    size_t capacity_;
+
+    std::unordered_map<std::string, Slot> entries_;
+
+    // Most recently used entries at the front
+    RecencyList recency_;
+
+    size_t hits_;
+    size_t misses_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
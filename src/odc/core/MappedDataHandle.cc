@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/MappedDataHandle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eckit/exception/Exceptions.h"
+
+using namespace eckit;
+
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MappedDataHandle::MappedDataHandle(const PathName& path) :
+    path_(path),
+    data_(0),
+    size_(0) {}
+
+MappedDataHandle::~MappedDataHandle() {
+    close();
+}
+
+void MappedDataHandle::print(std::ostream& s) const {
+    s << "MappedDataHandle(" << path_ << ")";
+}
+
+Length MappedDataHandle::openForRead() {
+
+    close();
+
+    int fd = ::open(path_.localPath(), O_RDONLY);
+    if (fd < 0) throw CantOpenFile(path_);
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        ::close(fd);
+        throw FailedSystemCall(std::string("fstat ") + path_.asString());
+    }
+
+    size_ = st.st_size;
+
+    // An empty file cannot be mapped, and has no data to map
+
+    if (size_ != 0) {
+        void* addr = ::mmap(0, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw FailedSystemCall(std::string("mmap ") + path_.asString());
+        }
+        data_ = static_cast<const char*>(addr);
+    }
+
+    // The mapping remains valid once the file descriptor is closed
+
+    ::close(fd);
+    position_ = 0;
+    return size_;
+}
+
+void MappedDataHandle::close() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = 0;
+    }
+    size_ = 0;
+}
+
+Length MappedDataHandle::estimate() {
+    return size_;
+}
+
+std::string MappedDataHandle::title() const {
+    return path_;
+}
+
+long MappedDataHandle::readAt(void* buffer, long length, const Offset& position) {
+
+    ASSERT(length >= 0);
+    size_t pos = std::min(size_t(position), size_);
+    size_t n = std::min(size_t(length), size_ - pos);
+    if (n != 0) ::memcpy(buffer, data_ + pos, n);
+    return n;
+}
+
+const char* MappedDataHandle::data() const {
+    return data_;
+}
+
+size_t MappedDataHandle::size() const {
+    return size_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
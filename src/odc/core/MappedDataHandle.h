@@ -0,0 +1,62 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_MappedDataHandle_H
+#define odc_core_MappedDataHandle_H
+
+#include "eckit/filesystem/PathName.h"
+
+#include "odc/core/PositionalDataHandle.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A read-only DataHandle over a memory-mapped file. Tables read through this handle decode
+/// directly from the mapped region, rather than copying the encoded data into a buffer.
+
+class MappedDataHandle : public PositionalDataHandle {
+
+public: // methods
+
+    MappedDataHandle(const eckit::PathName& path);
+    ~MappedDataHandle() override;
+
+    void print(std::ostream& s) const override;
+
+    eckit::Length openForRead() override;
+    void close() override;
+
+    eckit::Length estimate() override;
+    std::string title() const override;
+
+    long readAt(void* buffer, long length, const eckit::Offset& position) override;
+
+    /// The mapped region. Only valid whilst the handle is open.
+    const char* data() const;
+    size_t size() const;
+
+private: // members
+
+    eckit::PathName path_;
+
+    const char* data_;
+    size_t size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
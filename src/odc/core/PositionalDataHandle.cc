@@ -0,0 +1,50 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/PositionalDataHandle.h"
+
+#include "eckit/exception/Exceptions.h"
+
+using namespace eckit;
+
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PositionalDataHandle::PositionalDataHandle() :
+    position_(0) {}
+
+PositionalDataHandle::~PositionalDataHandle() {}
+
+long PositionalDataHandle::read(void* buffer, long length) {
+    long delta = readAt(buffer, length, position_);
+    position_ += delta;
+    return delta;
+}
+
+Offset PositionalDataHandle::position() {
+    return position_;
+}
+
+Offset PositionalDataHandle::seek(const Offset& position) {
+    position_ = position;
+    return position_;
+}
+
+bool PositionalDataHandle::canSeek() const {
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
@@ -0,0 +1,54 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_PositionalDataHandle_H
+#define odc_core_PositionalDataHandle_H
+
+#include "eckit/io/DataHandle.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A read-only DataHandle that can read from an arbitrary position without modifying any shared
+/// state. ThreadSharedDataHandle uses readAt() to read concurrently from multiple threads without
+/// taking a lock.
+
+class PositionalDataHandle : public eckit::DataHandle {
+
+public: // methods
+
+    PositionalDataHandle();
+    ~PositionalDataHandle() override;
+
+    long read(void* buffer, long length) override;
+
+    eckit::Offset position() override;
+    eckit::Offset seek(const eckit::Offset& position) override;
+    bool canSeek() const override;
+
+    /// Read from the specified position, without changing the position of the handle. May be
+    /// called concurrently from multiple threads.
+    virtual long readAt(void* buffer, long length, const eckit::Offset& position) = 0;
+
+protected: // members
+
+    eckit::Offset position_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/PositionalFileHandle.h"
+
+#include <cerrno>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FileHandle.h"
+
+using namespace eckit;
+
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PositionalFileHandle::PositionalFileHandle(const PathName& path) :
+    path_(path),
+    fd_(-1),
+    size_(0) {}
+
+PositionalFileHandle::~PositionalFileHandle() {
+    close();
+}
+
+DataHandle* PositionalFileHandle::open(const PathName& path) {
+
+    // Only local files can be read with pread. Other backends provide their own handles.
+
+    std::unique_ptr<DataHandle> dh(path.fileHandle());
+    if (dynamic_cast<FileHandle*>(dh.get())) return new PositionalFileHandle(path);
+    return dh.release();
+}
+
+void PositionalFileHandle::print(std::ostream& s) const {
+    s << "PositionalFileHandle(" << path_ << ")";
+}
+
+Length PositionalFileHandle::openForRead() {
+
+    close();
+
+    fd_ = ::open(path_.localPath(), O_RDONLY);
+    if (fd_ < 0) throw CantOpenFile(path_);
+
+    struct stat st;
+    if (::fstat(fd_, &st) < 0) {
+        close();
+        throw FailedSystemCall(std::string("fstat ") + path_.asString());
+    }
+
+    size_ = st.st_size;
+    position_ = 0;
+    return size_;
+}
+
+void PositionalFileHandle::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+Length PositionalFileHandle::estimate() {
+    return size_;
+}
+
+std::string PositionalFileHandle::title() const {
+    return path_;
+}
+
+long PositionalFileHandle::readAt(void* buffer, long length, const Offset& position) {
+
+    ASSERT(fd_ >= 0);
+
+    // pread may return less data than requested, so continue until complete or end of file
+
+    long total = 0;
+    while (total < length) {
+        ssize_t n = ::pread(fd_, static_cast<char*>(buffer) + total, length - total, off_t(position) + total);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw ReadError(path_);
+        }
+        if (n == 0) break;
+        total += n;
+    }
+    return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
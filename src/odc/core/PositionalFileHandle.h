@@ -0,0 +1,60 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_PositionalFileHandle_H
+#define odc_core_PositionalFileHandle_H
+
+#include "eckit/filesystem/PathName.h"
+
+#include "odc/core/PositionalDataHandle.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads a local file using pread(2)
+
+class PositionalFileHandle : public PositionalDataHandle {
+
+public: // methods
+
+    PositionalFileHandle(const eckit::PathName& path);
+    ~PositionalFileHandle() override;
+
+    /// A handle for reading the file at the path. This is a PositionalFileHandle if the path is
+    /// a local file, and otherwise the handle provided by the PathName.
+    static eckit::DataHandle* open(const eckit::PathName& path);
+
+    void print(std::ostream& s) const override;
+
+    eckit::Length openForRead() override;
+    void close() override;
+
+    eckit::Length estimate() override;
+    std::string title() const override;
+
+    long readAt(void* buffer, long length, const eckit::Offset& position) override;
+
+private: // members
+
+    eckit::PathName path_;
+    int fd_;
+    eckit::Length size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "odc/core/Column.h"
+#include "odc/core/MetaData.h"
+#include "odc/core/RangeFilter.h"
+
+using namespace eckit;
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void RangeFilter::addRange(const std::string& column, double minimum, double maximum) {
+
+    if (!(minimum <= maximum)) {
+        std::ostringstream ss;
+        ss << "Invalid range [" << minimum << ", " << maximum << "] for column " << column;
+        throw UserError(ss.str(), Here());
+    }
+
+    conditions_.emplace_back(Condition {column, minimum, maximum, false, ""});
+}
+
+void RangeFilter::addEquals(const std::string& column, const std::string& value) {
+    conditions_.emplace_back(Condition {column, 0, 0, true, value});
+}
+
+bool RangeFilter::mayMatch(const MetaData& columns) const {
+
+    for (const Condition& condition : conditions_) {
+
+        if (!columns.hasColumn(condition.column)) continue;
+        const Column& column(*columns.columnByName(condition.column));
+        if (condition.isString || column.type() == api::STRING) continue;
+
+        // The values lie in [min, max], and may include the missing value. Until a value that
+        // is not missing is seen, the codec holds the missing value for min and max.
+
+        double missing = column.missingValue();
+        double lo = column.min();
+        double hi = column.max();
+        bool hasValues = !(lo == missing && hi == missing);
+
+        // Reals may be stored in single precision, so the decoded values are rounded
+
+        if (column.type() == api::REAL) {
+            lo = std::min(lo, double(static_cast<float>(lo)));
+            hi = std::max(hi, double(static_cast<float>(hi)));
+        }
+
+        bool matchValues = hasValues && lo <= condition.max && hi >= condition.min;
+        bool matchMissing = column.hasMissing() && missing >= condition.min && missing <= condition.max;
+
+        if (!matchValues && !matchMissing) return false;
+    }
+
+    return true;
+}
+
+void RangeFilter::print(std::ostream& s) const {
+    s << "RangeFilter(";
+    bool first = true;
+    for (const Condition& condition : conditions_) {
+        if (!first) s << " and ";
+        if (condition.isString) {
+            s << condition.column << " = '" << condition.string << "'";
+        } else {
+            s << condition.column << " in [" << condition.min << ", " << condition.max << "]";
+        }
+        first = false;
+    }
+    s << ")";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
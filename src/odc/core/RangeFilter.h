@@ -0,0 +1,81 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_RangeFilter_H
+#define odc_core_RangeFilter_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace odc {
+namespace core {
+
+class MetaData;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A conjunction of simple conditions on the values of columns (e.g. andate between X and Y,
+/// obstype = 7), which is tested against the statistics held in a frame header (the minimum and
+/// maximum of each column, and whether it has missing values). Frames which the statistics prove
+/// cannot contain a matching row may be skipped without reading their data.
+///
+/// The test is conservative. Conditions on columns that are not present, or on string columns,
+/// never exclude a frame. The same conditions can be evaluated exactly, row by row, when a table
+/// is decoded (see Table::decode).
+
+class RangeFilter {
+
+public: // types
+
+    /// Values of the column must lie in [min, max]. Either bound may be infinite. For conditions
+    /// on string columns, the values must instead equal the string.
+    struct Condition {
+        std::string column;
+        double min;
+        double max;
+        bool isString;
+        std::string string;
+    };
+
+public: // methods
+
+    void addRange(const std::string& column, double minimum, double maximum);
+    void addEquals(const std::string& column, double value) { addRange(column, value, value); }
+    void addEquals(const std::string& column, const std::string& value);
+
+    bool empty() const { return conditions_.empty(); }
+    const std::vector<Condition>& conditions() const { return conditions_; }
+
+    /// Returns false if the header statistics prove that no row of the frame meets all of the conditions
+    bool mayMatch(const MetaData& columns) const;
+
+private: // methods
+
+    void print(std::ostream& s) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const RangeFilter& f) {
+        f.print(s);
+        return s;
+    }
+
+private: // members
+
+    std::vector<Condition> conditions_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
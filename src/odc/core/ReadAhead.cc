@@ -0,0 +1,164 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/ReadAhead.h"
+
+#include "eckit/exception/Exceptions.h"
+
+using namespace eckit;
+
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ReadAheadPool::ReadAheadPool(size_t capacity) :
+    capacity_(capacity),
+    used_(0),
+    events_(0),
+    hits_(0),
+    stalls_(0) {}
+
+bool ReadAheadPool::reserve(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (used_ != 0 && used_ + bytes > capacity_) return false;
+    used_ += bytes;
+    return true;
+}
+
+void ReadAheadPool::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(bytes <= used_);
+        used_ -= bytes;
+        ++events_;
+    }
+    cv_.notify_all();
+}
+
+void ReadAheadPool::notify() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++events_;
+    }
+    cv_.notify_all();
+}
+
+size_t ReadAheadPool::events() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+void ReadAheadPool::waitForEvent(size_t since) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, since] { return events_ != since; });
+}
+
+void ReadAheadPool::hit() {
+    ++hits_;
+}
+
+void ReadAheadPool::stall() {
+    ++stalls_;
+}
+
+size_t ReadAheadPool::hits() const {
+    return hits_;
+}
+
+size_t ReadAheadPool::stalls() const {
+    return stalls_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PrefetchedData::PrefetchedData(const std::shared_ptr<ReadAheadPool>& pool) :
+    pool_(pool),
+    state_(Pending),
+    reserved_(0) {}
+
+PrefetchedData::~PrefetchedData() {
+    if (state_ == Ready) pool_->release(reserved_);
+}
+
+bool PrefetchedData::pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == Pending;
+}
+
+bool PrefetchedData::beginLoad() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != Pending) return false;
+    state_ = Loading;
+    return true;
+}
+
+void PrefetchedData::completeLoad(std::unique_ptr<Buffer> data, size_t reserved) {
+
+    bool failed = !data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(state_ == Loading);
+        data_ = std::move(data);
+        reserved_ = reserved;
+        state_ = failed ? Done : Ready;
+    }
+
+    if (failed) pool_->release(reserved);
+    cv_.notify_all();
+}
+
+bool PrefetchedData::evict() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != Ready) return false;
+        data_.reset();
+        state_ = Done;
+    }
+    pool_->release(reserved_);
+    return true;
+}
+
+std::unique_ptr<Buffer> PrefetchedData::take() {
+
+    std::unique_ptr<Buffer> data;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        switch (state_) {
+        case Pending:
+            pool_->stall();
+            state_ = Done;
+            return data;
+        case Loading:
+            pool_->stall();
+            cv_.wait(lock, [this] { return state_ != Loading; });
+            break;
+        case Ready:
+            pool_->hit();
+            break;
+        case Done:
+            return data;
+        }
+
+        if (state_ != Ready) return data;
+        data = std::move(data_);
+        state_ = Done;
+    }
+
+    pool_->release(reserved_);
+    return data;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
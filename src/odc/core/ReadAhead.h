@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_ReadAhead_H
+#define odc_core_ReadAhead_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/memory/NonCopyable.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Bounds the memory used by the encoded data that a TablesReader has read ahead, and counts how
+/// often the data was (or was not) ready when it was needed.
+
+class ReadAheadPool : private eckit::NonCopyable {
+
+public: // methods
+
+    ReadAheadPool(size_t capacity);
+
+    /// Reserve space for prefetched data. Fails if this would exceed the capacity, unless the pool
+    /// is empty (so that any single table can be prefetched).
+    bool reserve(size_t bytes);
+    void release(size_t bytes);
+
+    /// Wake the read-ahead thread. Events are counted, so that waitForEvent(events()) does not miss
+    /// any that occur between checking the state of the reader and waiting.
+    void notify();
+    size_t events();
+    void waitForEvent(size_t since);
+
+    void hit();
+    void stall();
+
+    size_t hits() const;
+    size_t stalls() const;
+
+private: // members
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    size_t capacity_;
+    size_t used_;
+    size_t events_;
+
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> stalls_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The encoded data of one table, read ahead of its use. This is shared between copies of the Table,
+/// and handed over to the first one that is decoded.
+
+class PrefetchedData : private eckit::NonCopyable {
+
+public: // methods
+
+    PrefetchedData(const std::shared_ptr<ReadAheadPool>& pool);
+    ~PrefetchedData();
+
+    /// Has the data neither been loaded nor been requested?
+    bool pending();
+
+    /// Mark the data as being loaded. Returns false if it is no longer required.
+    bool beginLoad();
+
+    /// Supply the loaded data (or null on failure), which has been reserved in the pool.
+    void completeLoad(std::unique_ptr<eckit::Buffer> data, size_t reserved);
+
+    /// Discard loaded data that has not been used
+    bool evict();
+
+    /// Take ownership of the data for decoding, waiting if it is currently being loaded. Returns null
+    /// if the data has not been loaded, in which case the caller must read it itself.
+    std::unique_ptr<eckit::Buffer> take();
+
+private: // members
+
+    enum State { Pending, Loading, Ready, Done };
+
+    std::shared_ptr<ReadAheadPool> pool_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    State state_;
+    std::unique_ptr<eckit::Buffer> data_;
+    size_t reserved_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "odc/core/StringTable.h"
+
+using namespace eckit;
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+StringTable::StringTable() {}
+
+const std::vector<int32_t>& StringTable::merge(uint64_t dictionary, const std::vector<std::string>& strings) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = merged_.find(dictionary);
+    if (it != merged_.end()) {
+        ASSERT(it->second.size() == strings.size());
+        return it->second;
+    }
+
+    std::vector<int32_t>& codes(merged_[dictionary]);
+    codes.reserve(strings.size());
+    for (const std::string& s : strings) {
+        codes.push_back(code(s.data(), ::strnlen(s.data(), s.size())));
+    }
+    return codes;
+}
+
+void StringTable::codes(const char* cells, size_t n, size_t width, int32_t* out) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (size_t i = 0; i < n; ++i) {
+        const char* cell = cells + i * width;
+        out[i] = code(cell, ::strnlen(cell, width));
+    }
+}
+
+uint64_t StringTable::newDictionary() {
+    static std::atomic<uint64_t> next(0);
+    return next++;
+}
+
+int32_t StringTable::code(const char* s, size_t len) {
+
+    std::string str(s, len);
+    auto it = index_.find(str);
+    if (it != index_.end()) return it->second;
+
+    ASSERT(strings_.size() < size_t(std::numeric_limits<int32_t>::max()));
+    int32_t c = strings_.size();
+    index_.emplace(str, c);
+    strings_.emplace_back(std::move(str));
+    return c;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
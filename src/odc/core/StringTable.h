@@ -0,0 +1,73 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_StringTable_H
+#define odc_core_StringTable_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The distinct strings of a string column, decoded as codes (indices into the table) rather than
+/// as characters. Each table of an aggregated frame has its own dictionary of strings, so these
+/// are merged into the one table as the tables are decoded.
+///
+/// Strings are added under a lock, so that tables may be decoded concurrently. The codes are then
+/// assigned in the order that the strings are found, which is not fixed if multiple threads are
+/// used. As for the string codecs, a string ends at the first null character.
+
+class StringTable {
+
+public: // methods
+
+    StringTable();
+
+    /// The strings, indexed by code. Not to be used while strings are being added.
+    const std::vector<std::string>& strings() const { return strings_; }
+
+    /// The codes of the strings of a codec's dictionary, adding any that are not yet present. The
+    /// codes are remembered, so a dictionary is only merged once however many blocks use it.
+    /// Each dictionary is identified by a number obtained from newDictionary().
+    const std::vector<int32_t>& merge(uint64_t dictionary, const std::vector<std::string>& strings);
+
+    /// The codes of n zero padded strings, each occupying width bytes
+    void codes(const char* cells, size_t n, size_t width, int32_t* out);
+
+    /// A number that identifies a dictionary, which is never reused
+    static uint64_t newDictionary();
+
+private: // methods
+
+    int32_t code(const char* s, size_t len);
+
+private: // members
+
+    std::mutex mutex_;
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, int32_t> index_;
+    std::map<uint64_t, std::vector<int32_t>> merged_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
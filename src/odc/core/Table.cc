@@ -10,6 +10,7 @@
 
 #include "odc/core/Table.h"
 
+#include <algorithm>
 #include <functional>
 #include <bitset>
 
@@ -18,10 +19,15 @@
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/types/FixedString.h"
 
+#include "odc/LibOdc.h"
+#include "odc/ODBAPISettings.h"
+#include "odc/core/ThreadPool.h"
 #include "odc/core/DecodeTarget.h"
 #include "odc/core/Header.h"
 #include "odc/core/MetaData.h"
 #include "odc/core/Codec.h"
+#include "odc/core/RangeFilter.h"
+#include "odc/core/ReadAhead.h"
 
 using namespace eckit;
 
@@ -86,6 +92,17 @@ Buffer Table::readEncodedData(bool includeHeader) {
     }
 }
 
+const char* Table::encodedData(std::unique_ptr<Buffer>& buffer) {
+
+    const char* data = dh_.mappedRegion(dataPosition_, dataSize_);
+    if (!data) {
+        if (prefetched_) buffer = prefetched_->take();
+        if (!buffer) buffer.reset(new Buffer(readEncodedData()));
+        data = static_cast<const char*>(buffer->data());
+    }
+    return data;
+}
+
 const std::map<std::string, size_t>& Table::columnLookup() {
 
     if (columnLookup_.empty()) {
@@ -117,35 +134,47 @@ const std::map<std::string, size_t>&Table::simpleColumnLookup() {
 }
 
 
-void Table::decode(DecodeTarget& target) {
-
-    const MetaData& metadata(columns());
-    size_t nrows = metadata.rowsNumber();
-    size_t ncols = metadata.size();
+size_t Table::columnIndex(const std::string& name) {
 
     const std::map<std::string, size_t>& columnLookup(this->columnLookup());
     const std::map<std::string, size_t>& lookupSimple(simpleColumnLookup());
 
+    auto it = columnLookup.find(name);
+    if (it == columnLookup.end()) it = lookupSimple.find(name);
+    if (it == lookupSimple.end()) {
+        std::stringstream ss;
+        ss << "Column '" << name << "' not found in ODB";
+        throw ODBDecodeError(ss.str(), Here());
+    }
+
+    return it->second;
+}
+
+
+void Table::selectColumns(DecodeTarget& target,
+                          std::vector<char>& visitColumn,
+                          std::vector<api::StridedData*>& facades,
+                          std::vector<api::DecodedType>& types,
+                          std::vector<StringTable*>& strings) {
+
+    size_t nrows = rowCount();
+    size_t ncols = columnCount();
+
     // Loop over the specified output columns, and select the correct ones for decoding.
 
-    std::vector<char> visitColumn(ncols, false);
-    std::vector<api::StridedData*> facades(ncols, 0); // TODO: Do we want to do a copy, rather than point to StridedData*?
+    visitColumn.assign(ncols, false);
+    facades.assign(ncols, 0); // TODO: Do we want to do a copy, rather than point to StridedData*?
+    types.assign(ncols, api::DECODED_DEFAULT);
+    strings.assign(ncols, 0);
 
     ASSERT(target.columns().size() == target.dataFacades().size());
     ASSERT(target.columns().size() <= ncols);
+    ASSERT(target.types().empty() || target.types().size() == target.columns().size());
 
     for (size_t i = 0; i < target.columns().size(); i++) {
 
         const auto& nm(target.columns()[i]);
-        auto it = columnLookup.find(nm);
-        if (it == columnLookup.end()) it = lookupSimple.find(nm);
-        if (it == lookupSimple.end()) {
-            std::stringstream ss;
-            ss << "Column '" << nm << "' not found in ODB";
-            throw ODBDecodeError(ss.str(), Here());
-        }
-
-        size_t pos = it->second;
+        size_t pos = columnIndex(nm);
         if (visitColumn[pos]) {
             std::stringstream ss;
             ss << "Duplicated column '" << nm << "' in decode specification";
@@ -155,19 +184,88 @@ void Table::decode(DecodeTarget& target) {
         visitColumn[pos] = true;
         facades[pos] = &target.dataFacades()[i];
         ASSERT(target.dataFacades()[i].nelem() >= nrows);
+
+        if (!target.types().empty() && target.types()[i] != api::DECODED_DEFAULT) {
+            api::DecodedType type = target.types()[i];
+            bool isString = (metadata_[pos]->type() == api::STRING);
+            if (isString != (type == api::DECODED_STRING_CODE)) {
+                throw UserError(isString ? "String column '" + nm + "' can only be decoded as characters or codes"
+                                         : "Column '" + nm + "' is not a string column, so cannot be decoded as codes", Here());
+            }
+            if (target.dataFacades()[i].dataSize() != api::decodedTypeSize(type)) {
+                std::stringstream ss;
+                ss << "Data size " << target.dataFacades()[i].dataSize() << " for column '" << nm
+                   << "' does not match its decoded type";
+                throw UserError(ss.str(), Here());
+            }
+            types[pos] = type;
+            strings[pos] = target.stringTable(i);
+        }
     }
+}
 
-    // Read the data in in bulk for this table
 
-    const Buffer readBuffer(readEncodedData());
+void Table::decode(DecodeTarget& target, size_t nthreads) {
+
+    const MetaData& metadata(columns());
+    size_t nrows = metadata.rowsNumber();
+    size_t ncols = metadata.size();
+
+    std::vector<char> visitColumn;
+    std::vector<api::StridedData*> facades;
+    std::vector<api::DecodedType> types;
+    std::vector<StringTable*> strings;
+    selectColumns(target, visitColumn, facades, types, strings);
+
+    // Read the data in in bulk for this table (or use it in place if it is memory-mapped)
+
+    std::unique_ptr<Buffer> readBuffer;
+    const char* data = encodedData(readBuffer);
 
     // Special case for the empty table
 
     if (nrows == 0) return;
 
+    // Fill the initial row with missingValues. This means that if we have an (old, unsupported)
+    // ODB that doesn't start from column zero in the first column, then it gets the correct
+    // value. Columns that are encoded in the first row are skipped, so that string codes are
+    // only assigned to values that are present.
+
+    const unsigned char* marker = reinterpret_cast<const unsigned char*>(data);
+    long firstStartCol = (dataSize_ >= 2) ? (marker[0] * 256) + marker[1] : long(ncols);
+
+    for (int col = 0; col < std::min(firstStartCol, long(ncols)); col++) {
+        if (visitColumn[col]) {
+            metadata[col]->coder().decodeMissing((*facades[col])[0], types[col], strings[col]);
+        }
+    }
+
+    // Do the decoding
+
+    size_t blockSize = ODBAPISettings::instance().decodeBlockSize();
+    bool defaultTypes = std::all_of(types.begin(), types.end(), [](api::DecodedType t) { return t == api::DECODED_DEFAULT; });
+
+    if (blockSize == 0 && defaultTypes) {
+        decodeRowByRow(data, visitColumn, facades);
+    } else {
+        // n.b. Only the block decoders convert values to other types
+        if (blockSize == 0) blockSize = 1024;
+        decodeBlocks(data, blockSize, nthreads, visitColumn, types, strings, facades);
+    }
+}
+
+
+void Table::decodeRowByRow(const char* data,
+                           const std::vector<char>& visitColumn,
+                           std::vector<api::StridedData*>& facades) {
+
+    const MetaData& metadata(columns());
+    size_t nrows = metadata.rowsNumber();
+    size_t ncols = metadata.size();
+
     // Prepare decoders for reading
 
-    GeneralDataStream ds(otherByteOrder(), readBuffer);
+    GeneralDataStream ds(otherByteOrder(), data, dataSize_);
 
     std::vector<std::reference_wrapper<Codec>> decoders;
     decoders.reserve(ncols);
@@ -176,16 +274,6 @@ void Table::decode(DecodeTarget& target) {
         decoders.back().get().setDataStream(ds);
     }
 
-    // Fill the initial row with missingValues. This means that if we have an (old, unsupported)
-    // ODB that doesn't start from column zero in the first column, then it gets the correct
-    // value
-
-    for (int col = 0; col < long(ncols); col++) {
-        if (visitColumn[col]) {
-            *reinterpret_cast<double*>((*facades[col])[0]) = decoders[col].get().missingValue();
-        }
-    }
-
     // Do the decoding
 
     int lastStartCol = 0;
@@ -228,6 +316,365 @@ void Table::decode(DecodeTarget& target) {
             break;
         }
     }
+
+    for (auto& decoder : decoders) decoder.get().clearDataStream();
+}
+
+
+namespace {
+
+/// A contiguous range of rows, decoded independently of the rows that precede it.
+
+struct RowRange {
+
+    size_t firstRow;
+    size_t nrows;
+    size_t position;
+
+    /// The rows preceding this range that most recently updated each column, as (startCol, position)
+    /// pairs in increasing order of startCol. These are used to seed unchanged values.
+    std::vector<std::pair<int, size_t>> carried;
+};
+
+
+/// Read the row marker at the specified position, and check that the row lies within the data
+
+int readMarker(const char* data, size_t dataSize, size_t pos, size_t row, size_t nrows,
+               const std::vector<size_t>& columnOffset) {
+
+    size_t ncols = columnOffset.size() - 1;
+
+    if (pos + 2 > dataSize) {
+        std::stringstream ss;
+        ss << "Row " << row << " of " << nrows << " starts beyond the end of the encoded data";
+        throw ODBEndOfDataStream(ss.str(), Here());
+    }
+
+    const unsigned char* marker = reinterpret_cast<const unsigned char*>(&data[pos]);
+    int startCol = (marker[0] * 256) + marker[1]; // Endian independant
+
+    if (startCol > long(ncols)) {
+        std::stringstream ss;
+        ss << "Invalid start column " << startCol << " in row " << row << " of table with " << ncols << " columns";
+        throw ODBDecodeError(ss.str(), Here());
+    }
+
+    if (pos + 2 + columnOffset[ncols] - columnOffset[startCol] > dataSize) {
+        std::stringstream ss;
+        ss << "Row " << row << " of " << nrows << " extends beyond the end of the encoded data";
+        throw ODBEndOfDataStream(ss.str(), Here());
+    }
+
+    return startCol;
+}
+
+
+/// Decode a range of rows. The first row of the range must already contain the correct values
+/// for any columns that are not encoded in that row.
+
+void decodeRange(const char* data,
+                 size_t dataSize,
+                 size_t totalRows,
+                 const RowRange& range,
+                 size_t blockSize,
+                 const std::vector<std::reference_wrapper<Codec>>& decoders,
+                 const std::vector<size_t>& columnOffset,
+                 const std::vector<char>& visitColumn,
+                 const std::vector<api::DecodedType>& types,
+                 const std::vector<StringTable*>& strings,
+                 std::vector<api::StridedData*>& facades) {
+
+    size_t ncols = decoders.size();
+
+    std::vector<ptrdiff_t> rowOffset(blockSize);
+    std::vector<int> startCol(blockSize);
+
+    RowBlock block { data, 0, &rowOffset[0], &startCol[0], &columnOffset[0] };
+    size_t pos = range.position;
+    size_t endRow = range.firstRow + range.nrows;
+
+    for (size_t blockStart = range.firstRow; blockStart < endRow; blockStart += blockSize) {
+
+        block.nrows = std::min(blockSize, endRow - blockStart);
+
+        // Scan the row markers to locate the rows in this block
+
+        for (size_t i = 0; i < block.nrows; ++i) {
+            int col = readMarker(data, dataSize, pos, blockStart + i, totalRows, columnOffset);
+            pos += 2;
+            startCol[i] = col;
+            rowOffset[i] = ptrdiff_t(pos) - ptrdiff_t(columnOffset[col]);
+            pos += columnOffset[ncols] - columnOffset[col];
+        }
+
+        // And decode the block one column at a time
+
+        for (size_t col = 0; col < ncols; ++col) {
+            if (visitColumn[col]) {
+                api::StridedData out = facades[col]->slice(blockStart, block.nrows);
+                if (blockStart != range.firstRow && startCol[0] > long(col)) {
+                    ::memcpy(out[0], (*facades[col])[blockStart-1], out.dataSize());
+                }
+                decoders[col].get().decodeBlockAs(block, col, out, types[col], strings[col]);
+            }
+        }
+    }
+}
+
+}
+
+
+void Table::decodeBlocks(const char* data,
+                         size_t blockSize,
+                         size_t nthreads,
+                         const std::vector<char>& visitColumn,
+                         const std::vector<api::DecodedType>& types,
+                         const std::vector<StringTable*>& strings,
+                         std::vector<api::StridedData*>& facades) {
+
+    const MetaData& metadata(columns());
+    size_t nrows = metadata.rowsNumber();
+    size_t ncols = metadata.size();
+
+    // Each codec encodes values with a fixed width, so the location of any column within a
+    // row is fully determined by the marker at the start of the row.
+
+    std::vector<std::reference_wrapper<Codec>> decoders;
+    std::vector<size_t> columnOffset(ncols+1, 0);
+    decoders.reserve(ncols);
+    for (size_t col = 0; col < ncols; ++col) {
+        decoders.push_back(metadata[col]->coder());
+        columnOffset[col+1] = columnOffset[col] + decoders.back().get().encodedSize();
+    }
+
+    const size_t dataSize = dataSize_;
+
+    // Only split the table if each thread gets a worthwhile amount of work
+
+    size_t nranges = std::max(size_t(1), std::min(nthreads, nrows / blockSize));
+
+    if (nranges == 1) {
+        RowRange range { 0, nrows, 0, {} };
+        decodeRange(data, dataSize, nrows, range, blockSize, decoders, columnOffset, visitColumn, types, strings, facades);
+        return;
+    }
+
+    // Scan the row markers to find the byte offset at which each range starts, and which rows
+    // last updated each column before that point. The rows that last updated each column form
+    // a stack, ordered by start column.
+
+    std::vector<RowRange> ranges;
+    ranges.reserve(nranges);
+
+    std::vector<std::pair<int, size_t>> lastUpdated;
+    size_t pos = 0;
+
+    for (size_t row = 0; row < nrows; ++row) {
+
+        if (row * nranges >= ranges.size() * nrows) {
+            if (!ranges.empty()) ranges.back().nrows = row - ranges.back().firstRow;
+            ranges.push_back(RowRange { row, 0, pos, lastUpdated });
+        }
+
+        int startCol = readMarker(data, dataSize, pos, row, nrows, columnOffset);
+        while (!lastUpdated.empty() && lastUpdated.back().first >= startCol) lastUpdated.pop_back();
+        lastUpdated.emplace_back(startCol, pos + 2);
+
+        pos += 2 + columnOffset[ncols] - columnOffset[startCol];
+    }
+
+    ranges.back().nrows = nrows - ranges.back().firstRow;
+
+    // Seed the first row of each range with the values carried over from previous rows, by
+    // decoding them directly from the rows that last updated them.
+
+    for (RowRange& range : ranges) {
+
+        if (range.firstRow == 0) continue;
+
+        int firstStartCol = readMarker(data, dataSize, range.position, range.firstRow, nrows, columnOffset);
+
+        size_t idx = 0;
+        for (int col = 0; col < std::min(firstStartCol, int(ncols)); ++col) {
+            while (idx+1 < range.carried.size() && range.carried[idx+1].first <= col) ++idx;
+            if (!visitColumn[col]) continue;
+
+            api::StridedData out = facades[col]->slice(range.firstRow, 1);
+
+            if (range.carried.empty() || range.carried[idx].first > col) {
+                decoders[col].get().decodeMissing(out[0], types[col], strings[col]);
+            } else {
+                int seedStartCol = range.carried[idx].first;
+                ptrdiff_t seedOffset = ptrdiff_t(range.carried[idx].second) - ptrdiff_t(columnOffset[seedStartCol]);
+                RowBlock seed { data, 1, &seedOffset, &seedStartCol, &columnOffset[0] };
+                decoders[col].get().decodeBlockAs(seed, col, out, types[col], strings[col]);
+            }
+        }
+    }
+
+    // And decode the ranges in parallel. Any exceptions are rethrown in this thread.
+
+    std::vector<std::function<void()>> tasks;
+    for (const RowRange& range : ranges) {
+        tasks.emplace_back([&, range] {
+            decodeRange(data, dataSize, nrows, range, blockSize, decoders, columnOffset, visitColumn, types, strings, facades);
+        });
+    }
+
+    LibOdc::instance().threadPool().run(tasks);
+}
+
+
+size_t Table::decode(DecodeTarget& target, const RangeFilter& filter, const char* selected) {
+
+    if (filter.empty() && !selected) {
+        decode(target);
+        return rowCount();
+    }
+
+    const MetaData& metadata(columns());
+    size_t nrows = metadata.rowsNumber();
+    size_t ncols = metadata.size();
+
+    std::vector<char> visitColumn;
+    std::vector<api::StridedData*> facades;
+    std::vector<api::DecodedType> types;
+    std::vector<StringTable*> strings;
+    selectColumns(target, visitColumn, facades, types, strings);
+
+    // Find the columns that the conditions apply to
+
+    const std::vector<RangeFilter::Condition>& conditions(filter.conditions());
+    std::vector<size_t> conditionColumn;
+
+    for (const RangeFilter::Condition& condition : conditions) {
+        size_t col = columnIndex(condition.column);
+        if (condition.isString != (metadata[col]->type() == api::STRING)) {
+            std::stringstream ss;
+            ss << "Cannot compare column '" << condition.column << "' of type "
+               << Column::columnTypeName(metadata[col]->type()) << " with a "
+               << (condition.isString ? "string" : "number");
+            throw UserError(ss.str(), Here());
+        }
+        conditionColumn.push_back(col);
+    }
+
+    std::unique_ptr<Buffer> readBuffer;
+    const char* data = encodedData(readBuffer);
+
+    if (nrows == 0) return 0;
+
+    std::vector<std::reference_wrapper<Codec>> decoders;
+    std::vector<size_t> columnOffset(ncols+1, 0);
+    decoders.reserve(ncols);
+    for (size_t col = 0; col < ncols; ++col) {
+        decoders.push_back(metadata[col]->coder());
+        columnOffset[col+1] = columnOffset[col] + decoders.back().get().encodedSize();
+    }
+
+    // n.b. There is no row by row path here. Blocks are needed to evaluate the conditions.
+
+    const size_t dataSize = dataSize_;
+    const size_t blockSize = std::max(size_t(1), size_t(ODBAPISettings::instance().decodeBlockSize()));
+
+    std::vector<ptrdiff_t> rowOffset(blockSize);
+    std::vector<int> startCol(blockSize);
+    std::vector<char> matches(blockSize);
+    std::vector<char> conditionMatches(blockSize);
+
+    // The matching rows are gathered into a block of their own, in which every row encodes every
+    // column. The offset of each value is taken from the row that most recently encoded it.
+    // Columns that are not encoded in the first row of the table (e.g. in ODBs whose first row
+    // does not start from column zero) take the missing value until they are encoded.
+
+    std::vector<ptrdiff_t> gatheredOffset(blockSize);
+    std::vector<int> gatheredStartCol(blockSize, 0);
+
+    std::vector<char> lastMatch(conditions.size());
+    std::vector<ptrdiff_t> lastOffset(ncols, 0);
+    std::vector<char> lastEncoded(ncols, false);
+
+    for (size_t c = 0; c < conditions.size(); ++c) {
+        lastMatch[c] = decoders[conditionColumn[c]].get().matchesMissing(conditions[c]);
+    }
+
+    RowBlock block { data, 0, &rowOffset[0], &startCol[0], &columnOffset[0] };
+    RowBlock gathered { data, 0, &gatheredOffset[0], &gatheredStartCol[0], &columnOffset[0] };
+    size_t pos = 0;
+    size_t outRow = 0;
+
+    for (size_t blockStart = 0; blockStart < nrows; blockStart += blockSize) {
+
+        block.nrows = std::min(blockSize, nrows - blockStart);
+
+        for (size_t i = 0; i < block.nrows; ++i) {
+            int col = readMarker(data, dataSize, pos, blockStart + i, nrows, columnOffset);
+            pos += 2;
+            startCol[i] = col;
+            rowOffset[i] = ptrdiff_t(pos) - ptrdiff_t(columnOffset[col]);
+            pos += columnOffset[ncols] - columnOffset[col];
+        }
+
+        for (size_t i = 0; i < block.nrows; ++i) {
+            matches[i] = (!selected || selected[blockStart + i]) ? 1 : 0;
+        }
+
+        // Evaluate the conditions on the encoded values. Rows that do not encode the column take
+        // the result from the previous row, which may be in the previous block, so the conditions
+        // are evaluated even if no rows of the block are selected.
+
+        for (size_t c = 0; c < conditions.size(); ++c) {
+            conditionMatches[0] = lastMatch[c];
+            decoders[conditionColumn[c]].get().filterBlock(block, conditionColumn[c], conditions[c], &conditionMatches[0]);
+            lastMatch[c] = conditionMatches[block.nrows-1];
+            for (size_t i = 0; i < block.nrows; ++i) matches[i] &= conditionMatches[i];
+        }
+
+        // And decode the values of the matching rows
+
+        for (size_t col = 0; col < ncols; ++col) {
+            if (!visitColumn[col]) continue;
+
+            ptrdiff_t offset = lastOffset[col];
+            bool encoded = lastEncoded[col];
+            size_t nmissing = 0;
+            size_t nselected = 0;
+            for (size_t i = 0; i < block.nrows; ++i) {
+                if (startCol[i] <= int(col)) {
+                    offset = rowOffset[i];
+                    encoded = true;
+                }
+                if (matches[i]) {
+                    if (encoded) {
+                        gatheredOffset[nselected++] = offset;
+                    } else {
+                        ++nmissing;
+                    }
+                }
+            }
+            lastOffset[col] = offset;
+            lastEncoded[col] = encoded;
+            gathered.nrows = nselected;
+
+            // n.b. Once a column has been encoded it stays so, so any missing rows come first
+
+            if (nmissing != 0) {
+                api::StridedData out = facades[col]->slice(outRow, nmissing);
+                for (size_t i = 0; i < nmissing; ++i) {
+                    decoders[col].get().decodeMissing(out[i], types[col], strings[col]);
+                }
+            }
+
+            if (nselected != 0) {
+                api::StridedData out = facades[col]->slice(outRow + nmissing, nselected);
+                decoders[col].get().decodeBlockAs(gathered, col, out, types[col], strings[col]);
+            }
+        }
+
+        for (size_t i = 0; i < block.nrows; ++i) outRow += matches[i] ? 1 : 0;
+    }
+
+    return outRow;
 }
 
 
@@ -367,8 +814,8 @@ Span Table::decodeSpan(const std::vector<std::string>& columns) {
 
     // Read the data in in bulk for this table
 
-    const Buffer readBuffer(readEncodedData());
-    GeneralDataStream ds(otherByteOrder(), readBuffer);
+    std::unique_ptr<Buffer> readBuffer;
+    GeneralDataStream ds(otherByteOrder(), encodedData(readBuffer), dataSize_);
 
     std::vector<std::reference_wrapper<Codec>> decoders;
     decoders.reserve(ncols);
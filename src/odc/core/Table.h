@@ -29,6 +29,9 @@ namespace odc {
 namespace core {
 
 class DecodeTarget;
+class PrefetchedData;
+class RangeFilter;
+class StringTable;
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -57,7 +60,16 @@ public: // methods
 
     eckit::Buffer readEncodedData(bool includeHeader=false);
 
-    void decode(DecodeTarget& target);
+    /// Decode the table into the target. If nthreads > 1, large tables are split into ranges
+    /// of rows that are decoded concurrently.
+    void decode(DecodeTarget& target, size_t nthreads=1);
+
+    /// Decode only the rows of the table that meet all of the conditions of the filter, packed
+    /// into the first rows of the target, and return the number of rows decoded. The conditions
+    /// are evaluated on the encoded values, one block of rows at a time, and only the values of
+    /// the matching rows are then decoded. If a selection is supplied (one flag per row of the
+    /// table), rows that are not selected are skipped without being decoded or tested.
+    size_t decode(DecodeTarget& target, const RangeFilter& filter, const char* selected=0);
 
     Span span(const std::vector<std::string>& columns, bool onlyConstant=false);
     Span decodeSpan(const std::vector<std::string>& columns);
@@ -66,6 +78,35 @@ private: // methods
 
     Table(const ThreadSharedDataHandle& dh);
 
+    /// Access the encoded data (excluding the header). Memory-mapped data is used in place,
+    /// otherwise any prefetched data is taken, or it is read into the supplied buffer.
+    const char* encodedData(std::unique_ptr<eckit::Buffer>& buffer);
+
+    /// Find the table column corresponding to a (possibly unqualified) column name
+    size_t columnIndex(const std::string& name);
+
+    /// Map the columns of the target onto the columns of the table, and find the type in which the
+    /// values of each column are to be written (and the table of strings, for string codes)
+    void selectColumns(DecodeTarget& target,
+                       std::vector<char>& visitColumn,
+                       std::vector<api::StridedData*>& facades,
+                       std::vector<api::DecodedType>& types,
+                       std::vector<StringTable*>& strings);
+
+    /// Decode one row at a time, dispatching to the codecs for each value
+    void decodeRowByRow(const char* data,
+                        const std::vector<char>& visitColumn,
+                        std::vector<api::StridedData*>& facades);
+
+    /// Decode blocks of rows, one column at a time, using the codecs' block decoders
+    void decodeBlocks(const char* data,
+                      size_t blockSize,
+                      size_t nthreads,
+                      const std::vector<char>& visitColumn,
+                      const std::vector<api::DecodedType>& types,
+                      const std::vector<StringTable*>& strings,
+                      std::vector<api::StridedData*>& facades);
+
     /// Lookups used for decoding. Memoised for efficiency
     const std::map<std::string, size_t>& columnLookup();
     const std::map<std::string, size_t>& simpleColumnLookup();
@@ -84,6 +125,11 @@ private: // members
     MetaData metadata_;
     Properties properties_;
 
+    // Encoded data read ahead by the TablesReader (if enabled)
+
+    friend class TablesReader;
+    std::shared_ptr<PrefetchedData> prefetched_;
+
     // Lookups. Memoised for efficiency
 
     std::map<std::string, size_t> columnLookup_;
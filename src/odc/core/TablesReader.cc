@@ -10,8 +10,13 @@
 
 #include "odc/core/TablesReader.h"
 
+#include <future>
+
 #include "eckit/exception/Exceptions.h"
 
+#include "odc/ODBAPISettings.h"
+#include "odc/core/PositionalFileHandle.h"
+
 using namespace eckit;
 
 namespace odc {
@@ -80,15 +85,51 @@ const Table& ReadTablesIterator::operator*() const {
 
 
 TablesReader::TablesReader(DataHandle& dh) :
-    dh_(dh) {}
+    dh_(dh),
+    startPosition_(0),
+    readAheadFrames_(0),
+    consumed_(0),
+    evicted_(0),
+    stopping_(false),
+    eof_(false) {
+
+    readAhead(ODBAPISettings::instance().readAheadFrames(), ODBAPISettings::instance().readAheadMemory());
+}
 
 
 TablesReader::TablesReader(DataHandle* dh) :
-    dh_(dh) {}
+    dh_(dh),
+    startPosition_(0),
+    readAheadFrames_(0),
+    consumed_(0),
+    evicted_(0),
+    stopping_(false),
+    eof_(false) {
+
+    readAhead(ODBAPISettings::instance().readAheadFrames(), ODBAPISettings::instance().readAheadMemory());
+}
 
 
 TablesReader::TablesReader(const PathName& path) :
-    TablesReader(path.fileHandle()) {}
+    TablesReader(PositionalFileHandle::open(path)) {}
+
+
+TablesReader::TablesReader(const ThreadSharedDataHandle& dh, const Offset& start) :
+    dh_(dh),
+    startPosition_(start),
+    readAheadFrames_(0),
+    consumed_(0),
+    evicted_(0),
+    stopping_(false),
+    eof_(false) {
+
+    readAhead(ODBAPISettings::instance().readAheadFrames(), ODBAPISettings::instance().readAheadMemory());
+}
+
+
+TablesReader::~TablesReader() {
+    stopReadAhead();
+}
 
 
 TablesReader::iterator TablesReader::begin() {
@@ -99,37 +140,182 @@ TablesReader::iterator TablesReader::end() {
     return ReadTablesIterator(*this, -1);
 }
 
-bool TablesReader::ensureTable(long idx) {
+void TablesReader::readAhead(size_t nframes, size_t maxMemory) {
+
+    stopReadAhead();
+
+    std::lock_guard<std::mutex> lock(m_);
+
+    readAheadFrames_ = nframes;
+    readAheadPool_.reset();
+
+    // Memory-mapped data is decoded in place, so there is nothing to prefetch
+
+    if (nframes == 0 || dh_.mappedRegion(0, 0)) return;
+
+    readAheadPool_ = std::make_shared<ReadAheadPool>(maxMemory);
+    stopping_ = false;
+
+    // The settings are per-thread, and determine how headers are read (e.g. which codecs are
+    // constructed), so the background thread adopts those of this one before we continue.
+
+    const ODBAPISettings& settings(ODBAPISettings::instance());
+    std::promise<void> adopted;
+    std::future<void> ready(adopted.get_future());
+
+    readAheadThread_ = std::thread([this, &settings, &adopted] {
+        ODBAPISettings::instance().copyFrom(settings);
+        adopted.set_value();
+        readAheadLoop();
+    });
+
+    ready.wait();
+}
+
+void TablesReader::readAheadStatistics(size_t& hits, size_t& stalls) const {
+    hits = readAheadPool_ ? readAheadPool_->hits() : 0;
+    stalls = readAheadPool_ ? readAheadPool_->stalls() : 0;
+}
+
+void TablesReader::stopReadAhead() {
+
+    if (readAheadThread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stopping_ = true;
+        }
+        readAheadPool_->notify();
+        readAheadThread_.join();
+    }
+}
 
-    // We only read-ahead by a maximum of one table
+bool TablesReader::ensureTable(long idx) {
 
     std::lock_guard<std::mutex> lock(m_);
 
     ASSERT(idx >= 0);
     ASSERT(idx <= long(tables_.size()));
 
-    if (idx == long(tables_.size())) {
+    // Let the read-ahead thread know how far we have got
 
-        // n.b. Some DataHandles don't implement estimate() --> accept "0"
-        Offset nextPosition = (tables_.empty() ? Offset(0) : tables_.back()->nextPosition());
-        ASSERT(nextPosition <= dh_.estimate() || dh_.estimate() == Length(0));
+    if (readAheadPool_ && size_t(idx) > consumed_) {
+        consumed_ = idx;
+        readAheadPool_->notify();
+    }
 
-        // If the table has been truncated, this is an error, and we cannot read on.
-        Offset pos = dh_.seek(nextPosition);
-        if (pos < nextPosition) {
-            throw ODBIncomplete(dh_.title(), Here());
+    if (idx == long(tables_.size())) {
+        if (eof_) {
+            if (error_) std::rethrow_exception(error_);
+            return false;
         }
+        if (!readNextTable()) {
+            eof_ = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TablesReader::readNextTable() {
 
-        std::unique_ptr<Table> tbl(Table::readTable(dh_));
-        if (!tbl) return false;
-        tables_.emplace_back(std::move(tbl));
+    // n.b. Some DataHandles don't implement estimate() --> accept "0"
+    Offset nextPosition = (tables_.empty() ? startPosition_ : tables_.back()->nextPosition());
+    ASSERT(nextPosition <= dh_.estimate() || dh_.estimate() == Length(0));
+
+    // If the table has been truncated, this is an error, and we cannot read on.
+    Offset pos = dh_.seek(nextPosition);
+    if (pos < nextPosition) {
+        throw ODBIncomplete(dh_.title(), Here());
     }
 
+    std::unique_ptr<Table> tbl(Table::readTable(dh_));
+    if (!tbl) return false;
+    if (readAheadPool_) tbl->prefetched_ = std::make_shared<PrefetchedData>(readAheadPool_);
+    tables_.emplace_back(std::move(tbl));
     return true;
 }
 
+void TablesReader::readAheadLoop() {
+
+    std::unique_lock<std::mutex> lock(m_);
+
+    // Use our own view of the DataHandle, so that we do not disturb the position used for headers
+
+    ThreadSharedDataHandle dh(dh_);
+
+    while (!stopping_) {
+
+        size_t events = readAheadPool_->events();
+        size_t limit = consumed_ + readAheadFrames_ + 1;
+
+        // Read the headers up to the limit of the window. Errors are reported to the consumer
+        // when it reaches the failing table.
+
+        if (!eof_ && tables_.size() < limit) {
+            try {
+                if (!readNextTable()) eof_ = true;
+            } catch (...) {
+                error_ = std::current_exception();
+                eof_ = true;
+            }
+            continue;
+        }
+
+        // Prefetch the data of the next table in the window that has not already been read
+
+        Table* table = 0;
+        for (size_t i = consumed_; i < std::min(limit, tables_.size()) && !table; ++i) {
+            if (tables_[i]->prefetched_ && tables_[i]->prefetched_->pending()) table = tables_[i].get();
+        }
+
+        if (table) {
+
+            size_t size = table->encodedDataSize();
+            bool reserved = readAheadPool_->reserve(size);
+
+            // If the pool is full, discard data prefetched for tables that have been passed over
+
+            while (!reserved && evicted_ < consumed_) {
+                const auto& prefetched(tables_[evicted_++]->prefetched_);
+                if (prefetched && prefetched->evict()) reserved = readAheadPool_->reserve(size);
+            }
+
+            if (reserved) {
+                std::shared_ptr<PrefetchedData> prefetched(table->prefetched_);
+                if (prefetched->beginLoad()) {
+                    Offset position = table->nextPosition() - table->encodedDataSize();
+                    lock.unlock();
+
+                    std::unique_ptr<Buffer> data(new Buffer(size));
+                    try {
+                        dh.seek(position);
+                        if (dh.read(*data, size) != long(size)) data.reset();
+                    } catch (...) {
+                        data.reset();
+                    }
+
+                    prefetched->completeLoad(std::move(data), size);
+                    lock.lock();
+                } else {
+                    readAheadPool_->release(size);
+                }
+                continue;
+            }
+        }
+
+        // Nothing to do until the consumer advances, or prefetched data is used
+
+        lock.unlock();
+        readAheadPool_->waitForEvent(events);
+        lock.lock();
+    }
+}
+
 Table& TablesReader::getTable(long idx) {
 
+    std::lock_guard<std::mutex> lock(m_);
+
     ASSERT(idx >= 0);
     ASSERT(idx < long(tables_.size()));
 
@@ -15,8 +15,11 @@
 #define odc_core_ReadTablesIterator_H
 
 #include <cstdint>
+#include <exception>
 #include <memory>
+#include <thread>
 
+#include "odc/core/ReadAhead.h"
 #include "odc/core/Table.h"
 #include "odc/core/ThreadSharedDataHandle.h"
 
@@ -86,9 +89,26 @@ public: // methods
     TablesReader(eckit::DataHandle* dh); // n.b. takes ownership
     TablesReader(const eckit::PathName& path);
 
+    /// Read the tables following the specified position, which must be the start of a table.
+    /// The underlying DataHandle is shared with dh.
+    TablesReader(const ThreadSharedDataHandle& dh, const eckit::Offset& start);
+
+    ~TablesReader();
+
     iterator begin();
     iterator end();
 
+    /// Read ahead of the tables being iterated in a background thread. The headers of up to nframes
+    /// further tables are read, and their encoded data is prefetched, holding no more than maxMemory
+    /// bytes of prefetched data. If nframes is zero, read-ahead is disabled.
+    void readAhead(size_t nframes, size_t maxMemory);
+
+    /// The number of tables whose prefetched data was ready when decoded (hits), and that had to wait
+    /// for, or read, their data (stalls).
+    void readAheadStatistics(size_t& hits, size_t& stalls) const;
+
+    const ThreadSharedDataHandle& dataHandle() const { return dh_; }
+
 private: // members
 
     friend class ReadTablesIterator;
@@ -96,6 +116,12 @@ private: // members
     bool ensureTable(long idx);
     Table& getTable(long idx);
 
+    /// Read the header of the next table. Must be called with m_ held.
+    bool readNextTable();
+
+    void stopReadAhead();
+    void readAheadLoop();
+
 private: // members
 
     std::mutex m_;
@@ -104,6 +130,19 @@ private: // members
     std::vector<std::unique_ptr<Table>> tables_;
 
     ThreadSharedDataHandle dh_;
+    eckit::Offset startPosition_;
+
+    // Read-ahead state. The background thread reads headers up to readAheadFrames_ beyond the
+    // table most recently requested by an iterator (consumed_).
+
+    std::shared_ptr<ReadAheadPool> readAheadPool_;
+    std::thread readAheadThread_;
+    size_t readAheadFrames_;
+    size_t consumed_;
+    size_t evicted_;
+    bool stopping_;
+    bool eof_;
+    std::exception_ptr error_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
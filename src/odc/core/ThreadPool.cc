@@ -0,0 +1,215 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "odc/core/ThreadPool.h"
+
+#include <exception>
+
+#include "eckit/exception/Exceptions.h"
+
+using namespace eckit;
+
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Identify the worker (if any) that is running on the current thread, so that tasks submitted
+// from within tasks are queued locally.
+
+thread_local const ThreadPool* currentPool = 0;
+thread_local size_t currentWorker = 0;
+
+}
+
+/// Tracks completion of the tasks submitted by one call to run()
+
+struct ThreadPool::TaskGroup {
+
+    TaskGroup(size_t n) : remaining(n) {}
+
+    std::atomic<size_t> remaining;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(size_t nthreads) :
+    queued_(0),
+    nextQueue_(0),
+    stopping_(false) {
+    start(nthreads);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+void ThreadPool::resize(size_t nthreads) {
+    if (nthreads != workers_.size()) {
+        stop();
+        start(nthreads);
+    }
+}
+
+void ThreadPool::start(size_t nthreads) {
+
+    ASSERT(workers_.empty());
+    ASSERT(queued_ == 0);
+
+    stopping_ = false;
+
+    queues_.clear();
+    for (size_t i = 0; i < nthreads; ++i) {
+        queues_.emplace_back(new Queue);
+    }
+
+    for (size_t i = 0; i < nthreads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+void ThreadPool::stop() {
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void ThreadPool::run(std::vector<std::function<void()>>& tasks) {
+
+    // Without workers (or work to share) the tasks run directly on the calling thread
+
+    if (workers_.empty() || tasks.size() < 2) {
+        for (auto& task : tasks) task();
+        return;
+    }
+
+    TaskGroup group(tasks.size());
+
+    bool isWorker = (currentPool == this);
+    size_t home = isWorker ? currentWorker : (nextQueue_++ % queues_.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < tasks.size(); ++i) {
+
+            // Tasks submitted by a worker stay in its own queue (for other workers to steal). Tasks
+            // from outside the pool are distributed across the queues.
+
+            Queue& q(*queues_[isWorker ? home : ((home + i) % queues_.size())]);
+            std::lock_guard<std::mutex> qlock(q.mutex);
+            q.tasks.push_back(Task { &tasks[i], &group });
+            ++queued_;
+        }
+    }
+    cv_.notify_all();
+
+    // Help out with our own tasks, so that our wait is not extended by other callers' work. All
+    // of the tasks are already queued, so once none are left in the queues we only need to wait
+    // for the ones that are running to complete.
+
+    while (runOne(home, &group)) {}
+
+    // Waiting under the group mutex also ensures that the last task has released the group
+    // before it goes out of scope
+
+    std::unique_lock<std::mutex> lock(group.mutex);
+    group.cv.wait(lock, [&group] { return group.remaining == 0; });
+    if (group.error) std::rethrow_exception(group.error);
+}
+
+void ThreadPool::workerLoop(size_t index) {
+
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stopping_ || queued_ != 0; });
+        if (stopping_ && queued_ == 0) return;
+    }
+}
+
+bool ThreadPool::runOne(size_t preferred, const TaskGroup* group) {
+
+    Task task;
+    bool found = false;
+
+    // Take the most recently queued task from our own queue, otherwise steal the oldest task
+    // from another queue. If a group is specified, only its tasks are taken.
+
+    for (size_t i = 0; i < queues_.size() && !found; ++i) {
+        Queue& q(*queues_[(preferred + i) % queues_.size()]);
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (group) {
+            for (auto it = q.tasks.begin(); it != q.tasks.end(); ++it) {
+                if (it->group == group) {
+                    task = *it;
+                    q.tasks.erase(it);
+                    found = true;
+                    break;
+                }
+            }
+        } else if (!q.tasks.empty()) {
+            if (i == 0) {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+            } else {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+            }
+            found = true;
+        }
+        if (found) --queued_;
+    }
+
+    if (found) execute(task);
+    return found;
+}
+
+void ThreadPool::execute(Task& task) {
+
+    TaskGroup& group(*task.group);
+
+    try {
+        (*task.fn)();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        if (!group.error) group.error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(group.mutex);
+    if (--group.remaining == 0) group.cv.notify_all();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
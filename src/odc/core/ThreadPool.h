@@ -0,0 +1,97 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_core_ThreadPool_H
+#define odc_core_ThreadPool_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+
+namespace odc {
+namespace core {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A persistent pool of worker threads, each with its own task queue. Idle workers steal tasks
+/// from the queues of the other workers.
+///
+/// The library-wide instance is obtained from LibOdc::threadPool().
+
+class ThreadPool : private eckit::NonCopyable {
+
+public: // methods
+
+    ThreadPool(size_t nthreads);
+    ~ThreadPool();
+
+    size_t size() const;
+
+    /// Change the number of worker threads. The pool should not be in use.
+    void resize(size_t nthreads);
+
+    /// Execute the tasks, and return once they are all complete. The calling thread also executes
+    /// its own queued tasks while it waits, so tasks may themselves call run() without deadlocking.
+    /// The first exception thrown by any of the tasks is rethrown.
+    void run(std::vector<std::function<void()>>& tasks);
+
+private: // types
+
+    struct TaskGroup;
+
+    struct Task {
+        std::function<void()>* fn;
+        TaskGroup* group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+private: // methods
+
+    void start(size_t nthreads);
+    void stop();
+
+    void workerLoop(size_t index);
+
+    /// Run one queued task (of the group, if specified), preferring the specified queue. Returns
+    /// false if there is no work.
+    bool runOne(size_t preferred, const TaskGroup* group=0);
+    void execute(Task& task);
+
+private: // members
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> nextQueue_;
+    bool stopping_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace core
+} // namespace odc
+
+#endif
@@ -11,16 +11,30 @@
 
 #include "odc/core/ThreadSharedDataHandle.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "eckit/exception/Exceptions.h"
 
+#include "odc/core/MappedDataHandle.h"
+#include "odc/core/PositionalDataHandle.h"
+
 namespace odc {
 namespace core {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+    const long readBufferSize = 64 * 1024;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 
 ThreadSharedDataHandle::Internal::Internal(eckit::DataHandle* dh, bool owned) :
     dh_(dh),
+    positional_(dynamic_cast<PositionalDataHandle*>(dh)),
+    mapped_(dynamic_cast<MappedDataHandle*>(dh)),
     owned_(owned) {
 
     if (owned_) {
@@ -38,33 +52,50 @@ ThreadSharedDataHandle::Internal::~Internal() {
 
 ThreadSharedDataHandle::ThreadSharedDataHandle(eckit::DataHandle& dh) :
     internal_(std::make_shared<ThreadSharedDataHandle::Internal>(&dh, false)),
-    position_(internal_->dh_->position()) {}
+    position_(internal_->dh_->position()),
+    bufferPosition_(0),
+    bufferLength_(0) {}
 
 
 ThreadSharedDataHandle::ThreadSharedDataHandle(eckit::DataHandle* dh) :
     internal_(std::make_shared<ThreadSharedDataHandle::Internal>(dh, true)),
-    position_(internal_->dh_->position()) {}
+    position_(internal_->dh_->position()),
+    bufferPosition_(0),
+    bufferLength_(0) {}
 
 
 ThreadSharedDataHandle::~ThreadSharedDataHandle() {}
 
+// n.b. Copies do not share the read buffer, which belongs to the reader that filled it
+
 ThreadSharedDataHandle::ThreadSharedDataHandle(const ThreadSharedDataHandle& other):
     internal_(other.internal_),
-    position_(other.position_) {}
+    position_(other.position_),
+    bufferPosition_(0),
+    bufferLength_(0) {}
 
 ThreadSharedDataHandle& ThreadSharedDataHandle::operator=(const ThreadSharedDataHandle& rhs) {
     internal_ = rhs.internal_;
     position_ = rhs.position_;
+    bufferLength_ = 0;
     return *this;
 }
 
 ThreadSharedDataHandle::ThreadSharedDataHandle(ThreadSharedDataHandle&& other) :
     internal_(std::move(other.internal_)),
-    position_(other.position_) {}
+    position_(other.position_),
+    buffer_(std::move(other.buffer_)),
+    bufferPosition_(other.bufferPosition_),
+    bufferLength_(other.bufferLength_) {
+    other.bufferLength_ = 0;
+}
 
 ThreadSharedDataHandle& ThreadSharedDataHandle::operator=(ThreadSharedDataHandle&& rhs) {
     std::swap(internal_, rhs.internal_);
     position_ = rhs.position_;
+    std::swap(buffer_, rhs.buffer_);
+    std::swap(bufferPosition_, rhs.bufferPosition_);
+    std::swap(bufferLength_, rhs.bufferLength_);
     return *this;
 }
 
@@ -94,6 +125,16 @@ void ThreadSharedDataHandle::openForAppend(const eckit::Length&) { NOTIMP; }
 long ThreadSharedDataHandle::read(void* buffer, long length) {
 
     ASSERT(internal_);
+
+    // Positional reads do not touch the shared state of the handle, so need no lock
+
+    if (internal_->positional_) {
+        if (length < readBufferSize && !internal_->mapped_) return readBuffered(buffer, length);
+        long delta = internal_->positional_->readAt(buffer, length, position_);
+        position_ += delta;
+        return delta;
+    }
+
     std::lock_guard<std::mutex> lock(internal_->m_);
 
     if (position_ != internal_->dh_->position()) {
@@ -105,6 +146,27 @@ long ThreadSharedDataHandle::read(void* buffer, long length) {
     return delta;
 }
 
+long ThreadSharedDataHandle::readBuffered(void* buffer, long length) {
+
+    // A header is read with several small reads. Read a whole block at once, so that these are
+    // served from memory rather than each costing a system call.
+
+    long long start = position_;
+    long long bufferStart = bufferPosition_;
+
+    if (start < bufferStart || start + length > bufferStart + bufferLength_) {
+        buffer_.resize(readBufferSize);
+        bufferLength_ = internal_->positional_->readAt(&buffer_[0], readBufferSize, position_);
+        bufferPosition_ = position_;
+        bufferStart = start;
+    }
+
+    long delta = std::max(0LL, std::min<long long>(length, bufferStart + bufferLength_ - start));
+    if (delta > 0) ::memcpy(buffer, &buffer_[start - bufferStart], delta);
+    position_ += delta;
+    return delta;
+}
+
 long ThreadSharedDataHandle::write(const void*, long) { NOTIMP; }
 
 void ThreadSharedDataHandle::close() {
@@ -132,6 +194,17 @@ std::string ThreadSharedDataHandle::title() const {
     return internal_->dh_->name();
 }
 
+const char* ThreadSharedDataHandle::mappedRegion(const eckit::Offset& position, const eckit::Length& length) const {
+
+    ASSERT(internal_);
+    const MappedDataHandle* mapped = internal_->mapped_;
+
+    if (mapped && mapped->data() && size_t(position) + size_t(length) <= mapped->size()) {
+        return mapped->data() + size_t(position);
+    }
+    return 0;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }
@@ -16,6 +16,7 @@
 
 #include <mutex>
 #include <memory>
+#include <vector>
 
 #include "eckit/io/DataHandle.h"
 
@@ -24,8 +25,16 @@ namespace eckit { class DataHandle; }
 namespace odc {
 namespace core {
 
+class MappedDataHandle;
+class PositionalDataHandle;
+
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Shares one DataHandle between multiple readers (potentially in different threads), each of which
+/// maintains its own position. Reads are serialised with a lock, unless the underlying handle is a
+/// PositionalDataHandle, in which case they proceed concurrently. Small positional reads, such as
+/// those of table headers, are served from a block read ahead by each reader.
+
 class ThreadSharedDataHandle : public eckit::DataHandle {
 
 public: // methods
@@ -59,6 +68,14 @@ public: // methods
 
     std::string title() const override;
 
+    /// If the underlying handle is memory-mapped, returns a pointer to the specified region of
+    /// the mapped data. Otherwise (or if the region is out of range) returns null.
+    const char* mappedRegion(const eckit::Offset& position, const eckit::Length& length) const;
+
+private: // methods
+
+    long readBuffered(void* buffer, long length);
+
 private: // members
 
     struct Internal {
@@ -68,12 +85,18 @@ private: // members
 
         std::mutex m_;
         eckit::DataHandle* dh_;
+        PositionalDataHandle* positional_;
+        MappedDataHandle* mapped_;
         bool owned_;
     };
 
     std::shared_ptr<Internal> internal_;
 
     eckit::Offset position_;
+
+    std::vector<char> buffer_;
+    eckit::Offset bufferPosition_;
+    long bufferLength_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -75,8 +75,11 @@ extern template class TODATable<TextReader>;
 struct ODATable : public TODATable<Reader> {
     ODATable(eckit::sql::SQLDatabase& owner, const std::string& path, const std::string& name) :
         TODATable<Reader>(owner, path, name, Reader(path)) {}
-    ODATable(eckit::sql::SQLDatabase& owner, eckit::DataHandle& dh) :
-        TODATable<Reader>(owner, "<>", "input", Reader(dh)) {}
+    ODATable(eckit::sql::SQLDatabase& owner, eckit::DataHandle& dh, const core::RangeFilter& filter=core::RangeFilter()) :
+        TODATable<Reader>(owner, "<>", "input", Reader(dh)) {
+        // n.b. conditions pushed down from the WHERE clause. The first frame is always read.
+        oda_.rangeFilter(filter);
+    }
 };
 
 
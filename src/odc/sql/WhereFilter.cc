@@ -0,0 +1,230 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "eckit/utils/StringTools.h"
+
+#include "odc/sql/WhereFilter.h"
+
+using namespace eckit;
+
+namespace odc {
+namespace sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    enum TokenType { IDENTIFIER, NUMBER, LITERAL, SYMBOL };
+
+    struct Token {
+        TokenType type;
+        std::string text;  // Identifiers are lower cased
+        std::string original;
+        double value;
+    };
+
+    bool identifierStart(char c) { return ::isalpha(c) || c == '_' || c == '$' || c == '#'; }
+    bool identifierChar(char c) { return ::isalnum(c) || c == '_' || c == '$' || c == '#' || c == '@' || c == '.'; }
+
+    std::vector<Token> tokenise(const std::string& sql) {
+
+        std::vector<Token> tokens;
+        size_t i = 0;
+        const size_t n = sql.size();
+
+        while (i < n) {
+            char c = sql[i];
+
+            if (::isspace(c)) {
+                ++i;
+            } else if (c == '-' && i + 1 < n && sql[i+1] == '-') {
+                while (i < n && sql[i] != '\n') ++i;
+            } else if (c == '/' && i + 1 < n && sql[i+1] == '*') {
+                size_t end = sql.find("*/", i + 2);
+                i = (end == std::string::npos) ? n : end + 2;
+            } else if (c == '\'' || c == '"') {
+                size_t end = sql.find(c, i + 1);
+                if (end == std::string::npos) end = n - 1;
+                tokens.push_back(Token {LITERAL, sql.substr(i, end + 1 - i), "", 0});
+                i = end + 1;
+            } else if (identifierStart(c)) {
+                size_t start = i;
+                while (i < n && identifierChar(sql[i])) ++i;
+                std::string word = sql.substr(start, i - start);
+                tokens.push_back(Token {IDENTIFIER, StringTools::lower(word), word, 0});
+            } else if (::isdigit(c) || (c == '.' && i + 1 < n && ::isdigit(sql[i+1]))) {
+                const char* start = sql.c_str() + i;
+                char* end;
+                double value = ::strtod(start, &end);
+                size_t len = end - start;
+                tokens.push_back(Token {NUMBER, sql.substr(i, len), "", value});
+                i += len;
+            } else {
+                std::string symbol(1, c);
+                if (i + 1 < n) {
+                    std::string pair = sql.substr(i, 2);
+                    if (pair == "<=" || pair == ">=" || pair == "==" || pair == "<>" || pair == "!=") symbol = pair;
+                }
+                tokens.push_back(Token {SYMBOL, symbol, "", 0});
+                i += symbol.size();
+            }
+        }
+
+        return tokens;
+    }
+
+    bool isKeyword(const Token& t, const char* word) { return t.type == IDENTIFIER && t.text == word; }
+    bool isSymbol(const Token& t, const char* symbol) { return t.type == SYMBOL && t.text == symbol; }
+
+    /// Columns must be plain names, optionally qualified with a table (not bitfield members or variables)
+    bool isColumn(const Token& t) {
+        if (t.type != IDENTIFIER) return false;
+        for (const char* keyword : {"and", "or", "not", "between", "is", "null", "in", "like"}) {
+            if (t.text == keyword) return false;
+        }
+        return t.text.find_first_of(".$#") == std::string::npos;
+    }
+
+    /// Parse a (signed) number starting at token i, advancing i past it
+    bool parseNumber(const std::vector<Token>& tokens, size_t& i, double& value) {
+        double sign = 1;
+        if (i < tokens.size() && (isSymbol(tokens[i], "-") || isSymbol(tokens[i], "+"))) {
+            if (tokens[i].text == "-") sign = -1;
+            ++i;
+        }
+        if (i >= tokens.size() || tokens[i].type != NUMBER) return false;
+        value = sign * tokens[i++].value;
+        return true;
+    }
+
+    /// Add the condition expressed by a conjunct to the filter, if it is of a simple form
+    void addConjunct(const std::vector<Token>& tokens, core::RangeFilter& filter) {
+
+        const double inf = std::numeric_limits<double>::infinity();
+        double value;
+        double upper;
+        size_t i = 0;
+
+        // column between number and number
+
+        if (tokens.size() >= 5 && isColumn(tokens[0]) && isKeyword(tokens[1], "between")) {
+            i = 2;
+            if (parseNumber(tokens, i, value) && i < tokens.size() && isKeyword(tokens[i++], "and") &&
+                    parseNumber(tokens, i, upper) && i == tokens.size() && value <= upper) {
+                filter.addRange(tokens[0].original, value, upper);
+            }
+            return;
+        }
+
+        // column <op> number, or number <op> column (which is flipped)
+
+        std::string column;
+        std::string op;
+        if (tokens.size() >= 3 && isColumn(tokens[0]) && tokens[1].type == SYMBOL) {
+            column = tokens[0].original;
+            op = tokens[1].text;
+            i = 2;
+            if (!parseNumber(tokens, i, value) || i != tokens.size()) return;
+        } else if (parseNumber(tokens, i, value) && i + 2 == tokens.size() && tokens[i].type == SYMBOL && isColumn(tokens[i+1])) {
+            op = tokens[i].text;
+            column = tokens[i+1].original;
+            if (op[0] == '<') op[0] = '>';
+            else if (op[0] == '>') op[0] = '<';
+        } else {
+            return;
+        }
+
+        if (op == "=" || op == "==") filter.addEquals(column, value);
+        else if (op == "<" || op == "<=") filter.addRange(column, -inf, value);
+        else if (op == ">" || op == ">=") filter.addRange(column, value, inf);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+core::RangeFilter whereFilter(const std::string& sql) {
+
+    core::RangeFilter filter;
+    std::vector<Token> tokens = tokenise(sql);
+
+    // Only a single select statement, without subqueries, is considered
+
+    size_t selects = 0;
+    for (const Token& t : tokens) selects += isKeyword(t, "select") ? 1 : 0;
+    if (selects != 1) return filter;
+
+    // Find the where clause, and check that there is at most one table
+
+    size_t whereStart = tokens.size();
+    size_t whereEnd = tokens.size();
+    int depth = 0;
+    bool inFrom = false;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& t(tokens[i]);
+        if (isSymbol(t, "(")) ++depth;
+        if (isSymbol(t, ")")) --depth;
+        if (depth != 0) continue;
+
+        if (isKeyword(t, "from")) inFrom = true;
+        if (inFrom && (isSymbol(t, ",") || isKeyword(t, "join"))) return filter;
+
+        if (isKeyword(t, "where")) {
+            inFrom = false;
+            whereStart = i + 1;
+        } else if (isKeyword(t, "group") || isKeyword(t, "order") || isKeyword(t, "limit") || isSymbol(t, ";")) {
+            inFrom = false;
+            if (whereStart < tokens.size() && whereEnd == tokens.size()) whereEnd = i;
+        }
+    }
+
+    if (whereStart >= whereEnd) return filter;
+
+    // Split the clause into its top level conjuncts. The 'and' of a 'between' is not a separator.
+
+    std::vector<Token> conjunct;
+    bool betweenPending = false;
+    depth = 0;
+
+    for (size_t i = whereStart; i < whereEnd; ++i) {
+        const Token& t(tokens[i]);
+        if (isSymbol(t, "(")) ++depth;
+        if (isSymbol(t, ")")) --depth;
+
+        if (depth == 0) {
+            if (isKeyword(t, "or")) return core::RangeFilter();
+            if (isKeyword(t, "between")) betweenPending = true;
+            if (isKeyword(t, "and")) {
+                if (betweenPending) {
+                    betweenPending = false;
+                } else {
+                    addConjunct(conjunct, filter);
+                    conjunct.clear();
+                    continue;
+                }
+            }
+        }
+
+        conjunct.push_back(t);
+    }
+
+    addConjunct(conjunct, filter);
+    return filter;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace sql
+} // namespace odc
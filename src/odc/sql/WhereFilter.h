@@ -0,0 +1,42 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2026
+
+#ifndef odc_sql_WhereFilter_H
+#define odc_sql_WhereFilter_H
+
+#include <string>
+
+#include "odc/core/RangeFilter.h"
+
+namespace odc {
+namespace sql {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Extract the simple conditions from the WHERE clause of a single SQL select statement on a
+/// single table, so that they can be pushed down to the table reader and tested against the
+/// frame headers.
+///
+/// Only the top level conjuncts of the form `column <op> number`, `number <op> column` (where
+/// <op> is one of =, ==, <, <=, > or >=), and `column between number and number` are used. Any
+/// other conjuncts are left to the SQL engine. If the clause may not be a plain conjunction (it
+/// contains OR at the top level), or the statement has subqueries or joins, no conditions are
+/// returned.
+
+core::RangeFilter whereFilter(const std::string& sql);
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace sql
+} // namespace odc
+
+#endif
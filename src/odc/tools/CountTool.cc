@@ -12,8 +12,8 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
 
+#include "odc/core/FrameIndex.h"
 #include "odc/core/MetaData.h"
-#include "odc/core/TablesReader.h"
 #include "odc/LibOdc.h"
 #include "odc/Reader.h"
 #include "odc/tools/CountTool.h"
@@ -27,17 +27,8 @@ CountTool::CountTool (int argc, char *argv[]) : Tool(argc, argv) { }
 
 size_t CountTool::rowCount(const PathName &db)
 {
-    odc::core::TablesReader reader(db);
-    auto it = reader.begin();
-    auto end = reader.end();
-
-    size_t n = 0;
-
-    for (; it != end; ++it) {
-        n += it->rowCount();
-    }
-
-	return n;
+    // Uses the frame index if available, otherwise scans the headers
+    return odc::core::FrameIndex::forFile(db).rowCount();
 }
 
 void CountTool::run()
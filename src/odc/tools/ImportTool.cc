@@ -20,6 +20,7 @@
 #include "eckit/sql/SQLStatement.h"
 
 #include "odc/api/Odb.h"
+#include "odc/ODBAPISettings.h"
 #include "odc/sql/SQLOutputConfig.h"
 #include "odc/sql/TODATable.h"
 
@@ -69,6 +70,10 @@ void ImportTool::run()
         throw UserError(ss.str());
     }
 
+    // Overlap the parsing of the input with the encoding and writing of the output
+
+    ODBAPISettings::instance().asyncWriterFlush(true);
+
     PathName inFile (parameters(1)),
              outFile (parameters(2));
 
@@ -10,6 +10,7 @@
 
 #include "eckit/eckit.h"
 #include "eckit/exception/Exceptions.h"
+#include "odc/core/FrameIndex.h"
 #include "odc/core/MetaData.h"
 #include "odc/Reader.h"
 #include "odc/Select.h"
@@ -35,15 +36,40 @@ void IndexTool::help(std::ostream &o) {
 void IndexTool::usage(const std::string& name, std::ostream &o) {
     o << name
       << " <file.odb> [<file.odb.idx>] " << std::endl
+      << "       " << name << " -frames <file.odb> [<file.odb> ...]" << std::endl
       << std::endl
       << "\tSpecifically the index file is an ODB file with (INTEGER) columns: block_begin, block_length, seqno, n_rows"
       << std::endl
-      << "\tOne entry is made for each unique seqno - block pair within the source ODB file." << std::endl;
+      << "\tOne entry is made for each unique seqno - block pair within the source ODB file." << std::endl
+      << std::endl
+      << "\tWith -frames, a frame index (<file.odb>.odcidx) is written instead. This records the position, row count"
+      << std::endl
+      << "\tand column ranges of each frame, and is used automatically when reading and counting rows." << std::endl;
 }
 
 
 void IndexTool::run()
 {
+    if (optionIsSet("-frames"))
+    {
+        if (parameters().size() < 2)
+        {
+            Log::error() << "Usage: ";
+            usage(parameters(0), Log::error());
+            Log::error() << std::endl;
+            throw UserError("Expected at least 2 command line parameters");
+        }
+
+        for (size_t i (1); i < parameters().size(); ++i)
+        {
+            PathName dataFile (parameters(i));
+            core::FrameIndex index;
+            index.scan(dataFile);
+            index.save(dataFile);
+        }
+        return;
+    }
+
 	if (! (parameters().size() == 2 || parameters().size() == 3))
 	{
 		Log::error() << "Usage: ";
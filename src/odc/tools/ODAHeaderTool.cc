@@ -13,6 +13,7 @@
 #include "eckit/exception/Exceptions.h"
 
 #include "ODAHeaderTool.h"
+#include "odc/core/Encoder.h"
 #include "odc/core/TablesReader.h"
 
 using namespace eckit;
@@ -25,6 +26,13 @@ class MDPrinter {
 public:
     virtual void print(std::ostream&, const core::Table&) = 0;
     virtual void printSummary(std::ostream&) {}
+
+    /// The columns of the table, in the order that they were written
+    static core::MetaData columns(const core::Table& tbl) {
+        core::MetaData md(tbl.columns());
+        core::restoreColumnOrder(md, tbl.properties());
+        return md;
+    }
 };
 
 class VerbosePrinter : public MDPrinter {
@@ -37,7 +45,7 @@ public:
             << ", number of rows in block: " << tbl.rowCount()
             << ", byteOrder: " << ((tbl.byteOrder() == 1) ? "same" : "other")
             << std::endl
-            << tbl.columns();
+            << columns(tbl);
 	}
 private:
 	unsigned long headerCount_;
@@ -64,9 +72,10 @@ public:
 
     void print(std::ostream& o, const core::Table& tbl)
 	{
-        if (md_.empty() || md_.back() != tbl.columns())
+        core::MetaData md(columns(tbl));
+        if (md_.empty() || md_.back() != md)
         {
-            md_.push_back(tbl.columns());
+            md_.push_back(md);
             return;
         }
 	}
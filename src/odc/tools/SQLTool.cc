@@ -25,8 +25,10 @@
 #include "eckit/sql/SQLStatement.h"
 #include "eckit/types/Types.h"
 
+#include "odc/ODBAPISettings.h"
 #include "odc/sql/SQLOutputConfig.h"
 #include "odc/sql/TODATable.h"
+#include "odc/sql/WhereFilter.h"
 #include "odc/tools/SQLTool.h"
 
 using namespace std;
@@ -97,6 +99,10 @@ void SQLTool::run()
         throw UserError("Output file is required (option -o) for binary output format (option -f odb)");
     }
 
+    // Overlap the evaluation of the SQL with the encoding and writing of the output
+
+    ODBAPISettings::instance().asyncWriterFlush(true);
+
     std::vector<std::string> params(parameters());
     params.erase(params.begin());
 
@@ -134,7 +140,7 @@ void SQLTool::run()
         implicitCloser.reset(new AutoClose(*implicitTableDH));
 
         eckit::sql::SQLDatabase& db(session.currentDatabase());
-        db.addImplicitTable(new odc::sql::ODATable(db, *implicitTableDH));
+        db.addImplicitTable(new odc::sql::ODATable(db, *implicitTableDH, odc::sql::whereFilter(sql)));
     }
 
     // And actually do the SQL!
@@ -18,6 +18,7 @@
 #include "eckit/log/Log.h"
 #include "eckit/types/Types.h"
 
+#include "odc/core/FrameIndex.h"
 #include "odc/core/TablesReader.h"
 #include "odc/DispatchingWriter.h"
 #include "odc/LibOdc.h"
@@ -74,19 +75,19 @@ vector<pair<Offset,Length> > SplitTool::getChunks(const PathName& inFile, size_t
 
     vector<pair<Offset,Length> > r;
 
-    core::TablesReader reader(inFile);
-    auto it(reader.begin()), end(reader.end());
+    core::FrameIndex index(core::FrameIndex::forFile(inFile));
 
 	Offset currentOffset(0);
 	Length currentLength(0);
 	size_t currentSize (0);
 
-    for(; it != end; ++it)
+    for (size_t i = 0; i < index.frameCount(); ++i)
     {   
-        Offset offset(it->startPosition());
-        Length length(it->nextPosition() - it->startPosition());
-        size_t numberOfRows (it->rowCount());
-        size_t numberOfColumns (it->columnCount());
+        const core::FrameIndex::Frame& frame(index.frame(i));
+        Offset offset(frame.offset);
+        Length length(frame.length);
+        size_t numberOfRows (frame.rowCount);
+        size_t numberOfColumns (index.schema(frame.schema).names.size());
 
 		LOG_DEBUG_LIB(LibOdc) << "SplitTool::getChunks: " << offset << " " << length << endl;
 
@@ -8,10 +8,14 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <vector>
 
+#include "eckit/io/AutoCloser.h"
 #include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
 #include "eckit/testing/Test.h"
 
 #include "odc/api/odc.h"
@@ -1235,6 +1239,77 @@ CASE("Filter a subset of ODB-2 data") {
 
 // ------------------------------------------------------------------------------------------------------
 
+CASE("Columns reordered for encoding are presented in the original order") {
+
+    // The first column changes in every row, and the last not at all
+
+    const size_t nrows = 1000;
+    std::vector<double> obsvalue(nrows);
+    std::vector<double> seqno(nrows);
+    std::vector<double> date(nrows, 20200101);
+    for (size_t row = 0; row < nrows; ++row) {
+        obsvalue[row] = double(row) * 1.5;
+        seqno[row] = double(row / 100);
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"obsvalue", odc::api::DOUBLE, sizeof(double), {}},
+        {"seqno",    odc::api::DOUBLE, sizeof(double), {}},
+        {"date",     odc::api::DOUBLE, sizeof(double), {}},
+    };
+    std::vector<odc::api::ConstStridedData> strides {
+        {&obsvalue[0], nrows, sizeof(double), sizeof(double)},
+        {&seqno[0],    nrows, sizeof(double), sizeof(double)},
+        {&date[0],     nrows, sizeof(double), sizeof(double)},
+    };
+
+    eckit::MemoryHandle original;
+    original.openForWrite(0);
+    odc::api::encode(original, columns, strides, {}, nrows);
+    original.close();
+
+    eckit::MemoryHandle reordered;
+    reordered.openForWrite(0);
+    odc::api::encode(reordered, columns, strides, {}, nrows, 1, true);
+
+    EXPECT(reordered.position() < original.position());
+
+    // Read the data back in the order presented by the frame
+
+    eckit::MemoryHandle in(reordered.data(), size_t(reordered.position()));
+    reordered.close();
+    in.openForRead();
+    eckit::AutoClose closer(in);
+
+    odc::api::Reader reader(in);
+    odc::api::Frame frame = reader.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == nrows);
+
+    const auto& columnInfo = frame.columnInfo();
+    EXPECT(columnInfo.size() == 3);
+    EXPECT(columnInfo[0].name == "obsvalue");
+    EXPECT(columnInfo[1].name == "seqno");
+    EXPECT(columnInfo[2].name == "date");
+
+    std::vector<std::string> names;
+    std::vector<odc::api::StridedData> outStrides;
+    std::vector<double> output(3 * nrows);
+    for (size_t col = 0; col < columnInfo.size(); ++col) {
+        names.push_back(columnInfo[col].name);
+        outStrides.emplace_back(&output[col * nrows], nrows, sizeof(double), sizeof(double));
+    }
+
+    odc::api::Decoder decoder(names, outStrides);
+    decoder.decode(frame);
+
+    EXPECT(std::equal(obsvalue.begin(), obsvalue.end(), &output[0]));
+    EXPECT(std::equal(seqno.begin(), seqno.end(), &output[nrows]));
+    EXPECT(std::equal(date.begin(), date.end(), &output[2 * nrows]));
+}
+
+// ------------------------------------------------------------------------------------------------------
+
 //CASE("Decode an entire ODB file") {
 //
 //    odc::api::Odb o("../2000010106-reduced.odb");
@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <cstring>
+#include <vector>
 
 // TODO: unneeded
 #include <fcntl.h>
@@ -519,6 +520,80 @@ CASE("Encode with more rows that fit inside a table") {
 
 // ------------------------------------------------------------------------------------------------------
 
+CASE("Encoding frames in parallel gives identical output") {
+
+    odc_integer_behaviour(ODC_INTEGERS_AS_LONGS);
+
+    const int nrows = 1000;
+
+    long icol[nrows];
+    double rcol[nrows];
+    for (int i = 0; i < nrows; ++i) {
+        icol[i] = (i * 7) % 123;
+        rcol[i] = double(i) / 3;
+    }
+
+    std::vector<std::vector<char>> outputs;
+
+    for (int nthreads : {1, 3, 8}) {
+
+        odc_encoder_t* enc = nullptr;
+        CHECK_RETURN(odc_new_encoder(&enc));
+        std::unique_ptr<odc_encoder_t> enc_deleter(enc);
+
+        CHECK_RETURN(odc_encoder_set_row_count(enc, nrows));
+        CHECK_RETURN(odc_encoder_set_rows_per_frame(enc, 37));
+        CHECK_RETURN(odc_encoder_set_threads(enc, nthreads));
+        CHECK_RETURN(odc_encoder_add_column(enc, "col1", ODC_INTEGER));
+        CHECK_RETURN(odc_encoder_add_column(enc, "col2", ODC_DOUBLE));
+        CHECK_RETURN(odc_encoder_column_set_data_array(enc, 0, 0, 0, icol));
+        CHECK_RETURN(odc_encoder_column_set_data_array(enc, 1, 0, 0, rcol));
+
+        eckit::Buffer encoded(1024 * 1024);
+        long sz;
+        CHECK_RETURN(odc_encode_to_buffer(enc, encoded.data(), encoded.size(), &sz));
+        const char* data = static_cast<const char*>(encoded.data());
+        outputs.emplace_back(data, data + sz);
+    }
+
+    EXPECT(outputs[1] == outputs[0]);
+    EXPECT(outputs[2] == outputs[0]);
+
+    // And the frames are in the correct order
+
+    odc_reader_t* reader = nullptr;
+    CHECK_RETURN(odc_open_buffer(&reader, &outputs[2][0], outputs[2].size()));
+    std::unique_ptr<odc_reader_t> reader_deleter(reader);
+
+    odc_frame_t* frame = nullptr;
+    CHECK_RETURN(odc_new_frame(&frame, reader));
+    std::unique_ptr<odc_frame_t> frame_deleter(frame);
+
+    long row_offset = 0;
+    while (odc_next_frame(frame) == ODC_SUCCESS) {
+
+        odc_decoder_t* decoder;
+        CHECK_RETURN(odc_new_decoder(&decoder));
+        std::unique_ptr<odc_decoder_t> decoder_deleter(decoder);
+        CHECK_RETURN(odc_decoder_defaults_from_frame(decoder, frame));
+
+        long rows_decoded;
+        CHECK_RETURN(odc_decode(decoder, frame, &rows_decoded));
+
+        const void* pdata;
+        CHECK_RETURN(odc_decoder_data_array(decoder, &pdata, 0, 0, 0));
+        EXPECT(*reinterpret_cast<const long*>(pdata) == icol[row_offset]);
+
+        long row_count;
+        CHECK_RETURN(odc_frame_row_count(frame, &row_count));
+        row_offset += row_count;
+    }
+
+    EXPECT(row_offset == nrows);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
 CASE("Encode to a file descriptor") {
 
     // Do some trivial encoding
@@ -10,6 +10,7 @@
 
 #include <fstream>
 #include <memory>
+#include <vector>
 
 #include "eckit/io/FileHandle.h"
 #include "eckit/testing/Test.h"
@@ -358,6 +359,49 @@ CASE("Decode data in an existing ODB file") {
     }
 }
 
+CASE("Decoding a memory-mapped ODB file gives identical data") {
+
+    // Decode every frame of the file, opened with the specified function, into one byte array
+
+    auto decodeAll = [](int (*open_fn)(odc_reader_t**, const char*)) {
+
+        odc_reader_t* reader = nullptr;
+        CHECK_RETURN(open_fn(&reader, "../2000010106-reduced.odb"));
+        std::unique_ptr<odc_reader_t> reader_deleter(reader);
+
+        odc_frame_t* frame = nullptr;
+        CHECK_RETURN(odc_new_frame(&frame, reader));
+        std::unique_ptr<odc_frame_t> frame_deleter(frame);
+
+        std::vector<char> output;
+
+        int ierr;
+        while ((ierr = odc_next_frame(frame)) == ODC_SUCCESS) {
+
+            odc_decoder_t* decoder;
+            CHECK_RETURN(odc_new_decoder(&decoder));
+            std::unique_ptr<odc_decoder_t> decoder_deleter(decoder);
+
+            CHECK_RETURN(odc_decoder_defaults_from_frame(decoder, frame));
+
+            long nrows;
+            CHECK_RETURN(odc_decode(decoder, frame, &nrows));
+
+            const void* data;
+            long row_stride;
+            CHECK_RETURN(odc_decoder_data_array(decoder, &data, &row_stride, 0, 0));
+            output.insert(output.end(), (const char*)data, (const char*)data + (nrows * row_stride));
+        }
+
+        EXPECT(ierr == ODC_ITERATION_COMPLETE);
+        return output;
+    };
+
+    std::vector<char> expected = decodeAll(&odc_open_path);
+    EXPECT(!expected.empty());
+    EXPECT(decodeAll(&odc_open_path_mmap) == expected);
+}
+
 // ------------------------------------------------------------------------------------------------------
 
 CASE("Where the properties in the two frames are distinct (non-aggregated)") {
@@ -0,0 +1,116 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef odc_tests_GeneratedFrame_H
+#define odc_tests_GeneratedFrame_H
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/ODBAPISettings.h"
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/TablesReader.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A fixture holding one frame of generated data, encoded in memory. The generator supplies the
+/// value of each cell, except that the previous value of the column is repeated in a deterministic
+/// pattern, so that rows start from a variety of columns.
+
+class GeneratedFrame {
+
+public: // types
+
+    using Generator = std::function<void(size_t col, size_t row, char* cell, size_t width)>;
+
+public: // methods
+
+    GeneratedFrame(size_t nrows, const std::vector<odc::api::ColumnInfo>& columns, Generator generate) :
+        nrows_(nrows),
+        columns_(columns) {
+
+        for (const auto& col : columns_) data_.emplace_back(col.decodedSize * nrows_, 0);
+
+        for (size_t row = 0; row < nrows_; ++row) {
+            for (size_t col = 0; col < columns_.size(); ++col) {
+
+                size_t width = columns_[col].decodedSize;
+                char* p = &data_[col][row * width];
+
+                if (row != 0 && ((row * 7 + col * 3) % 5) < 2) {
+                    ::memcpy(p, p - width, width);
+                } else {
+                    generate(col, row, p, width);
+                }
+            }
+        }
+
+        std::vector<odc::api::ConstStridedData> strides;
+        for (size_t col = 0; col < columns_.size(); ++col) {
+            strides.emplace_back(&data_[col][0], nrows_, columns_[col].decodedSize, columns_[col].decodedSize);
+        }
+
+        encoded_.openForWrite(0);
+        eckit::AutoClose closer(encoded_);
+        odc::core::encodeFrame(encoded_, columns_, strides, {});
+        encodedSize_ = encoded_.position();
+    }
+
+    const std::vector<std::vector<char>>& data() const { return data_; }
+    const eckit::MemoryHandle& encoded() const { return encoded_; }
+    size_t encodedSize() const { return encodedSize_; }
+
+protected: // methods
+
+    /// Read the frame back, and pass its table to decode, using the specified decode block size
+
+    void decodeTable(size_t blockSize, std::function<void(odc::core::Table&)> decode) {
+
+        size_t savedBlockSize = odc::ODBAPISettings::instance().decodeBlockSize();
+        odc::ODBAPISettings::instance().decodeBlockSize(blockSize);
+
+        eckit::MemoryHandle dh(encoded_.data(), encodedSize_);
+        dh.openForRead();
+        eckit::AutoClose closer(dh);
+
+        odc::core::TablesReader reader(dh);
+        auto it = reader.begin();
+        EXPECT(it != reader.end());
+        EXPECT(it->rowCount() == nrows_);
+
+        try {
+            decode(*it);
+        } catch (...) {
+            odc::ODBAPISettings::instance().decodeBlockSize(savedBlockSize);
+            throw;
+        }
+        odc::ODBAPISettings::instance().decodeBlockSize(savedBlockSize);
+
+        EXPECT(++it == reader.end());
+    }
+
+protected: // members
+
+    size_t nrows_;
+    std::vector<odc::api::ColumnInfo> columns_;
+    std::vector<std::vector<char>> data_;
+    eckit::MemoryHandle encoded_;
+    size_t encodedSize_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#endif
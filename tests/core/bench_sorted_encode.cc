@@ -0,0 +1,176 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// Re-encodes the tables in an ODB file with core::encodeFrame, with the rows in their original
+/// order and sorted on the given key columns, and compares the encoded size and the rate at which
+/// the re-encoded data decodes.
+///
+/// Usage: odc_bench_sorted_encode <file.odb> <key column> [key column ...]
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/log/Timer.h"
+
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/TablesReader.h"
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    // The decoded contents of a table, laid out column by column
+
+    struct DecodedTable {
+        size_t nrows;
+        std::vector<odc::api::ColumnInfo> columns;
+        std::vector<std::vector<char>> buffers;
+    };
+
+    std::vector<DecodedTable> readFile(const eckit::PathName& path) {
+
+        std::vector<DecodedTable> tables;
+
+        odc::core::TablesReader reader(path);
+        for (auto& table : reader) {
+
+            DecodedTable decoded;
+            decoded.nrows = table.rowCount();
+
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+            decoded.buffers.resize(table.columnCount());
+
+            for (size_t i = 0; i < table.columnCount(); ++i) {
+                const odc::core::Column& col(*table.columns()[i]);
+                size_t width = col.dataSizeDoubles() * sizeof(double);
+
+                std::vector<odc::api::ColumnInfo::Bit> bitfield;
+                const eckit::sql::BitfieldDef& bf(col.bitfieldDef());
+                uint8_t offset = 0;
+                for (size_t b = 0; b < bf.first.size(); ++b) {
+                    bitfield.emplace_back(odc::api::ColumnInfo::Bit {bf.first[b], bf.second[b], offset});
+                    offset += bf.second[b];
+                }
+                decoded.columns.emplace_back(odc::api::ColumnInfo {col.name(), col.type(), width, bitfield});
+
+                decoded.buffers[i].resize(width * decoded.nrows);
+                names.push_back(col.name());
+                strides.emplace_back(&decoded.buffers[i][0], decoded.nrows, width, width);
+            }
+
+            odc::core::DecodeTarget target(names, strides);
+            table.decode(target);
+            tables.emplace_back(std::move(decoded));
+        }
+
+        return tables;
+    }
+
+    void encodeTables(const std::vector<DecodedTable>& tables, const std::vector<std::string>& sortKeys,
+                      eckit::MemoryHandle& out) {
+
+        out.openForWrite(0);
+        eckit::AutoClose closer(out);
+
+        for (const DecodedTable& table : tables) {
+            std::vector<odc::api::ConstStridedData> strides;
+            for (size_t i = 0; i < table.columns.size(); ++i) {
+                size_t width = table.columns[i].decodedSize;
+                strides.emplace_back(&table.buffers[i][0], table.nrows, width, width);
+            }
+            odc::core::encodeFrame(out, table.columns, strides, {}, false, sortKeys);
+        }
+    }
+
+    double decodeTables(eckit::MemoryHandle& encoded, size_t& nrows) {
+
+        encoded.openForRead();
+        eckit::AutoClose closer(encoded);
+
+        std::vector<std::vector<char>> buffers;
+        double elapsed = 0;
+        nrows = 0;
+
+        odc::core::TablesReader reader(encoded);
+        for (auto& table : reader) {
+
+            size_t rows = table.rowCount();
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+            buffers.resize(table.columnCount());
+
+            for (size_t i = 0; i < table.columnCount(); ++i) {
+                const odc::core::Column& col(*table.columns()[i]);
+                size_t width = col.dataSizeDoubles() * sizeof(double);
+                buffers[i].resize(width * rows);
+                names.push_back(col.name());
+                strides.emplace_back(&buffers[i][0], rows, width, width);
+            }
+
+            odc::core::DecodeTarget target(names, strides);
+
+            eckit::Timer timer;
+            table.decode(target);
+            elapsed += timer.elapsed();
+            nrows += rows;
+        }
+
+        return elapsed;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <file.odb> <key column> [key column ...]" << std::endl;
+        return 1;
+    }
+
+    eckit::PathName path(argv[1]);
+    std::vector<std::string> sortKeys(argv + 2, argv + argc);
+    const int repeats = 5;
+
+    std::vector<DecodedTable> tables = readFile(path);
+
+    for (bool sorted : {false, true}) {
+
+        eckit::MemoryHandle encoded;
+
+        eckit::Timer timer;
+        encodeTables(tables, sorted ? sortKeys : std::vector<std::string>(), encoded);
+        double encodeTime = timer.elapsed();
+        size_t size = size_t(encoded.position());
+
+        double best = 0;
+        size_t nrows = 0;
+        for (int i = 0; i < repeats; ++i) {
+            eckit::MemoryHandle in(encoded.data(), size);
+            double t = decodeTables(in, nrows);
+            if (i == 0 || t < best) best = t;
+        }
+
+        std::cout << (sorted ? "sorted" : "unsorted") << ": "
+                  << size << " bytes, encoded in " << encodeTime << "s, "
+                  << nrows << " rows decoded in " << best << "s, "
+                  << (best > 0 ? (nrows / best) : 0) << " rows/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// Measures the rate at which core::Table::decode decodes all of the columns in an ODB file,
+/// comparing row-by-row decoding against block decoding (optionally split over several threads).
+///
+/// Usage: odc_bench_table_decode <file.odb> [repeats] [block size] [threads]
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/log/Timer.h"
+
+#include "odc/ODBAPISettings.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/TablesReader.h"
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    double decodeFile(const eckit::PathName& path, size_t blockSize, size_t nthreads, size_t& nrows) {
+
+        odc::ODBAPISettings::instance().decodeBlockSize(blockSize);
+
+        odc::core::TablesReader reader(path);
+
+        std::vector<std::vector<char>> buffers;
+        double elapsed = 0;
+        nrows = 0;
+
+        for (auto& table : reader) {
+
+            size_t rows = table.rowCount();
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+            buffers.resize(table.columnCount());
+
+            for (size_t i = 0; i < table.columnCount(); ++i) {
+                const odc::core::Column& col(*table.columns()[i]);
+                size_t width = col.dataSizeDoubles() * sizeof(double);
+                buffers[i].resize(width * rows);
+                names.push_back(col.name());
+                strides.emplace_back(&buffers[i][0], rows, width, width);
+            }
+
+            odc::core::DecodeTarget target(names, strides);
+
+            eckit::Timer timer;
+            table.decode(target, nthreads);
+            elapsed += timer.elapsed();
+            nrows += rows;
+        }
+
+        return elapsed;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <file.odb> [repeats] [block size] [threads]" << std::endl;
+        return 1;
+    }
+
+    eckit::PathName path(argv[1]);
+    int repeats = (argc > 2) ? ::atoi(argv[2]) : 5;
+    size_t blockSize = (argc > 3) ? ::atol(argv[3]) : odc::ODBAPISettings::instance().decodeBlockSize();
+
+    size_t nthreads = (argc > 4) ? ::atol(argv[4]) : 1;
+
+    std::vector<std::pair<size_t, size_t>> configs { {0, 1}, {blockSize, 1} };
+    if (nthreads > 1) configs.emplace_back(blockSize, nthreads);
+
+    for (const auto& config : configs) {
+
+        double best = 0;
+        size_t nrows = 0;
+
+        for (int i = 0; i < repeats; ++i) {
+            double t = decodeFile(path, config.first, config.second, nrows);
+            if (i == 0 || t < best) best = t;
+        }
+
+        std::cout << (config.first == 0 ? "row-by-row" : "block size " + std::to_string(config.first))
+                  << ", " << config.second << " thread(s): "
+                  << nrows << " rows in " << best << "s, "
+                  << (best > 0 ? (nrows / best) : 0) << " rows/s" << std::endl;
+    }
+
+    return 0;
+}
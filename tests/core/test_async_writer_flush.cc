@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/core/TablesReader.h"
+#include "odc/MDI.h"
+#include "odc/ODBAPISettings.h"
+#include "odc/Writer.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t rowsPerTable = 250;
+    const size_t nrows = 10 * rowsPerTable + 17;
+
+    // Write rows with a mixture of column types, and varying ranges of values in each table, so that
+    // each table is encoded with different codecs.
+
+    std::vector<char> writeRows(bool asyncFlush) {
+
+        odc::ODBAPISettings& settings(odc::ODBAPISettings::instance());
+        bool saved = settings.asyncWriterFlush();
+        settings.asyncWriterFlush(asyncFlush);
+
+        eckit::MemoryHandle dh;
+
+        {
+            odc::Writer<> writer(dh);
+            writer.rowsBufferSize(rowsPerTable);
+            odc::Writer<>::iterator it = writer.begin();
+            settings.asyncWriterFlush(saved);
+
+            it->setNumberOfColumns(3);
+            it->setColumn(0, "int", odc::api::INTEGER);
+            it->setColumn(1, "real", odc::api::REAL);
+            it->setColumn(2, "string", odc::api::STRING);
+            it->writeHeader();
+
+            for (size_t row = 0; row < nrows; ++row) {
+                size_t table = row / rowsPerTable;
+                (*it)[0] = (row % 7 == 0) ? odc::MDI::integerMDI() : double((row * 13) % (10 + 100 * table));
+                (*it)[1] = double(row) / (table + 1);
+
+                double s;
+                char str[sizeof(double)] = {0};
+                ::snprintf(str, sizeof(str), "s%zu", row % (3 + 50 * (table % 4)));
+                ::memcpy(&s, str, sizeof(s));
+                (*it)[2] = s;
+                ++it;
+            }
+        }
+
+        const char* data = static_cast<const char*>(dh.data());
+        return std::vector<char>(data, data + size_t(dh.position()));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Flushing in the background gives identical output") {
+
+    std::vector<char> serial = writeRows(false);
+    std::vector<char> background = writeRows(true);
+
+    EXPECT(serial.size() > 0);
+    EXPECT(background == serial);
+
+    eckit::MemoryHandle dh(&background[0], background.size());
+    dh.openForRead();
+
+    size_t tables = 0;
+    size_t rows = 0;
+    odc::core::TablesReader reader(dh);
+    for (const auto& table : reader) {
+        EXPECT(table.rowCount() == std::min(rowsPerTable, nrows - rows));
+        rows += table.rowCount();
+        ++tables;
+    }
+
+    EXPECT(tables == 11);
+    EXPECT(rows == nrows);
+
+    dh.close();
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
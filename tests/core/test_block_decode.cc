@@ -0,0 +1,278 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/log/Log.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/MDI.h"
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/StringTable.h"
+
+#include "GeneratedFrame.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    // A frame that exercises all of the codecs selected by the CodecOptimizer
+
+    class BlockDecodeFixture : public GeneratedFrame {
+
+    public: // methods
+
+        BlockDecodeFixture(size_t nrows) :
+            GeneratedFrame(nrows, {
+                {"int8",         odc::api::INTEGER,  sizeof(double), {}},
+                {"int16",        odc::api::INTEGER,  sizeof(double), {}},
+                {"int32",        odc::api::INTEGER,  sizeof(double), {}},
+                {"int8_missing", odc::api::INTEGER,  sizeof(double), {}},
+                {"constant",     odc::api::INTEGER,  sizeof(double), {}},
+                {"short_real",   odc::api::REAL,     sizeof(double), {}},
+                {"long_real",    odc::api::DOUBLE,   sizeof(double), {}},
+                {"string",       odc::api::STRING,   2 * sizeof(double), {}},
+                {"const_string", odc::api::STRING,   sizeof(double), {}},
+                {"bitfield",     odc::api::BITFIELD, sizeof(double), {{"a", 3, 0}, {"b", 4, 3}}}
+            }, generate) {}
+
+        static void generate(size_t col, size_t row, char* p, size_t width) {
+
+            const double intMissing = odc::MDI::integerMDI();
+            const double realMissing = odc::MDI::realMDI();
+
+            double v = 0;
+            switch (col) {
+            case 0: v = double(row % 200) - 50; break;
+            case 1: v = double((row * 31) % 60000); break;
+            case 2: v = double(row * 104729) - 1e9; break;
+            case 3: v = (row % 4 == 0) ? intMissing : double(row % 100); break;
+            case 4: v = 1234; break;
+            case 5: v = (row % 6 == 0) ? realMissing : double(float(row) / 7); break;
+            case 6: v = double(row) / 3; break;
+            case 7: ::snprintf(p, width, "s%zu", (row * 13) % 1000); return;
+            case 8: ::memcpy(p, "abcdefgh", width); return;
+            case 9: v = double(row % 128); break;
+            }
+            ::memcpy(p, &v, sizeof(v));
+        }
+
+        /// Decode the columns (in reverse order), using the specified decode block size
+
+        std::vector<std::vector<char>> decode(size_t blockSize, size_t stridePadding=0, size_t nthreads=1) {
+
+            std::vector<std::vector<char>> output;
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+
+            for (size_t col = 0; col < columns_.size(); ++col) {
+                size_t stride = columns_[col].decodedSize + stridePadding;
+                output.emplace_back(stride * nrows_, 0);
+            }
+            for (size_t col = columns_.size(); col > 0; --col) {
+                size_t width = columns_[col-1].decodedSize;
+                names.push_back(columns_[col-1].name);
+                strides.emplace_back(&output[col-1][0], nrows_, width, width + stridePadding);
+            }
+
+            decodeTable(blockSize, [&](odc::core::Table& table) {
+                odc::core::DecodeTarget target(names, strides);
+                table.decode(target, nthreads);
+            });
+            return output;
+        }
+
+        /// Decode the numeric columns, writing the values in the specified type
+
+        std::vector<std::vector<char>> decodeAs(odc::api::DecodedType type, size_t blockSize, size_t nthreads=1) {
+
+            size_t width = odc::api::decodedTypeSize(type);
+            std::vector<std::vector<char>> output;
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+
+            for (size_t col : numericColumns()) {
+                output.emplace_back(width * nrows_, 0);
+                names.push_back(columns_[col].name);
+                strides.emplace_back(&output.back()[0], nrows_, width, width);
+            }
+
+            decodeTable(blockSize, [&](odc::core::Table& table) {
+                odc::core::DecodeTarget target(names, strides, std::vector<odc::api::DecodedType>(names.size(), type));
+                table.decode(target, nthreads);
+            });
+            return output;
+        }
+
+        /// Decode the string columns as codes, and expand the codes using the tables of strings. Also
+        /// returns the number of strings in each table.
+
+        std::vector<std::vector<char>> decodeCodes(size_t blockSize, size_t nthreads, std::vector<size_t>& tableSizes) {
+
+            std::vector<std::vector<int32_t>> codes;
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+
+            for (size_t col : stringColumns()) {
+                codes.emplace_back(nrows_, -1);
+                names.push_back(columns_[col].name);
+                strides.emplace_back(&codes.back()[0], nrows_, sizeof(int32_t), sizeof(int32_t));
+            }
+
+            std::vector<std::vector<std::string>> tables;
+            decodeTable(blockSize, [&](odc::core::Table& table) {
+                odc::core::DecodeTarget target(names, strides,
+                                               std::vector<odc::api::DecodedType>(names.size(), odc::api::DECODED_STRING_CODE));
+                table.decode(target, nthreads);
+                for (size_t i = 0; i < names.size(); ++i) tables.push_back(target.stringTable(i)->strings());
+            });
+
+            std::vector<std::vector<char>> output;
+            tableSizes.clear();
+            for (size_t i = 0; i < names.size(); ++i) {
+                const std::vector<std::string>& strings(tables[i]);
+                size_t width = columns_[stringColumns()[i]].decodedSize;
+                output.emplace_back(width * nrows_, 0);
+                for (size_t row = 0; row < nrows_; ++row) {
+                    int32_t code = codes[i][row];
+                    EXPECT(code >= 0 && size_t(code) < strings.size());
+                    ::memcpy(&output.back()[row * width], strings[code].data(), std::min(width, strings[code].size()));
+                }
+                tableSizes.push_back(strings.size());
+            }
+            return output;
+        }
+
+        /// The values of the numeric columns, converted to the type (clamped to the range of integer types)
+
+        template <typename T>
+        std::vector<std::vector<char>> convertedData() const {
+
+            std::vector<std::vector<char>> output;
+            for (size_t col : numericColumns()) {
+                output.emplace_back(sizeof(T) * nrows_, 0);
+                for (size_t row = 0; row < nrows_; ++row) {
+                    double v;
+                    ::memcpy(&v, &data_[col][row * sizeof(double)], sizeof(v));
+                    T t;
+                    if (std::is_integral<T>::value && v >= double(std::numeric_limits<T>::max())) {
+                        t = std::numeric_limits<T>::max();
+                    } else if (std::is_integral<T>::value && v <= double(std::numeric_limits<T>::min())) {
+                        t = std::numeric_limits<T>::min();
+                    } else {
+                        t = static_cast<T>(v);
+                    }
+                    ::memcpy(&output.back()[row * sizeof(T)], &t, sizeof(t));
+                }
+            }
+            return output;
+        }
+
+        static std::vector<size_t> numericColumns() { return {0, 1, 2, 3, 4, 5, 6, 9}; }
+        static std::vector<size_t> stringColumns() { return {7, 8}; }
+
+    };
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Block decoding is bit-identical to row-by-row decoding") {
+
+    BlockDecodeFixture fixture(10000);
+
+    std::vector<std::vector<char>> reference = fixture.decode(0);
+    EXPECT(reference == fixture.data());
+
+    for (size_t blockSize : {1, 7, 1000, 4096, 20000}) {
+        eckit::Log::info() << "Decoding with block size " << blockSize << std::endl;
+        EXPECT(fixture.decode(blockSize) == reference);
+    }
+}
+
+CASE("Block decoding respects strided output") {
+
+    BlockDecodeFixture fixture(1000);
+
+    std::vector<std::vector<char>> reference = fixture.decode(0, 16);
+    std::vector<std::vector<char>> blocks = fixture.decode(64, 16);
+
+    EXPECT(blocks == reference);
+}
+
+CASE("Threaded decoding of a single table is bit-identical to serial decoding") {
+
+    BlockDecodeFixture fixture(10000);
+
+    std::vector<std::vector<char>> reference = fixture.decode(0);
+
+    EXPECT(fixture.decode(64, 0, 4) == reference);
+    EXPECT(fixture.decode(7, 0, 16) == reference);
+    EXPECT(fixture.decode(1000, 8, 3) == fixture.decode(0, 8));
+}
+
+CASE("Values are converted to narrower types as they are decoded") {
+
+    BlockDecodeFixture fixture(5000);
+
+    for (size_t blockSize : {0, 7, 4096}) {
+        EXPECT(fixture.decodeAs(odc::api::DECODED_INT8, blockSize) == fixture.convertedData<int8_t>());
+        EXPECT(fixture.decodeAs(odc::api::DECODED_INT16, blockSize) == fixture.convertedData<int16_t>());
+        EXPECT(fixture.decodeAs(odc::api::DECODED_INT32, blockSize) == fixture.convertedData<int32_t>());
+        EXPECT(fixture.decodeAs(odc::api::DECODED_INT64, blockSize) == fixture.convertedData<int64_t>());
+        EXPECT(fixture.decodeAs(odc::api::DECODED_FLOAT32, blockSize) == fixture.convertedData<float>());
+        EXPECT(fixture.decodeAs(odc::api::DECODED_FLOAT64, blockSize) == fixture.convertedData<double>());
+    }
+
+    EXPECT(fixture.decodeAs(odc::api::DECODED_FLOAT32, 64, 4) == fixture.convertedData<float>());
+    EXPECT(fixture.decodeAs(odc::api::DECODED_INT32, 7, 16) == fixture.convertedData<int32_t>());
+}
+
+CASE("String columns are decoded as codes into a table of their strings") {
+
+    BlockDecodeFixture fixture(5000);
+
+    std::vector<std::vector<char>> expected;
+    std::vector<size_t> distinct;
+    for (size_t col : BlockDecodeFixture::stringColumns()) {
+        expected.push_back(fixture.data()[col]);
+        size_t width = expected.back().size() / 5000;
+        std::set<std::string> values;
+        for (size_t row = 0; row < 5000; ++row) {
+            values.insert(std::string(&expected.back()[row * width], width));
+        }
+        distinct.push_back(values.size());
+    }
+
+    // Each string is in the table once
+
+    for (size_t blockSize : {0, 7, 4096}) {
+        std::vector<size_t> tableSizes;
+        EXPECT(fixture.decodeCodes(blockSize, 1, tableSizes) == expected);
+        EXPECT(tableSizes == distinct);
+    }
+
+    std::vector<size_t> tableSizes;
+    EXPECT(fixture.decodeCodes(64, 4, tableSizes) == expected);
+    EXPECT(tableSizes == distinct);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
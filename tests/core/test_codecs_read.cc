@@ -972,6 +972,101 @@ CASE("short floating point values can include the missing data value") {
     }
 }
 
+CASE("xor floating point values store only the bits that differ from a reference value") {
+
+    const char* source_data[] = {
+
+        // Codec header
+        "\x00\x00\x00\x00",                  // no missing value
+        "\x00\x00\x00\x00\x00\x00\xf0\x3f",  // minimum = 1.0
+        "\x00\x00\x00\x00\x00\x00\xf8\x3f",  // maximum = 1.5 (unused)
+        "\x04\x4f\xab\xa0\xe4\x4e\x91\x26",  // missing value = 6.54565456545599971850917315786e-123
+        "\x00\x00\x00\x00\x00\x00\xf0\x3f",  // reference = 1.0
+        "\x20\x00\x00\x00",                  // shift = 32 bits
+        "\x03\x00\x00\x00",                  // width = 3 bytes
+
+        // data to encode
+        "\x00\x00\x00",   // 1.0
+        "\x00\x00\x08",   // 1.5
+        "\x01\x00\x00",   // 1.0 + 2^-20
+        "\x01\x00\x08"    // 1.5 + 2^-20
+    };
+
+    // The bits in which the values differ span 20 bits, so need 3 bytes
+
+    uint64_t reference = 0x3ff0000000000000ULL;
+    uint64_t xorBits = 0x0008000100000000ULL;
+    EXPECT(CodecXorReal<SameByteOrder>::encodedWidth(xorBits) == 3);
+    EXPECT(CodecXorReal<SameByteOrder>::encodedWidth(0) == 1);
+    EXPECT(CodecXorReal<SameByteOrder>::encodedWidth(0x8000000000000001ULL) == 8);
+
+    // Loop through endiannesses for the source data
+
+    for (int i = 0; i < 2; i++) {
+
+        bool bigEndianSource = (i % 2 == 0);
+
+        std::vector<unsigned char> data;
+
+        for (size_t j = 0; j < sizeof(source_data) / sizeof(const char*); j++) {
+            size_t len = (j == 0) ? 4 : (j < 5) ? 8 : (j < 7) ? 4 : 3;
+            data.insert(data.end(), source_data[j], source_data[j] + len);
+            if (bigEndianSource)
+                std::reverse(data.end()-len, data.end());
+        }
+
+        // Construct codec from factory
+
+        size_t hdrSize = prepend_codec_selection_header(data, "xor_real", bigEndianSource);
+
+        GeneralDataStream ds(bigEndianSource != eckit::system::SystemInfo::isBigEndian(), &data[0], data.size());
+
+        std::unique_ptr<Codec> c;
+        if (bigEndianSource == eckit::system::SystemInfo::isBigEndian()) {
+            c = CodecFactory::instance().load(ds.same(), odc::api::REAL);
+        } else {
+            c = CodecFactory::instance().load(ds.other(), odc::api::REAL);
+        }
+        c->setDataStream(ds);
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 44));
+        EXPECT(c->encodedSize() == 3);
+        EXPECT(c->formatVersionMinor() == odc::core::FORMAT_VERSION_NUMBER_MINOR_XOR_REAL);
+
+        double val;
+        c->decode(&val);
+        EXPECT(val == 1.0);
+        c->decode(&val);
+        EXPECT(val == 1.5);
+        c->decode(&val);
+        EXPECT(val == 1.0 + ::ldexp(1.0, -20));
+        c->decode(&val);
+        EXPECT(val == 1.5 + ::ldexp(1.0, -20));
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 44 + (4 * 3)));
+
+        // Encoding with the fitted parameters reproduces the data
+
+        std::unique_ptr<Codec> encoder;
+        std::vector<unsigned char> encoded(4 * 3);
+        if (bigEndianSource == eckit::system::SystemInfo::isBigEndian()) {
+            encoder = CodecFactory::instance().build<SameByteOrder>("xor_real", odc::api::REAL);
+            dynamic_cast<CodecXorReal<SameByteOrder>&>(*encoder).fit(reference, xorBits);
+        } else {
+            encoder = CodecFactory::instance().build<OtherByteOrder>("xor_real", odc::api::REAL);
+            dynamic_cast<CodecXorReal<OtherByteOrder>&>(*encoder).fit(reference, xorBits);
+        }
+
+        unsigned char* p = &encoded[0];
+        for (double v : {1.0, 1.5, 1.0 + ::ldexp(1.0, -20), 1.5 + ::ldexp(1.0, -20)}) {
+            p = encoder->encode(p, v);
+        }
+        EXPECT(p == &encoded[0] + encoded.size());
+        EXPECT(::memcmp(&encoded[0], &data[hdrSize + 44], encoded.size()) == 0);
+    }
+}
+
+
 CASE("32bit integers can be decoded direct to integers") {
 
     // Set to decode to integers rather than doubles
@@ -1189,6 +1284,154 @@ CASE("32bit integers are as-is") {
 }
 
 
+CASE("24bit integers are stored with an offset in three bytes") {
+
+    const char* source_data[] = {
+
+        // Codec header
+        "\x00\x00\x00\x00",                  // no missing value
+        "\xcd\xcc\xcc\xcc\xcc\xdc\x5e\xc0",  // minimum = -123.45
+        "\x00\x00\x00\x00\x00\x00\x00\x00",  // maximum unspecified
+        "\x04\x4f\xab\xa0\xe4\x4e\x91\x26",  // missing value = 6.54565456545599971850917315786e-123
+
+        // data to encode
+        "\x00\x00\x00",   // 0.0
+        "\xff\xff\xff",   // 16777215 and the missing value
+        "\x56\x34\x12",   // 1193046
+        "\x00\x00\x80",   // 8388608 (no negatives)
+        "\x39\x30\x00"    // 12345
+    };
+
+    // Loop through endiannesses for the source data
+
+    for (int i = 0; i < 4; i++) {
+
+        bool bigEndianSource = (i % 2 == 0);
+
+        bool withMissing = (i > 1);
+
+        std::vector<unsigned char> data;
+
+        for (size_t j = 0; j < sizeof(source_data) / sizeof(const char*); j++) {
+            size_t len = (j == 0) ? 4 : (j > 3) ? 3 : 8;
+            data.insert(data.end(), source_data[j], source_data[j] + len);
+            if (bigEndianSource)
+                std::reverse(data.end()-len, data.end());
+        }
+
+        // Construct codec from factory
+
+        size_t hdrSize = prepend_codec_selection_header(data, withMissing ? "int24_missing" : "int24", bigEndianSource);
+
+        GeneralDataStream ds(bigEndianSource != eckit::system::SystemInfo::isBigEndian(), &data[0], data.size());
+
+        std::unique_ptr<Codec> c;
+        if (bigEndianSource == eckit::system::SystemInfo::isBigEndian()) {
+            c = CodecFactory::instance().load(ds.same(), odc::api::INTEGER);
+        } else {
+            c = CodecFactory::instance().load(ds.other(), odc::api::INTEGER);
+        }
+        c->setDataStream(ds);
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 28));
+        EXPECT(c->encodedSize() == 3);
+        EXPECT(c->formatVersionMinor() == odc::core::FORMAT_VERSION_NUMBER_MINOR_INT24);
+
+        double val;
+        c->decode(&val);
+        EXPECT(val == (double(-123.45) + 0));
+        c->decode(&val);
+        if (withMissing) {
+            EXPECT(val == 6.54565456545599971850917315786e-123);
+        } else {
+            EXPECT(val == (double(-123.45) + 16777215));
+        }
+        c->decode(&val);
+        EXPECT(val == (double(-123.45) + 1193046));
+        c->decode(&val);
+        EXPECT(val == (double(-123.45) + 8388608));
+        c->decode(&val);
+        EXPECT(val == (double(-123.45) + 12345));
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 28 + (5 * 3)));
+    }
+}
+
+
+CASE("Integer dictionaries store an index into a table of the distinct values") {
+
+    const char* source_data[] = {
+
+        // Codec header
+        "\x01\x00\x00\x00",                  // has missing value
+        "\x00\x00\xc0\xff\xff\xff\xdf\xc1",  // minimum = -2147483647
+        "\x00\x00\x00\x00\xd0\x12\x53\x41",  // maximum = 5000000
+        "\x00\x00\xc0\xff\xff\xff\xdf\xc1",  // missing value = -2147483647
+
+        // Table of distinct values, including the missing value
+        "\x03\x00\x00\x00",                  // 3 values
+        "\x01\x00\x00\x80\xff\xff\xff\xff",  // -2147483647
+        "\x07\x00\x00\x00\x00\x00\x00\x00",  // 7
+        "\x40\x4b\x4c\x00\x00\x00\x00\x00",  // 5000000
+
+        // data to encode (as indices into the table of values)
+        "\x01\x00",   // 7
+        "\x02\x00",   // 5000000
+        "\x00\x00",   // -2147483647 (missing)
+        "\x01\x00"    // 7
+    };
+
+    // Loop through endiannesses for the source data, and the width of the indices
+
+    for (int i = 0; i < 4; i++) {
+
+        bool bigEndianSource = (i % 2 == 0);
+
+        size_t indexSize = (i > 1) ? 2 : 1;
+
+        std::vector<unsigned char> data;
+
+        for (size_t j = 0; j < sizeof(source_data) / sizeof(const char*); j++) {
+            size_t len = (j == 0 || j == 4) ? 4 : (j > 7) ? indexSize : 8;
+            data.insert(data.end(), source_data[j], source_data[j] + len);
+            if (bigEndianSource)
+                std::reverse(data.end()-len, data.end());
+        }
+
+        // Construct codec from factory
+
+        size_t hdrSize = prepend_codec_selection_header(data, (indexSize == 2) ? "int16_dictionary" : "int8_dictionary", bigEndianSource);
+
+        GeneralDataStream ds(bigEndianSource != eckit::system::SystemInfo::isBigEndian(), &data[0], data.size());
+
+        std::unique_ptr<Codec> c;
+        if (bigEndianSource == eckit::system::SystemInfo::isBigEndian()) {
+            c = CodecFactory::instance().load(ds.same(), odc::api::INTEGER);
+        } else {
+            c = CodecFactory::instance().load(ds.other(), odc::api::INTEGER);
+        }
+        c->setDataStream(ds);
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 56));
+        EXPECT(c->encodedSize() == indexSize);
+        EXPECT(c->numDistinctValues() == 3);
+        EXPECT(c->formatVersionMinor() == odc::core::FORMAT_VERSION_NUMBER_MINOR_INT_DICTIONARY);
+
+        double val;
+        c->decode(&val);
+        EXPECT(val == 7);
+        c->decode(&val);
+        EXPECT(val == 5000000);
+        c->decode(&val);
+        EXPECT(val == -2147483647);
+        c->decode(&val);
+        EXPECT(val == 7);
+
+        EXPECT(ds.position() == eckit::Offset(hdrSize + 56 + (4 * indexSize)));
+    }
+}
+
+
 CASE("16bit integers are stored with an offset. This need not (strictly) be integral!!") {
 
     // n.b. we use a non-standard, non-integral minimum to demonstrate the offset behaviour.
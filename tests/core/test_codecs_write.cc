@@ -13,6 +13,8 @@
 #include <cstdlib>
 #include <algorithm>
 #include <array>
+#include <memory>
+#include <vector>
 
 #include "eckit/eckit_ecbuild_config.h"
 #include "eckit/io/Buffer.h"
@@ -26,6 +28,7 @@
 #include "odc/codec/IntegerMissing.h"
 #include "odc/codec/Real.h"
 #include "odc/codec/String.h"
+#include "odc/MDI.h"
 
 
 using namespace eckit;
@@ -1615,6 +1618,53 @@ CASE("Character strings can be stored in a flat list, and indexed, and longer th
 
 // ------------------------------------------------------------------------------------------------------
 
+CASE("Gathering statistics in blocks matches gathering them value by value") {
+
+    // Include missing values before, between and after the other values, and the values that
+    // collide with the internal missing values of the short_real codecs.
+
+    const double missing = odc::MDI::realMDI();
+    const float shortRealMissing = reinterpret_cast<const float&>(minFloatAsInt);
+    const std::vector<std::vector<double>> blocks {
+        {missing, missing, 3, -7, missing, 12.5, 0, missing},
+        {5, 4, 3, 2, 1, shortRealMissing},
+        {missing, missing},
+        {-0.0, 0.0, 1e300, -1e300},
+    };
+
+    std::vector<std::pair<std::unique_ptr<Codec>, std::unique_ptr<Codec>>> codecs;
+    codecs.emplace_back(new CodecInt32<SameByteOrder, double>(odc::api::INTEGER),
+                        new CodecInt32<SameByteOrder, double>(odc::api::INTEGER));
+    codecs.emplace_back(new CodecLongReal<SameByteOrder>(odc::api::REAL),
+                        new CodecLongReal<SameByteOrder>(odc::api::REAL));
+
+    for (auto& pair : codecs) {
+        for (const auto& values : blocks) {
+
+            Codec& byValue(*pair.first);
+            Codec& byBlock(*pair.second);
+            byValue.resetStats();
+            byBlock.resetStats();
+            byValue.missingValue(missing);
+            byBlock.missingValue(missing);
+
+            for (double v : values) byValue.gatherStats(v);
+            byBlock.gatherStatsBlock(&values[0], values.size());
+
+            EXPECT(byBlock.min() == byValue.min());
+            EXPECT(byBlock.max() == byValue.max());
+            EXPECT(byBlock.hasMissing() == byValue.hasMissing());
+        }
+    }
+
+    CodecLongReal<SameByteOrder> real(odc::api::REAL);
+    static_cast<Codec&>(real).gatherStatsBlock(&blocks[1][0], blocks[1].size());
+    EXPECT(real.hasShortRealInternalMissing());
+    EXPECT(!real.hasShortReal2InternalMissing());
+}
+
+// ------------------------------------------------------------------------------------------------------
+
 int main(int argc, char* argv[]) {
 
     return run_tests(argc, argv);
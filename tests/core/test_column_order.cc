@@ -0,0 +1,140 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/TablesReader.h"
+#include "odc/Reader.h"
+
+#include "../TemporaryFiles.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t numRows = 1000;
+
+    double obsvalue(size_t row) { return row * 1.5; }
+    double seqno(size_t row) { return row / 100; }
+    const double date = 20200101;
+
+    // Write a frame whose columns are reordered by the encoder. The first column changes in every
+    // row, and the last not at all.
+
+    class ReorderedFile : public TemporaryFile {
+
+    public: // methods
+
+        ReorderedFile() {
+
+            std::vector<double> values(3 * numRows);
+            for (size_t row = 0; row < numRows; ++row) {
+                values[row] = obsvalue(row);
+                values[numRows + row] = seqno(row);
+                values[2 * numRows + row] = date;
+            }
+
+            std::vector<odc::api::ColumnInfo> columns {
+                {"obsvalue", odc::api::DOUBLE,  sizeof(double), {}},
+                {"seqno",    odc::api::INTEGER, sizeof(double), {}},
+                {"date",     odc::api::INTEGER, sizeof(double), {}},
+            };
+            std::vector<odc::api::ConstStridedData> strides {
+                {&values[0], numRows, sizeof(double), sizeof(double)},
+                {&values[numRows], numRows, sizeof(double), sizeof(double)},
+                {&values[2 * numRows], numRows, sizeof(double), sizeof(double)},
+            };
+
+            eckit::FileHandle fh(path());
+            fh.openForWrite(0);
+            eckit::AutoClose closer(fh);
+            saved_ = odc::core::encodeFrame(fh, columns, strides, {}, true);
+        }
+
+        size_t saved() const { return saved_; }
+
+    private: // members
+
+        size_t saved_;
+    };
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("The legacy reader presents reordered columns in the original order") {
+
+    ReorderedFile file;
+    EXPECT(file.saved() > 0);
+
+    // The columns are stored in a different order
+
+    odc::core::TablesReader tables(file.path());
+    auto table = tables.begin();
+    EXPECT(table->columns()[0]->name() != "obsvalue");
+
+    odc::Reader in(file.path());
+    odc::Reader::iterator it = in.begin();
+    odc::Reader::iterator end = in.end();
+
+    EXPECT(it->columns().size() == 3);
+    EXPECT(it->columns()[0]->name() == "obsvalue");
+    EXPECT(it->columns()[1]->name() == "seqno");
+    EXPECT(it->columns()[2]->name() == "date");
+    EXPECT(it->columns()[0]->type() == odc::api::DOUBLE);
+    EXPECT(it->columns()[2]->type() == odc::api::INTEGER);
+
+    size_t row = 0;
+    for (; it != end; ++it, ++row) {
+        EXPECT((*it)[0] == obsvalue(row));
+        EXPECT((*it)[1] == seqno(row));
+        EXPECT((*it)[2] == date);
+    }
+
+    EXPECT(row == numRows);
+}
+
+CASE("The columns of a table can be restored to the original order") {
+
+    ReorderedFile file;
+
+    odc::core::TablesReader tables(file.path());
+    auto table = tables.begin();
+
+    odc::core::MetaData columns(table->columns());
+    std::vector<size_t> positions = odc::core::restoreColumnOrder(columns, table->properties());
+
+    EXPECT(positions.size() == 3);
+    EXPECT(columns[0]->name() == "obsvalue");
+    EXPECT(columns[1]->name() == "seqno");
+    EXPECT(columns[2]->name() == "date");
+    for (size_t col = 0; col < 3; ++col) {
+        EXPECT(table->columns()[positions[col]]->name() == columns[col]->name());
+    }
+
+    // Columns that were not reordered are unchanged
+
+    odc::core::MetaData unchanged(table->columns());
+    EXPECT(odc::core::restoreColumnOrder(unchanged, {}).empty());
+    EXPECT(unchanged[0]->name() == table->columns()[0]->name());
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -8,6 +8,14 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
 #include "eckit/io/Buffer.h"
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/testing/Test.h"
@@ -16,7 +24,16 @@
 
 #include "odc/Writer.h"
 #include "odc/Reader.h"
+#include "odc/api/ColumnInfo.h"
 #include "odc/api/ColumnType.h"
+#include "odc/codec/CodecOptimizer.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/Header.h"
+#include "odc/core/MetaData.h"
+#include "odc/core/TablesReader.h"
+#include "odc/MDI.h"
+#include "odc/ODBAPISettings.h"
 
 using namespace eckit::testing;
 
@@ -497,6 +514,462 @@ CASE("Pathological data for integral codecs is correctly encoded") {
 
 }
 
+CASE("Large frames are encoded and written in chunks") {
+
+    // Record the writes made by the encoder
+
+    class RecordingHandle : public eckit::MemoryHandle {
+    public:
+        long write(const void* data, long len) override {
+            largestWrite = std::max(largestWrite, len);
+            ++writes;
+            return eckit::MemoryHandle::write(data, len);
+        }
+        long largestWrite = 0;
+        size_t writes = 0;
+    };
+
+    // n.b. The encoded frame is several megabytes
+
+    const size_t nrows = 500000;
+    std::vector<double> ints(nrows);
+    std::vector<double> reals(nrows);
+    for (size_t row = 0; row < nrows; ++row) {
+        ints[row] = double(row);
+        reals[row] = double(row) / 4;
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"int",  odc::api::INTEGER, sizeof(double), {}},
+        {"real", odc::api::REAL,    sizeof(double), {}},
+    };
+    std::vector<odc::api::ConstStridedData> strides {
+        {&ints[0], nrows, sizeof(double), sizeof(double)},
+        {&reals[0], nrows, sizeof(double), sizeof(double)},
+    };
+
+    RecordingHandle dh;
+    dh.openForWrite(0);
+    {
+        eckit::AutoClose closer(dh);
+        odc::core::encodeFrame(dh, columns, strides, {});
+    }
+
+    EXPECT(size_t(dh.position()) > 4 * 1024 * 1024);
+    EXPECT(dh.writes > 2);
+    EXPECT(size_t(dh.largestWrite) < size_t(dh.position()) / 2);
+
+    // And the data is read back correctly
+
+    eckit::MemoryHandle in(dh.data(), size_t(dh.position()));
+    in.openForRead();
+    eckit::AutoClose closer(in);
+
+    odc::core::TablesReader reader(in);
+    auto it = reader.begin();
+    EXPECT(it != reader.end());
+    EXPECT(it->rowCount() == nrows);
+
+    std::vector<double> outInts(nrows);
+    std::vector<double> outReals(nrows);
+    std::vector<odc::api::StridedData> outStrides {
+        {&outInts[0], nrows, sizeof(double), sizeof(double)},
+        {&outReals[0], nrows, sizeof(double), sizeof(double)},
+    };
+    odc::core::DecodeTarget target({"int", "real"}, outStrides);
+    it->decode(target);
+
+    EXPECT(outInts == ints);
+    EXPECT(outReals == reals);
+}
+
+CASE("Rows are sorted on key columns before encoding") {
+
+    // Observations from interleaved stations, each with a constant station type
+
+    const size_t nrows = 1200;
+    const size_t nstations = 12;
+    std::vector<double> obsvalue(nrows);
+    std::vector<double> statid(nrows);
+    std::vector<double> obstype(nrows);
+    for (size_t row = 0; row < nrows; ++row) {
+        obsvalue[row] = double(row % 7);
+        statid[row] = double((row * 5) % nstations);
+        obstype[row] = double(10 + size_t(statid[row]) % 3);
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"statid",   odc::api::INTEGER, sizeof(double), {}},
+        {"obstype",  odc::api::INTEGER, sizeof(double), {}},
+        {"obsvalue", odc::api::REAL,    sizeof(double), {}},
+    };
+    std::vector<odc::api::ConstStridedData> strides {
+        {&statid[0],   nrows, sizeof(double), sizeof(double)},
+        {&obstype[0],  nrows, sizeof(double), sizeof(double)},
+        {&obsvalue[0], nrows, sizeof(double), sizeof(double)},
+    };
+
+    eckit::MemoryHandle unsorted;
+    unsorted.openForWrite(0);
+    odc::core::encodeFrame(unsorted, columns, strides, {});
+
+    eckit::MemoryHandle sorted;
+    sorted.openForWrite(0);
+    odc::core::encodeFrame(sorted, columns, strides, {}, false, {"obstype", "statid"});
+
+    EXPECT(sorted.position() < unsorted.position());
+
+    // The rows are sorted on the keys, and stay in their original order otherwise
+
+    eckit::MemoryHandle in(sorted.data(), size_t(sorted.position()));
+    in.openForRead();
+    eckit::AutoClose closer(in);
+
+    odc::core::TablesReader reader(in);
+    auto it = reader.begin();
+    EXPECT(it->rowCount() == nrows);
+
+    std::vector<double> output(3 * nrows);
+    std::vector<odc::api::StridedData> outStrides;
+    for (size_t col = 0; col < 3; ++col) {
+        outStrides.emplace_back(&output[col * nrows], nrows, sizeof(double), sizeof(double));
+    }
+    odc::core::DecodeTarget target({"statid", "obstype", "obsvalue"}, outStrides);
+    it->decode(target);
+
+    std::vector<size_t> order(nrows);
+    for (size_t row = 0; row < nrows; ++row) order[row] = row;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return obstype[a] < obstype[b] || (obstype[a] == obstype[b] && statid[a] < statid[b]);
+    });
+
+    for (size_t row = 0; row < nrows; ++row) {
+        EXPECT(output[row] == statid[order[row]]);
+        EXPECT(output[nrows + row] == obstype[order[row]]);
+        EXPECT(output[2 * nrows + row] == obsvalue[order[row]]);
+    }
+}
+
+CASE("The writer sorts the rows of each table on key columns") {
+
+    eckit::MemoryHandle dh;
+    {
+        odc::Writer<> oda(dh);
+        oda.rowsBufferSize(10).sortKeys({"key"});
+        odc::Writer<>::iterator writer = oda.begin();
+
+        writer->setNumberOfColumns(2);
+        writer->setColumn(0, "key", odc::api::INTEGER);
+        writer->setColumn(1, "value", odc::api::INTEGER);
+        writer->writeHeader();
+
+        for (size_t row = 0; row < 25; ++row) {
+            (*writer)[0] = double((row * 7) % 3);
+            (*writer)[1] = double(row);
+            ++writer;
+        }
+    }
+
+    // Each table of 10 rows is sorted independently
+
+    eckit::MemoryHandle in(dh.data(), size_t(dh.position()));
+    in.openForRead();
+    eckit::AutoClose closer(in);
+
+    size_t row = 0;
+    odc::core::TablesReader reader(in);
+    for (auto& table : reader) {
+
+        size_t nrows = table.rowCount();
+        std::vector<double> keys(nrows);
+        std::vector<double> values(nrows);
+        std::vector<odc::api::StridedData> strides {
+            {&keys[0], nrows, sizeof(double), sizeof(double)},
+            {&values[0], nrows, sizeof(double), sizeof(double)},
+        };
+        odc::core::DecodeTarget target({"key", "value"}, strides);
+        table.decode(target);
+
+        for (size_t i = 0; i < nrows; ++i) {
+            EXPECT(values[i] >= row);
+            EXPECT(values[i] < row + nrows);
+            if (i != 0) {
+                EXPECT(keys[i - 1] < keys[i] || (keys[i - 1] == keys[i] && values[i - 1] < values[i]));
+            }
+        }
+        row += nrows;
+    }
+
+    EXPECT(row == 25);
+}
+
+namespace {
+
+    using CodecSetting = void (odc::ODBAPISettings::*)(bool);
+    using CodecSettingValue = bool (odc::ODBAPISettings::*)() const;
+
+    /// Encode a frame with a codec setting enabled or disabled, and check that only frames using
+    /// the enabled codecs require the corresponding minor format version. The table is read back,
+    /// passed to check, then decoded and compared with the values. Returns the encoded data size.
+
+    size_t encodeWithSetting(CodecSettingValue value, CodecSetting setting, bool enabled, int32_t minorVersion,
+                             const std::vector<odc::api::ColumnInfo>& columns,
+                             const std::vector<std::vector<double>>& values,
+                             std::function<void(odc::core::Table&)> check) {
+
+        const size_t nrows = values[0].size();
+        std::vector<odc::api::ConstStridedData> strides;
+        for (const auto& v : values) strides.emplace_back(&v[0], nrows, sizeof(double), sizeof(double));
+
+        odc::ODBAPISettings& settings(odc::ODBAPISettings::instance());
+        bool saved = (settings.*value)();
+
+        (settings.*setting)(enabled);
+        eckit::MemoryHandle dh;
+        dh.openForWrite(0);
+        odc::core::encodeFrame(dh, columns, strides, {});
+        (settings.*setting)(saved);
+
+        // The minor version follows the magic (5 bytes), byte order and major version.
+
+        int32_t minor;
+        ::memcpy(&minor, static_cast<const char*>(dh.data()) + 13, sizeof(minor));
+        EXPECT((minor == minorVersion) == enabled);
+
+        eckit::MemoryHandle in(dh.data(), size_t(dh.position()));
+        in.openForRead();
+        eckit::AutoClose closer(in);
+
+        odc::core::TablesReader reader(in);
+        auto it = reader.begin();
+        EXPECT(it->rowCount() == nrows);
+        check(*it);
+
+        std::vector<std::string> names;
+        std::vector<double> output(values.size() * nrows);
+        std::vector<odc::api::StridedData> outStrides;
+        for (size_t col = 0; col < values.size(); ++col) {
+            names.push_back(columns[col].name);
+            outStrides.emplace_back(&output[col * nrows], nrows, sizeof(double), sizeof(double));
+        }
+        odc::core::DecodeTarget target(names, outStrides);
+        it->decode(target);
+
+        for (size_t col = 0; col < values.size(); ++col) {
+            for (size_t row = 0; row < nrows; ++row) {
+                EXPECT(output[col * nrows + row] == values[col][row]);
+            }
+        }
+
+        return size_t(it->encodedDataSize());
+    }
+}
+
+CASE("Integer columns spanning up to 24 bits use the 24-bit codecs when enabled") {
+
+    const size_t nrows = 1000;
+    std::vector<std::vector<double>> values(2, std::vector<double>(nrows));
+    for (size_t row = 0; row < nrows; ++row) {
+        values[0][row] = double(1000000 + (row * 9973) % 5000000);
+        values[1][row] = (row % 5 == 0) ? odc::MDI::integerMDI() : -double(row * 16007);
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"wide",         odc::api::INTEGER, sizeof(double), {}},
+        {"wide_missing", odc::api::INTEGER, sizeof(double), {}},
+    };
+
+    for (bool int24 : {false, true}) {
+
+        size_t size = encodeWithSetting(&odc::ODBAPISettings::int24Codecs, &odc::ODBAPISettings::int24Codecs, int24,
+                                        odc::core::FORMAT_VERSION_NUMBER_MINOR_INT24, columns, values,
+                                        [int24](odc::core::Table& table) {
+            EXPECT(table.columns()[0]->coder().name() == (int24 ? "int24" : "int32"));
+            EXPECT(table.columns()[1]->coder().name() == (int24 ? "int24_missing" : "int32"));
+        });
+
+        // Every row starts with the two byte marker, and 4 or 3 bytes for each value
+
+        EXPECT(size <= nrows * (2 + 2 * (int24 ? 3 : 4)));
+    }
+}
+
+CASE("Correlated real values use the xor codec when enabled and smaller") {
+
+    const size_t nrows = 1000;
+    std::vector<std::vector<double>> values(3, std::vector<double>(nrows));
+    for (size_t row = 0; row < nrows; ++row) {
+        values[0][row] = 100000.0 - 2500.0 * (row % 30);
+        values[1][row] = 45.0 + 0.25 * (row % 100);
+        values[2][row] = std::sqrt(double(row + 2));
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"pressure", odc::api::DOUBLE, sizeof(double), {}},
+        {"lat",      odc::api::REAL,   sizeof(double), {}},
+        {"noise",    odc::api::DOUBLE, sizeof(double), {}},
+    };
+
+    std::vector<size_t> sizes;
+
+    for (bool xorReal : {false, true}) {
+
+        sizes.push_back(encodeWithSetting(&odc::ODBAPISettings::xorRealCodecs, &odc::ODBAPISettings::xorRealCodecs, xorReal,
+                                          odc::core::FORMAT_VERSION_NUMBER_MINOR_XOR_REAL, columns, values,
+                                          [xorReal](odc::core::Table& table) {
+            EXPECT(table.columns()[0]->coder().name() == (xorReal ? "xor_real" : "long_real"));
+            EXPECT(table.columns()[1]->coder().name() == (xorReal ? "xor_real" : "short_real2"));
+            EXPECT(table.columns()[2]->coder().name() == "long_real");
+            if (xorReal) {
+                EXPECT(table.columns()[0]->coder().encodedSize() < sizeof(double));
+                EXPECT(table.columns()[1]->coder().encodedSize() < sizeof(float));
+            }
+        }));
+    }
+
+    EXPECT(sizes[1] < sizes[0]);
+}
+
+CASE("Integer columns with few distinct values over a wide range use a dictionary when enabled") {
+
+    const size_t nrows = 1000;
+    const double codes[] = {1, 2, 110, 119, 1000000, 2000000};
+    std::vector<std::vector<double>> values(3, std::vector<double>(nrows));
+    for (size_t row = 0; row < nrows; ++row) {
+        values[0][row] = (row % 7 == 6) ? odc::MDI::integerMDI() : codes[row % 6];
+        values[1][row] = double(((row * 37) % 300) * 100003);
+        values[2][row] = double(row * 3);
+    }
+
+    std::vector<odc::api::ColumnInfo> columns {
+        {"varno", odc::api::INTEGER, sizeof(double), {}},
+        {"ident", odc::api::INTEGER, sizeof(double), {}},
+        {"seqno", odc::api::INTEGER, sizeof(double), {}},
+    };
+
+    std::vector<size_t> sizes;
+
+    for (bool dictionary : {false, true}) {
+
+        sizes.push_back(encodeWithSetting(&odc::ODBAPISettings::integerDictionaryCodecs,
+                                          &odc::ODBAPISettings::integerDictionaryCodecs, dictionary,
+                                          odc::core::FORMAT_VERSION_NUMBER_MINOR_INT_DICTIONARY, columns, values,
+                                          [dictionary](odc::core::Table& table) {
+            EXPECT(table.columns()[0]->coder().name() == (dictionary ? "int8_dictionary" : "int32"));
+            EXPECT(table.columns()[1]->coder().name() == (dictionary ? "int16_dictionary" : "int32"));
+
+            // A dictionary is only used if the indices are narrower than the plain integer codec
+
+            EXPECT(table.columns()[2]->coder().name() == "int16");
+        }));
+    }
+
+    EXPECT(sizes[1] < sizes[0]);
+}
+
+CASE("The codec optimizer trial-encodes a sample of each column when enabled") {
+
+    const size_t nrows = 1000;
+    std::vector<double> small(nrows);
+    std::vector<double> wide(nrows);
+    std::vector<double> real(nrows);
+    for (size_t row = 0; row < nrows; ++row) {
+        small[row] = double(row % 200);
+        wide[row] = double(row * 104729);
+        real[row] = double(float(row) / 7);
+    }
+
+    const std::vector<std::pair<std::string, odc::api::ColumnType>> columns {
+        {"small", odc::api::INTEGER},
+        {"wide",  odc::api::INTEGER},
+        {"real",  odc::api::REAL},
+    };
+    std::vector<odc::api::ConstStridedData> strides {
+        {&small[0], nrows, sizeof(double), sizeof(double)},
+        {&wide[0],  nrows, sizeof(double), sizeof(double)},
+        {&real[0],  nrows, sizeof(double), sizeof(double)},
+    };
+
+    // Columns with the statistics gathered, ready to be optimised
+
+    auto gathered = [&columns, &strides]() {
+        odc::core::MetaData md;
+        md.setSize(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            md[i]->name(columns[i].first);
+            md[i]->type<odc::core::SameByteOrder>(columns[i].second);
+            for (const char* d : strides[i]) md[i]->coder().gatherStats(*reinterpret_cast<const double*>(d));
+        }
+        return md;
+    };
+
+    odc::ODBAPISettings& settings(odc::ODBAPISettings::instance());
+    size_t saved = settings.codecSampleRows();
+    settings.codecSampleRows(50);
+
+    // By default the codecs are chosen by size, so the choices are unchanged. There are no
+    // alternatives to int32 for the wide column.
+
+    odc::core::MetaData md = gathered();
+    odc::codec::CodecOptimizer optimizer;
+    optimizer.setOptimalCodecs<odc::core::SameByteOrder>(md, strides);
+
+    const std::vector<odc::codec::CodecDecision>& decisions(optimizer.decisions());
+    EXPECT(decisions.size() == 3);
+    EXPECT(decisions[0].column == "small");
+    EXPECT(decisions[0].codec == "int8");
+    EXPECT(decisions[0].trials.size() == 2);
+    EXPECT(decisions[0].trials[0].codec == "int8");
+    EXPECT(decisions[0].trials[0].encodedSize == 1);
+    EXPECT(decisions[0].trials[1].codec == "int32");
+    EXPECT(decisions[0].trials[1].encodedSize == 4);
+    EXPECT(decisions[1].codec == "int32");
+    EXPECT(decisions[1].trials.empty());
+    EXPECT(decisions[2].codec == "short_real2");
+    EXPECT(decisions[2].trials.size() == 2);
+    EXPECT(decisions[2].trials[1].codec == "long_real");
+    EXPECT(md[0]->coder().name() == "int8");
+    EXPECT(md[2]->coder().name() == "short_real2");
+
+    std::ostringstream report;
+    optimizer.report(report);
+    EXPECT(report.str().find("small: int8") != std::string::npos);
+
+    // The cost model is pluggable
+
+    struct LargestCodec : public odc::codec::CodecCostModel {
+        LargestCodec() : CodecCostModel(1, 0) {}
+        double score(const odc::codec::CodecTrial& trial, size_t) const override { return -double(trial.encodedSize); }
+    };
+
+    md = gathered();
+    optimizer.costModel(std::unique_ptr<odc::codec::CodecCostModel>(new LargestCodec));
+    optimizer.setOptimalCodecs<odc::core::SameByteOrder>(md, strides);
+    EXPECT(md[0]->coder().name() == "int32");
+    EXPECT(md[2]->coder().name() == "long_real");
+
+    // And codecs may be chosen for the other byte order
+
+    odc::core::MetaData same = gathered();
+    odc::core::MetaData other = gathered();
+    odc::codec::CodecOptimizer().setOptimalCodecs<odc::core::SameByteOrder>(same, strides);
+    odc::codec::CodecOptimizer().setOptimalCodecs<odc::core::OtherByteOrder>(other, strides);
+    settings.codecSampleRows(saved);
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        EXPECT(same[i]->coder().name() == other[i]->coder().name());
+        size_t size = same[i]->coder().encodedSize();
+        EXPECT(other[i]->coder().encodedSize() == size);
+
+        char encodedSame[8];
+        char encodedOther[8];
+        EXPECT(same[i]->coder().encode(encodedSame, *reinterpret_cast<const double*>(strides[i][7])) == encodedSame + size);
+        EXPECT(other[i]->coder().encode(encodedOther, *reinterpret_cast<const double*>(strides[i][7])) == encodedOther + size);
+        std::reverse(encodedOther, encodedOther + size);
+        EXPECT(::memcmp(encodedSame, encodedOther, size) == 0);
+    }
+}
+
 // ------------------------------------------------------------------------------------------------------
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,366 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/MDI.h"
+#include "odc/api/ColumnInfo.h"
+#include "odc/api/Odb.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/RangeFilter.h"
+
+#include "GeneratedFrame.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const double intMissing = odc::MDI::integerMDI();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // A frame with an int8, int16, int8_missing, long_real and int8_string column. Runs of repeated
+    // values mean that rows start from a variety of columns, so that filter columns are often not
+    // encoded in a row.
+
+    class FilterFixture : public GeneratedFrame {
+
+    public: // methods
+
+        FilterFixture(size_t nrows) :
+            GeneratedFrame(nrows, {
+                {"int8@hdr",         odc::api::INTEGER, sizeof(double), {}},
+                {"int16@hdr",        odc::api::INTEGER, sizeof(double), {}},
+                {"int8_missing@hdr", odc::api::INTEGER, sizeof(double), {}},
+                {"long_real@body",   odc::api::DOUBLE,  sizeof(double), {}},
+                {"string@body",      odc::api::STRING,  sizeof(double), {}},
+            }, generate) {}
+
+        static void generate(size_t col, size_t row, char* p, size_t width) {
+
+            double v = 0;
+            switch (col) {
+            case 0: v = double(row % 200) - 50; break;
+            case 1: v = double((row * 31) % 60000); break;
+            case 2: v = (row % 4 == 0) ? intMissing : double(row % 100); break;
+            case 3: v = double(row) / 3; break;
+            case 4: ::snprintf(p, width, "s%zu", (row * 13) % 20); return;
+            }
+            ::memcpy(p, &v, sizeof(v));
+        }
+
+        /// Decode the rows that meet the conditions of the filter (and are selected), and check that the
+        /// output matches the rows of the source data for which the predicate holds.
+
+        void check(const odc::core::RangeFilter& filter, std::function<bool(size_t)> predicate, size_t blockSize,
+                   const char* selected=0) {
+
+            std::vector<std::vector<double>> output;
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+
+            for (const auto& col : columns_) {
+                output.emplace_back(nrows_, 0);
+                names.push_back(col.name);
+                strides.emplace_back(&output.back()[0], nrows_, sizeof(double), sizeof(double));
+            }
+
+            size_t decoded = 0;
+            decodeTable(blockSize, [&](odc::core::Table& table) {
+                odc::core::DecodeTarget target(names, strides);
+                decoded = table.decode(target, filter, selected);
+            });
+
+            size_t expected = 0;
+            for (size_t row = 0; row < nrows_; ++row) {
+                if (!predicate(row)) continue;
+                for (size_t col = 0; col < columns_.size(); ++col) {
+                    EXPECT(::memcmp(&output[col][expected], &data_[col][row * sizeof(double)], sizeof(double)) == 0);
+                }
+                ++expected;
+            }
+
+            EXPECT(decoded == expected);
+        }
+
+        double value(size_t col, size_t row) const {
+            double v;
+            ::memcpy(&v, &data_[col][row * sizeof(double)], sizeof(v));
+            return v;
+        }
+
+        std::string string(size_t row) const {
+            const char* s = &data_[4][row * sizeof(double)];
+            return std::string(s, ::strnlen(s, sizeof(double)));
+        }
+    };
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Rows are selected by conditions on offset integer columns") {
+
+    FilterFixture fixture(5000);
+
+    for (size_t blockSize : {1, 7, 4096}) {
+
+        odc::core::RangeFilter filter;
+        filter.addRange("int16", 1000.5, 20000);
+        fixture.check(filter, [&](size_t row) {
+            return fixture.value(1, row) >= 1001 && fixture.value(1, row) <= 20000;
+        }, blockSize);
+
+        odc::core::RangeFilter filter2;
+        filter2.addRange("int8@hdr", -inf, -40);
+        fixture.check(filter2, [&](size_t row) { return fixture.value(0, row) <= -40; }, blockSize);
+    }
+
+    // Bounds outside the range of the column
+
+    odc::core::RangeFilter none;
+    none.addRange("int16", 60000, inf);
+    fixture.check(none, [](size_t) { return false; }, 100);
+
+    odc::core::RangeFilter all;
+    all.addRange("int8", -1000, 1000);
+    fixture.check(all, [](size_t) { return true; }, 100);
+}
+
+CASE("Missing values match if the missing value meets the condition") {
+
+    FilterFixture fixture(5000);
+
+    odc::core::RangeFilter filter;
+    filter.addEquals("int8_missing", intMissing);
+    fixture.check(filter, [&](size_t row) { return fixture.value(2, row) == intMissing; }, 100);
+
+    odc::core::RangeFilter filter2;
+    filter2.addRange("int8_missing", 10, 20);
+    fixture.check(filter2, [&](size_t row) {
+        return fixture.value(2, row) >= 10 && fixture.value(2, row) <= 20;
+    }, 100);
+}
+
+CASE("Rows are selected by string and real conditions, combined") {
+
+    FilterFixture fixture(5000);
+
+    for (size_t blockSize : {1, 7, 4096}) {
+
+        odc::core::RangeFilter filter;
+        filter.addEquals("string", "s13");
+        fixture.check(filter, [&](size_t row) { return fixture.string(row) == "s13"; }, blockSize);
+
+        filter.addRange("long_real", 100, 1000);
+        filter.addRange("int16", 0, 30000);
+        fixture.check(filter, [&](size_t row) {
+            return fixture.string(row) == "s13" && fixture.value(3, row) >= 100 && fixture.value(3, row) <= 1000 &&
+                   fixture.value(1, row) <= 30000;
+        }, blockSize);
+    }
+
+    odc::core::RangeFilter none;
+    none.addEquals("string", "nothing");
+    fixture.check(none, [](size_t) { return false; }, 100);
+}
+
+CASE("Only the selected rows are decoded") {
+
+    FilterFixture fixture(5000);
+
+    std::vector<char> selected(5000, false);
+    for (size_t row = 3; row < 5000; row += 11) selected[row] = true;
+    for (size_t row = 4000; row < 4100; ++row) selected[row] = true;
+
+    for (size_t blockSize : {1, 7, 4096}) {
+
+        odc::core::RangeFilter unfiltered;
+        fixture.check(unfiltered, [&](size_t row) { return selected[row]; }, blockSize, &selected[0]);
+
+        odc::core::RangeFilter filter;
+        filter.addRange("int8", 0, 100);
+        fixture.check(filter, [&](size_t row) {
+            return selected[row] && fixture.value(0, row) >= 0 && fixture.value(0, row) <= 100;
+        }, blockSize, &selected[0]);
+    }
+}
+
+CASE("Conditions must match the type of the column") {
+
+    FilterFixture fixture(100);
+
+    odc::core::RangeFilter filter;
+    filter.addEquals("string", 1);
+    EXPECT_THROWS_AS(fixture.check(filter, [](size_t) { return false; }, 100), eckit::UserError);
+
+    odc::core::RangeFilter filter2;
+    filter2.addEquals("int8", "abc");
+    EXPECT_THROWS_AS(fixture.check(filter2, [](size_t) { return false; }, 100), eckit::UserError);
+
+    odc::core::RangeFilter filter3;
+    filter3.addEquals("nonexistent", 1);
+    EXPECT_THROWS_AS(fixture.check(filter3, [](size_t) { return false; }, 100), odc::core::ODBDecodeError);
+}
+
+CASE("The decoder packs the matching rows of aggregated frames") {
+
+    FilterFixture fixture(1000);
+
+    // Two copies of the same frame
+
+    eckit::MemoryHandle twice(2 * fixture.encodedSize());
+    twice.openForWrite(0);
+    twice.write(fixture.encoded().data(), fixture.encodedSize());
+    twice.write(fixture.encoded().data(), fixture.encodedSize());
+    twice.close();
+    twice.openForRead();
+    eckit::AutoClose closer(twice);
+
+    odc::api::Reader reader(twice, true);
+    odc::api::Frame frame = reader.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == 2000);
+
+    std::vector<double> int16(2000, 0);
+    std::vector<double> strings(2000, 0);
+    std::vector<std::string> names {"int16", "string"};
+    std::vector<odc::api::StridedData> strides {
+        {&int16[0], 2000, sizeof(double), sizeof(double)},
+        {&strings[0], 2000, sizeof(double), sizeof(double)},
+    };
+
+    odc::api::Decoder decoder(names, strides);
+    decoder.filterEquals("string", "s3");
+    decoder.filterRange("int16", 0, 40000);
+    size_t decoded = decoder.decode(frame);
+
+    std::vector<double> expected;
+    for (size_t row = 0; row < 1000; ++row) {
+        if (fixture.string(row) == "s3" && fixture.value(1, row) <= 40000) expected.push_back(fixture.value(1, row));
+    }
+
+    EXPECT(expected.size() > 0);
+    EXPECT(decoded == 2 * expected.size());
+    for (size_t i = 0; i < decoded; ++i) {
+        EXPECT(int16[i] == expected[i % expected.size()]);
+        EXPECT(::strncmp(reinterpret_cast<const char*>(&strings[i]), "s3", sizeof(double)) == 0);
+    }
+}
+
+CASE("String codes are shared by the tables of an aggregated frame") {
+
+    FilterFixture fixture(1000);
+
+    eckit::MemoryHandle twice(2 * fixture.encodedSize());
+    twice.openForWrite(0);
+    twice.write(fixture.encoded().data(), fixture.encodedSize());
+    twice.write(fixture.encoded().data(), fixture.encodedSize());
+    twice.close();
+    twice.openForRead();
+    eckit::AutoClose closer(twice);
+
+    odc::api::Reader reader(twice, true);
+    odc::api::Frame frame = reader.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == 2000);
+
+    std::vector<double> int16(2000, 0);
+    std::vector<int32_t> codes(2000, -1);
+    std::vector<std::string> names {"int16", "string"};
+    std::vector<odc::api::StridedData> strides {
+        {&int16[0], 2000, sizeof(double), sizeof(double)},
+        {&codes[0], 2000, sizeof(int32_t), sizeof(int32_t)},
+    };
+    std::vector<odc::api::DecodedType> types {odc::api::DECODED_DEFAULT, odc::api::DECODED_STRING_CODE};
+
+    std::set<std::string> distinct;
+    for (size_t row = 0; row < 1000; ++row) distinct.insert(fixture.string(row));
+
+    for (size_t nthreads : {1, 2}) {
+
+        odc::api::Decoder decoder(names, strides, types);
+        EXPECT(decoder.decode(frame, nthreads) == 2000);
+
+        const std::vector<std::string>& strings(decoder.strings(1));
+        EXPECT(strings.size() == distinct.size());
+        EXPECT(std::set<std::string>(strings.begin(), strings.end()) == distinct);
+        for (size_t row = 0; row < 2000; ++row) {
+            EXPECT(codes[row] >= 0 && size_t(codes[row]) < strings.size());
+            EXPECT(strings[codes[row]] == fixture.string(row % 1000));
+        }
+
+        EXPECT_THROWS_AS(decoder.strings(0), eckit::UserError);
+    }
+
+    // Codes are also decoded for the matching rows only
+
+    odc::api::Decoder decoder(names, strides, types);
+    decoder.filterEquals("string", "s3");
+    size_t decoded = decoder.decode(frame);
+    EXPECT(decoded > 0);
+    for (size_t i = 0; i < decoded; ++i) EXPECT(decoder.strings(1)[codes[i]] == "s3");
+
+    // String columns may only be decoded as characters or codes, and only string columns as codes
+
+    std::vector<odc::api::DecodedType> wrongTypes {odc::api::DECODED_STRING_CODE, odc::api::DECODED_INT32};
+    odc::api::Decoder wrong(names, strides, wrongTypes);
+    EXPECT_THROWS_AS(wrong.decode(frame), eckit::UserError);
+}
+
+CASE("The decoder decodes a list or mask of rows") {
+
+    FilterFixture fixture(1000);
+
+    eckit::MemoryHandle dh(fixture.encoded().data(), fixture.encodedSize());
+    dh.openForRead();
+    eckit::AutoClose closer(dh);
+
+    odc::api::Reader reader(dh, false);
+    odc::api::Frame frame = reader.next();
+    EXPECT(frame);
+
+    std::vector<double> int16(1000, 0);
+    std::vector<std::string> names {"int16"};
+    std::vector<odc::api::StridedData> strides {{&int16[0], 1000, sizeof(double), sizeof(double)}};
+    odc::api::Decoder decoder(names, strides);
+
+    std::vector<size_t> rows {0, 1, 17, 500, 999};
+    EXPECT(decoder.decode(frame, rows) == rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) EXPECT(int16[i] == fixture.value(1, rows[i]));
+
+    std::vector<bool> mask(1000, false);
+    for (size_t row : rows) mask[row] = true;
+    std::fill(int16.begin(), int16.end(), 0);
+    EXPECT(decoder.decode(frame, mask) == rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) EXPECT(int16[i] == fixture.value(1, rows[i]));
+
+    std::vector<size_t> unsorted {5, 4};
+    std::vector<size_t> outOfRange {1000};
+    EXPECT_THROWS_AS(decoder.decode(frame, unsorted), eckit::UserError);
+    EXPECT_THROWS_AS(decoder.decode(frame, outOfRange), eckit::UserError);
+    EXPECT_THROWS_AS(decoder.decode(frame, std::vector<bool>(10, true)), eckit::UserError);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
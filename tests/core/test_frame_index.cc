@@ -0,0 +1,270 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <sys/stat.h>
+#include <utime.h>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/ODBAPISettings.h"
+#include "odc/Writer.h"
+#include "odc/api/ColumnInfo.h"
+#include "odc/api/Odb.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/FrameIndex.h"
+#include "odc/core/TablesReader.h"
+
+#include "../TemporaryFiles.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t numTables = 12;
+
+    // Write a file containing tables with two alternating schemas, and varying numbers of rows
+
+    class FrameIndexFile : public TemporaryFile {
+
+    public: // methods
+
+        FrameIndexFile() {
+            eckit::FileHandle fh(path());
+            fh.openForWrite(0);
+            eckit::AutoClose closer(fh);
+            for (size_t t = 0; t < numTables; ++t) appendTable(fh, t);
+        }
+
+        ~FrameIndexFile() {
+            eckit::PathName index(odc::core::FrameIndex::indexPath(path()));
+            if (index.exists()) index.unlink();
+        }
+
+        static size_t rowCount(size_t t) { return 100 + 37 * t; }
+
+        static void appendTable(eckit::DataHandle& dh, size_t t) {
+
+            std::vector<odc::api::ColumnInfo> columns {
+                {"table", odc::api::INTEGER, sizeof(double), {}},
+                {"value", odc::api::REAL,    sizeof(double), {}},
+            };
+            if (t % 2) columns.push_back({"extra", odc::api::DOUBLE, sizeof(double), {}});
+
+            size_t nrows = rowCount(t);
+            std::vector<double> table(nrows, t);
+            std::vector<double> values(nrows);
+            for (size_t row = 0; row < nrows; ++row) values[row] = double(t) - double(row);
+
+            std::vector<odc::api::ConstStridedData> strides {
+                {&table[0], nrows, sizeof(double), sizeof(double)},
+                {&values[0], nrows, sizeof(double), sizeof(double)},
+            };
+            if (t % 2) strides.emplace_back(&values[0], nrows, sizeof(double), sizeof(double));
+
+            odc::core::encodeFrame(dh, columns, strides, {});
+        }
+    };
+
+    // Write rows through the legacy writer, which saves a frame index if enabled
+
+    void writeRows(odc::WriterBufferingIterator& it, size_t nrows) {
+        it.setNumberOfColumns(1);
+        it.setColumn(0, "value", odc::api::INTEGER);
+        it.writeHeader();
+        for (size_t row = 0; row < nrows; ++row) {
+            it.data()[0] = row;
+            it.next();
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("A saved frame index matches the headers of the data") {
+
+    FrameIndexFile file;
+
+    odc::core::FrameIndex scanned;
+    scanned.scan(file.path());
+    scanned.save(file.path());
+
+    odc::core::FrameIndex index;
+    EXPECT(index.load(file.path()));
+    EXPECT(index.frameCount() == numTables);
+    EXPECT(index.dataSize() == file.path().size());
+
+    size_t totalRows = 0;
+    size_t t = 0;
+    odc::core::TablesReader reader(file.path());
+    for (const auto& table : reader) {
+
+        const odc::core::FrameIndex::Frame& frame(index.frame(t));
+        EXPECT(frame.offset == table.startPosition());
+        EXPECT(frame.length == table.nextPosition() - table.startPosition());
+        EXPECT(frame.rowCount == FrameIndexFile::rowCount(t));
+        EXPECT(frame.schema == (t % 2));
+
+        const odc::core::FrameIndex::Schema& schema(index.schema(frame.schema));
+        EXPECT(schema.fingerprint == odc::core::FrameIndex::fingerprint(table.columns()));
+        EXPECT(schema.names.size() == table.columnCount());
+        EXPECT(schema.names[1] == "value");
+        EXPECT(schema.types[1] == odc::api::REAL);
+
+        EXPECT(frame.ranges.size() == table.columnCount());
+        EXPECT(frame.ranges[0].min == t);
+        EXPECT(frame.ranges[0].max == t);
+        EXPECT(frame.ranges[1].min == double(t) - double(frame.rowCount - 1));
+        EXPECT(frame.ranges[1].max == t);
+
+        totalRows += table.rowCount();
+        ++t;
+    }
+
+    EXPECT(t == numTables);
+    EXPECT(index.rowCount() == totalRows);
+}
+
+CASE("An out of date frame index is ignored") {
+
+    FrameIndexFile file;
+
+    odc::core::FrameIndex index;
+    EXPECT(!index.load(file.path()));
+
+    index.scan(file.path());
+    index.save(file.path());
+    size_t rows = index.rowCount();
+
+    {
+        eckit::FileHandle fh(file.path());
+        fh.openForAppend(0);
+        eckit::AutoClose closer(fh);
+        FrameIndexFile::appendTable(fh, numTables);
+    }
+
+    EXPECT(!index.load(file.path()));
+    EXPECT(index.frameCount() == 0);
+
+    odc::core::FrameIndex rescanned(odc::core::FrameIndex::forFile(file.path()));
+    EXPECT(rescanned.frameCount() == numTables + 1);
+    EXPECT(rescanned.rowCount() == rows + FrameIndexFile::rowCount(numTables));
+}
+
+CASE("A frame index is ignored if the data is rewritten without changing its size or time") {
+
+    FrameIndexFile file;
+
+    odc::core::FrameIndex index;
+    index.scan(file.path());
+    index.save(file.path());
+    EXPECT(index.load(file.path()));
+
+    // Modify the header checksum of the last frame in place, and then restore the modification time
+
+    struct stat st;
+    EXPECT(::stat(file.path().localPath(), &st) == 0);
+
+    {
+        std::fstream f(file.path().localPath(), std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(size_t(index.frame(numTables - 1).offset) + 24);
+        f.put('X');
+    }
+
+    struct utimbuf times {st.st_atime, st.st_mtime};
+    EXPECT(::utime(file.path().localPath(), &times) == 0);
+
+    EXPECT(file.path().size() == index.dataSize());
+    EXPECT(!index.load(file.path()));
+    EXPECT(index.frameCount() == 0);
+}
+
+CASE("Writers do not index files that they append to") {
+
+    TemporaryFile file;
+    eckit::PathName indexPath(odc::core::FrameIndex::indexPath(file.path()));
+
+    odc::ODBAPISettings::instance().writeFrameIndex(true);
+
+    {
+        odc::Writer<> oda(file.path());
+        std::unique_ptr<odc::WriterBufferingIterator> it(oda.createWriteIterator(file.path()));
+        writeRows(*it, 10);
+    }
+
+    odc::core::FrameIndex index;
+    EXPECT(index.load(file.path()));
+    EXPECT(index.rowCount() == 10);
+
+    std::ifstream saved(indexPath.localPath(), std::ios::binary);
+    std::string original((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+
+    // The frames appended are located relative to the start of the writing, so cannot be indexed.
+    // The existing index is left untouched, and is out of date.
+
+    {
+        odc::Writer<> oda(file.path());
+        std::unique_ptr<odc::WriterBufferingIterator> it(oda.createWriteIterator(file.path(), true));
+        writeRows(*it, 5);
+    }
+
+    odc::ODBAPISettings::instance().writeFrameIndex(false);
+
+    std::ifstream unchanged(indexPath.localPath(), std::ios::binary);
+    EXPECT(std::string((std::istreambuf_iterator<char>(unchanged)), std::istreambuf_iterator<char>()) == original);
+
+    EXPECT(!index.load(file.path()));
+    EXPECT(odc::core::FrameIndex::forFile(file.path()).rowCount() == 15);
+
+    if (indexPath.exists()) indexPath.unlink();
+}
+
+CASE("Seeking to a frame gives the same frame with and without an index") {
+
+    FrameIndexFile file;
+
+    for (bool indexed : {false, true}) {
+
+        if (indexed) {
+            odc::core::FrameIndex index;
+            index.scan(file.path());
+            index.save(file.path());
+        }
+
+        bool aggregated = false;
+        odc::api::Reader reader(file.path(), aggregated);
+        odc::core::FrameIndex index(odc::core::FrameIndex::forFile(file.path()));
+
+        for (size_t n : {7, 2, 11}) {
+            reader.seekFrame(n);
+            odc::api::Frame frame = reader.next();
+            EXPECT(frame);
+            EXPECT(frame.rowCount() == FrameIndexFile::rowCount(n));
+            EXPECT(frame.offset() == index.frame(n).offset);
+        }
+
+        reader.seekFrame(numTables);
+        EXPECT(!reader.next());
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,168 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/HeaderCache.h"
+#include "odc/core/TablesReader.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t numTables = 20;
+
+    const std::vector<odc::api::ColumnInfo> columns {
+        {"int",    odc::api::INTEGER, sizeof(double), {}},
+        {"real",   odc::api::REAL,    sizeof(double), {}},
+        {"string", odc::api::STRING,  sizeof(double), {}},
+    };
+
+    // Encode tables with different numbers of rows, but the same ranges of values (and strings), so
+    // that the headers only differ in their sizes. If alternate is set, every other table has an
+    // extra column.
+
+    void encodeTables(eckit::MemoryHandle& dh, bool alternate=false) {
+
+        dh.openForWrite(0);
+        eckit::AutoClose closer(dh);
+
+        for (size_t t = 0; t < numTables; ++t) {
+
+            size_t nrows = 200 * (t + 1);
+            size_t ncols = (alternate && (t % 2)) ? 2 : 3;
+
+            std::vector<double> ints(nrows);
+            std::vector<double> reals(nrows);
+            std::vector<double> strings(nrows);
+            for (size_t row = 0; row < nrows; ++row) {
+                ints[row] = double(row % 100);
+                reals[row] = double(row % 50) / 4;
+                ::snprintf(reinterpret_cast<char*>(&strings[row]), sizeof(double), "s%zu", row % 40);
+            }
+
+            std::vector<odc::api::ColumnInfo> cols(columns.begin(), columns.begin() + ncols);
+            std::vector<odc::api::ConstStridedData> strides {
+                {&ints[0], nrows, sizeof(double), sizeof(double)},
+                {&reals[0], nrows, sizeof(double), sizeof(double)},
+                {&strings[0], nrows, sizeof(double), sizeof(double)},
+            };
+            strides.resize(ncols);
+
+            odc::core::encodeFrame(dh, cols, strides, {});
+        }
+    }
+
+    // Decode all of the tables, returning the decoded values
+
+    std::vector<std::vector<double>> decodeTables(eckit::MemoryHandle& encoded) {
+
+        eckit::MemoryHandle dh(encoded.data(), encoded.position());
+        dh.openForRead();
+        eckit::AutoClose closer(dh);
+
+        std::vector<std::vector<double>> output;
+
+        odc::core::TablesReader reader(dh);
+        for (auto& table : reader) {
+
+            size_t nrows = table.rowCount();
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+
+            output.emplace_back(nrows * table.columnCount());
+            for (size_t col = 0; col < table.columnCount(); ++col) {
+                names.push_back(table.columns()[col]->name());
+                strides.emplace_back(&output.back()[col * nrows], nrows, sizeof(double), sizeof(double));
+            }
+
+            odc::core::DecodeTarget target(names, strides);
+            table.decode(target);
+        }
+
+        return output;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Tables whose headers differ only in size share a cached header") {
+
+    odc::core::HeaderCache& cache(odc::core::HeaderCache::instance());
+    size_t savedCapacity = cache.capacity();
+
+    eckit::MemoryHandle encoded;
+    encodeTables(encoded);
+
+    cache.capacity(0);
+    std::vector<std::vector<double>> reference = decodeTables(encoded);
+    EXPECT(reference.size() == numTables);
+
+    cache.clear();
+    cache.capacity(16);
+    EXPECT(decodeTables(encoded) == reference);
+    EXPECT(cache.misses() == 1);
+    EXPECT(cache.hits() == numTables - 1);
+
+    // Subsequent reads of the same data are decoded entirely from the cache
+
+    EXPECT(decodeTables(encoded) == reference);
+    EXPECT(cache.misses() == 1);
+    EXPECT(cache.hits() == 2 * numTables - 1);
+
+    cache.clear();
+    cache.capacity(savedCapacity);
+}
+
+CASE("The least recently used headers are evicted") {
+
+    odc::core::HeaderCache& cache(odc::core::HeaderCache::instance());
+    size_t savedCapacity = cache.capacity();
+
+    eckit::MemoryHandle encoded;
+    encodeTables(encoded, true);
+
+    cache.capacity(0);
+    std::vector<std::vector<double>> reference = decodeTables(encoded);
+
+    // With alternating headers, a single entry is always evicted before it is used again
+
+    cache.clear();
+    cache.capacity(1);
+    EXPECT(decodeTables(encoded) == reference);
+    EXPECT(cache.hits() == 0);
+    EXPECT(cache.misses() == numTables);
+
+    cache.clear();
+    cache.capacity(2);
+    EXPECT(decodeTables(encoded) == reference);
+    EXPECT(cache.hits() == numTables - 2);
+    EXPECT(cache.misses() == 2);
+
+    cache.clear();
+    cache.capacity(savedCapacity);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,191 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/Checksum.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/Exceptions.h"
+#include "odc/core/Header.h"
+#include "odc/core/HeaderCache.h"
+#include "odc/core/TablesReader.h"
+#include "odc/ODBAPISettings.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t nrows = 1000;
+
+    // Encode a single table, with or without the fast header checksum
+
+    std::vector<char> encodeTable(bool fastChecksum) {
+
+        odc::ODBAPISettings& settings(odc::ODBAPISettings::instance());
+        bool saved = settings.fastHeaderChecksum();
+        settings.fastHeaderChecksum(fastChecksum);
+
+        std::vector<odc::api::ColumnInfo> columns {
+            {"int",  odc::api::INTEGER, sizeof(double), {}},
+            {"real", odc::api::REAL,    sizeof(double), {}},
+        };
+
+        std::vector<double> ints(nrows);
+        std::vector<double> reals(nrows);
+        for (size_t row = 0; row < nrows; ++row) {
+            ints[row] = double(row);
+            reals[row] = double(row) / 8;
+        }
+
+        std::vector<odc::api::ConstStridedData> strides {
+            {&ints[0], nrows, sizeof(double), sizeof(double)},
+            {&reals[0], nrows, sizeof(double), sizeof(double)},
+        };
+
+        eckit::MemoryHandle dh;
+        dh.openForWrite(0);
+        {
+            eckit::AutoClose closer(dh);
+            odc::core::encodeFrame(dh, columns, strides, {{"origin", "checksum test"}});
+        }
+
+        settings.fastHeaderChecksum(saved);
+
+        const char* data = static_cast<const char*>(dh.data());
+        return std::vector<char>(data, data + size_t(dh.position()));
+    }
+
+    // The format version minor number follows the magic (5 bytes) and byte order/major version
+
+    int32_t formatVersionMinor(const std::vector<char>& encoded) {
+        int32_t minor;
+        ::memcpy(&minor, &encoded[13], sizeof(minor));
+        return minor;
+    }
+
+    std::vector<double> decodeTable(const std::vector<char>& encoded) {
+
+        // Ensure that the header is parsed (and verified) every time
+
+        odc::core::HeaderCache::instance().clear();
+
+        eckit::MemoryHandle dh(&encoded[0], encoded.size());
+        dh.openForRead();
+        eckit::AutoClose closer(dh);
+
+        std::vector<double> output;
+
+        odc::core::TablesReader reader(dh);
+        for (auto& table : reader) {
+
+            EXPECT(table.properties().at("origin") == "checksum test");
+
+            std::vector<std::string> names;
+            std::vector<odc::api::StridedData> strides;
+            size_t offset = output.size();
+            output.resize(offset + table.rowCount() * table.columnCount());
+
+            for (size_t col = 0; col < table.columnCount(); ++col) {
+                names.push_back(table.columns()[col]->name());
+                strides.emplace_back(&output[offset + col * table.rowCount()], table.rowCount(),
+                                     sizeof(double), sizeof(double));
+            }
+
+            odc::core::DecodeTarget target(names, strides);
+            table.decode(target);
+        }
+
+        return output;
+    }
+
+    // Change a character in the value of the table property
+
+    void corruptHeader(std::vector<char>& encoded) {
+        const char property[] = "checksum test";
+        auto it = std::search(encoded.begin(), encoded.end(), property, property + ::strlen(property));
+        ASSERT(it != encoded.end());
+        *it = 'C';
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("xxHash64 matches the reference values") {
+
+    EXPECT(odc::core::xxHash64("", 0) == 0xEF46DB3751D8E999ULL);
+    EXPECT(odc::core::xxHash64("abc", 3) == 0x44BC2CF5AD770999ULL);
+
+    const char* longer = "Nobody inspects the spammish repetition";
+    EXPECT(odc::core::xxHash64(longer, ::strlen(longer)) == 0xFBCEA83C8A378BF1ULL);
+}
+
+CASE("Headers with either checksum decode identically") {
+
+    std::vector<char> md5 = encodeTable(false);
+    std::vector<char> fast = encodeTable(true);
+
+    EXPECT(formatVersionMinor(md5) == odc::core::FORMAT_VERSION_NUMBER_MINOR_MD5);
+    EXPECT(formatVersionMinor(fast) == odc::core::FORMAT_VERSION_NUMBER_MINOR_XXH64);
+
+    // The fixed 8-byte checksum replaces the 32 character digest
+
+    EXPECT(md5.size() == fast.size() + 24);
+
+    std::vector<double> values = decodeTable(md5);
+    EXPECT(values.size() == 2 * nrows);
+    EXPECT(values[nrows - 1] == nrows - 1);
+    EXPECT(values[2 * nrows - 1] == double(nrows - 1) / 8);
+    EXPECT(decodeTable(fast) == values);
+}
+
+CASE("Corrupted headers are detected unless the input is trusted") {
+
+    odc::ODBAPISettings& settings(odc::ODBAPISettings::instance());
+    bool savedTrusted = settings.trustedInput();
+
+    for (bool fastChecksum : {false, true}) {
+
+        std::vector<char> encoded = encodeTable(fastChecksum);
+        corruptHeader(encoded);
+
+        settings.trustedInput(false);
+        EXPECT_THROWS_AS(decodeTable(encoded), odc::core::ODBInvalid);
+
+        // n.b. The corruption is in the properties, so the data remains readable
+
+        settings.trustedInput(true);
+        eckit::MemoryHandle dh(&encoded[0], encoded.size());
+        dh.openForRead();
+        eckit::AutoClose closer(dh);
+        odc::core::TablesReader reader(dh);
+        auto it = reader.begin();
+        EXPECT(it != reader.end());
+        EXPECT(it->properties().at("origin") == "Checksum test");
+        EXPECT(it->rowCount() == nrows);
+    }
+
+    settings.trustedInput(savedTrusted);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -120,6 +120,76 @@ CASE("Test all-missing first row with Decoder integers-as-integers") {
     EXPECT(!reader.next());
 }
 
+CASE("Test all-missing first row with filtered Decoder") {
+
+    odc::api::Reader reader("odb_533_1.odb", /* aggregated */ false);
+    odc::api::Frame frame = reader.next();
+
+    constexpr size_t nrows = 2;
+    char stringvals[nrows][8];
+    double intvals[nrows];
+    double doublevals[nrows];
+
+    std::vector<std::string> columns { "doubleval", "intval", "stringval" };
+    std::vector<odc::api::StridedData> strides {
+            {doublevals, nrows, sizeof(doublevals[0]), sizeof(doublevals[0])},
+            {intvals,    nrows, sizeof(intvals[0]),    sizeof(intvals[0])},
+            {stringvals, nrows, sizeof(stringvals[0]), sizeof(stringvals[0])},
+    };
+
+    // The columns that are not encoded in the first row match the missing value
+
+    odc::api::Decoder missing(columns, strides);
+    missing.filterEquals("doubleval", odc::api::Settings::doubleMissingValue());
+    EXPECT(missing.decode(frame) == 1);
+
+    EXPECT(::memcmp(stringvals[0], "\0\0\0\0\0\0\0\0", 8) == 0);
+    EXPECT(intvals[0] == odc::api::Settings::integerMissingValue());
+    EXPECT(doublevals[0] == odc::api::Settings::doubleMissingValue());
+
+    odc::api::Decoder present(columns, strides);
+    present.filterEquals("stringval", "testing");
+    EXPECT(present.decode(frame) == 1);
+
+    EXPECT(::memcmp(stringvals[0], "testing\0", 8) == 0);
+    EXPECT(intvals[0] == 12345678);
+    EXPECT(doublevals[0] == 9876.54);
+}
+
+CASE("Test all-missing first row with Decoder row selection") {
+
+    odc::api::Reader reader("odb_533_1.odb", /* aggregated */ false);
+    odc::api::Frame frame = reader.next();
+
+    constexpr size_t nrows = 2;
+    char stringvals[nrows][8];
+    double intvals[nrows];
+    double realvals[nrows];
+
+    std::vector<std::string> columns { "realval", "intval", "stringval" };
+    std::vector<odc::api::StridedData> strides {
+            {realvals,   nrows, sizeof(realvals[0]),   sizeof(realvals[0])},
+            {intvals,    nrows, sizeof(intvals[0]),    sizeof(intvals[0])},
+            {stringvals, nrows, sizeof(stringvals[0]), sizeof(stringvals[0])},
+    };
+
+    odc::api::Decoder decoder(columns, strides);
+
+    EXPECT(decoder.decode(frame, std::vector<size_t>{0}) == 1);
+    EXPECT(::memcmp(stringvals[0], "\0\0\0\0\0\0\0\0", 8) == 0);
+    EXPECT(intvals[0] == odc::api::Settings::integerMissingValue());
+    EXPECT(realvals[0] == odc::api::Settings::doubleMissingValue());
+
+    EXPECT(decoder.decode(frame, std::vector<size_t>{1}) == 1);
+    EXPECT(::memcmp(stringvals[0], "testing\0", 8) == 0);
+    EXPECT(intvals[0] == 12345678);
+    EXPECT(realvals[0] == 1234.56);
+
+    EXPECT(decoder.decode(frame, std::vector<bool>{true, true}) == 2);
+    EXPECT(intvals[0] == odc::api::Settings::integerMissingValue());
+    EXPECT(intvals[1] == 12345678);
+}
+
 CASE("Test some-missing first row with Decoder integers-as-doubles") {
 
     odc::api::Reader reader("odb_533_2.odb", /* aggregated */ false);
@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/core/PositionalFileHandle.h"
+#include "odc/core/ThreadSharedDataHandle.h"
+
+#include "../TemporaryFiles.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t fileSize = 1024 * 1024 + 123;
+
+    char expected(size_t position) { return char((position * 7) % 251); }
+
+    // Write a file in which each byte is determined by its position
+
+    class PatternFile : public TemporaryFile {
+
+    public: // methods
+
+        PatternFile() {
+            std::vector<char> data(fileSize);
+            for (size_t i = 0; i < fileSize; ++i) data[i] = expected(i);
+
+            eckit::FileHandle fh(path());
+            fh.openForWrite(0);
+            eckit::AutoClose closer(fh);
+            fh.write(&data[0], data.size());
+        }
+    };
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Local files are opened for positional reads") {
+
+    PatternFile file;
+
+    std::unique_ptr<eckit::DataHandle> dh(odc::core::PositionalFileHandle::open(file.path()));
+    EXPECT(dynamic_cast<odc::core::PositionalFileHandle*>(dh.get()) != 0);
+}
+
+CASE("Readers in multiple threads share one positional file handle") {
+
+    PatternFile file;
+
+    odc::core::ThreadSharedDataHandle shared(odc::core::PositionalFileHandle::open(file.path()));
+    EXPECT(size_t(shared.estimate()) == fileSize);
+
+    const size_t numThreads = 8;
+    std::vector<size_t> errors(numThreads, 0);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&shared, &errors, t] {
+
+            // Each reader has its own position, and mixes small (buffered) reads with large ones.
+            // The final reads run past the end of the file.
+
+            odc::core::ThreadSharedDataHandle dh(shared);
+            std::vector<char> buffer(200 * 1024);
+
+            for (size_t i = 0; i < 200; ++i) {
+                size_t position = (t * 104729 + i * 7919) % fileSize;
+                if (i >= 195) position = fileSize - 10 - (i - 195);
+                size_t length = (i % 3 == 0) ? buffer.size() : 1 + (i * 31) % 4000;
+
+                dh.seek(position);
+                size_t count = 0;
+                while (count < length) {
+                    long n = dh.read(&buffer[count], length - count);
+                    if (n <= 0) break;
+                    count += n;
+                }
+
+                if (count != std::min(length, fileSize - position)) ++errors[t];
+                for (size_t j = 0; j < count; ++j) {
+                    if (buffer[j] != expected(position + j)) { ++errors[t]; break; }
+                }
+                if (size_t(dh.position()) != position + count) ++errors[t];
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+    for (size_t t = 0; t < numThreads; ++t) EXPECT(errors[t] == 0);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,240 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <limits>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/api/ColumnInfo.h"
+#include "odc/api/Odb.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/RangeFilter.h"
+#include "odc/core/TablesReader.h"
+#include "odc/sql/WhereFilter.h"
+#include "odc/MDI.h"
+#include "odc/Reader.h"
+
+#include "../TemporaryFiles.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t numTables = 6;
+    const size_t numRows = 10;
+
+    // Table t has andate 20200101 + t, obstype alternating between t and t + 10, and obsvalue
+    // t * 100 + 1.5 * row. Half of the obsvalues in table 4, and all of them in table 5, are missing.
+
+    class RangeFilterFile : public TemporaryFile {
+
+    public: // methods
+
+        RangeFilterFile() {
+            eckit::FileHandle fh(path());
+            fh.openForWrite(0);
+            eckit::AutoClose closer(fh);
+
+            std::vector<odc::api::ColumnInfo> columns {
+                {"andate@hdr",    odc::api::INTEGER, sizeof(double), {}},
+                {"obstype@hdr",   odc::api::INTEGER, sizeof(double), {}},
+                {"obsvalue@body", odc::api::REAL,    sizeof(double), {}},
+            };
+
+            for (size_t t = 0; t < numTables; ++t) {
+
+                std::vector<double> andate(numRows, 20200101 + t);
+                std::vector<double> obstype(numRows);
+                std::vector<double> obsvalue(numRows);
+                for (size_t row = 0; row < numRows; ++row) {
+                    obstype[row] = t + 10 * (row % 2);
+                    obsvalue[row] = (t == 5 || (t == 4 && row % 2)) ? odc::MDI::realMDI() : (t * 100 + 1.5 * row);
+                }
+
+                std::vector<odc::api::ConstStridedData> strides {
+                    {&andate[0], numRows, sizeof(double), sizeof(double)},
+                    {&obstype[0], numRows, sizeof(double), sizeof(double)},
+                    {&obsvalue[0], numRows, sizeof(double), sizeof(double)},
+                };
+
+                odc::core::encodeFrame(fh, columns, strides, {});
+            }
+        }
+
+        /// The index of each frame returned by the reader
+        std::vector<size_t> frames(odc::api::Reader& reader) const {
+
+            std::vector<eckit::Offset> offsets;
+            odc::core::TablesReader tables(path());
+            for (const auto& table : tables) offsets.push_back(table.startPosition());
+
+            std::vector<size_t> found;
+            odc::api::Frame frame;
+            while ((frame = reader.next())) {
+                for (size_t t = 0; t < offsets.size(); ++t) {
+                    if (offsets[t] == frame.offset()) found.push_back(t);
+                }
+            }
+            return found;
+        }
+    };
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Frames whose header statistics exclude the conditions are skipped") {
+
+    RangeFilterFile file;
+    bool aggregated = false;
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterRange("andate", 20200102, 20200103);
+        EXPECT(file.frames(reader) == std::vector<size_t>({1, 2}));
+    }
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("obstype@hdr", 12);
+        EXPECT(file.frames(reader) == std::vector<size_t>({2, 3, 4, 5}));
+    }
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("obstype", 12);
+        reader.filterRange("andate", 20200101, 20200103);
+        EXPECT(file.frames(reader) == std::vector<size_t>({2}));
+    }
+
+    // Values between the minimum and maximum may be present
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("obstype", 7);
+        EXPECT(file.frames(reader) == std::vector<size_t>({0, 1, 2, 3, 4, 5}));
+    }
+
+    // Conditions on columns that are not present are ignored
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("nonexistent", 1);
+        EXPECT(file.frames(reader) == std::vector<size_t>({0, 1, 2, 3, 4, 5}));
+    }
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("andate", 20200199);
+        EXPECT(!reader.next());
+    }
+}
+
+CASE("Aggregated frames only include the tables that meet the conditions") {
+
+    RangeFilterFile file;
+    bool aggregated = true;
+
+    odc::api::Reader reader(file.path(), aggregated);
+    reader.filterRange("andate", 20200102, 20200104);
+
+    odc::api::Frame frame = reader.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == 3 * numRows);
+    EXPECT(!reader.next());
+
+    // The row limit applies to the tables that meet the conditions
+
+    odc::api::Reader reader2(file.path(), aggregated, 2 * numRows);
+    reader2.filterRange("obsvalue", 0, 250);
+
+    frame = reader2.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == 2 * numRows);
+    frame = reader2.next();
+    EXPECT(frame);
+    EXPECT(frame.rowCount() == numRows);
+    EXPECT(!reader2.next());
+}
+
+CASE("Missing values are accounted for when skipping frames") {
+
+    RangeFilterFile file;
+    bool aggregated = false;
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterRange("obsvalue", 0, 1e6);
+        EXPECT(file.frames(reader) == std::vector<size_t>({0, 1, 2, 3, 4}));
+    }
+
+    {
+        odc::api::Reader reader(file.path(), aggregated);
+        reader.filterEquals("obsvalue", odc::MDI::realMDI());
+        EXPECT(file.frames(reader) == std::vector<size_t>({4, 5}));
+    }
+}
+
+CASE("The row by row reader skips excluded tables after the first") {
+
+    RangeFilterFile file;
+
+    odc::core::RangeFilter filter;
+    filter.addEquals("andate", 20200104);
+
+    odc::Reader reader(file.path());
+    reader.rangeFilter(filter);
+
+    size_t rows = 0;
+    std::vector<double> dates;
+    for (auto it = reader.begin(); it != reader.end(); ++it) {
+        if (dates.empty() || dates.back() != (*it)[0]) dates.push_back((*it)[0]);
+        ++rows;
+    }
+
+    EXPECT(rows == 2 * numRows);
+    EXPECT(dates == std::vector<double>({20200101, 20200104}));
+}
+
+CASE("Simple conditions are extracted from the WHERE clause") {
+
+    const double inf = std::numeric_limits<double>::infinity();
+
+    odc::core::RangeFilter filter = odc::sql::whereFilter(
+        "select * where andate between 20200101 and 20200131 and obstype = 7 "
+        "and 5 < lat and lon <= -3.5e1 and (a = 1 or b = 2) and c = d and flag.x@body = 1 order by x;");
+
+    const auto& conditions(filter.conditions());
+    EXPECT(conditions.size() == 4);
+    EXPECT(conditions[0].column == "andate" && conditions[0].min == 20200101 && conditions[0].max == 20200131);
+    EXPECT(conditions[1].column == "obstype" && conditions[1].min == 7 && conditions[1].max == 7);
+    EXPECT(conditions[2].column == "lat" && conditions[2].min == 5 && conditions[2].max == inf);
+    EXPECT(conditions[3].column == "lon" && conditions[3].min == -inf && conditions[3].max == -35);
+
+    EXPECT(odc::sql::whereFilter("SELECT x FROM \"in.odb\" WHERE Obstype@hdr == 7").conditions().size() == 1);
+
+    // Conditions that may not hold for every row are not used
+
+    EXPECT(odc::sql::whereFilter("select * where obstype = 7 or andate = 1").empty());
+    EXPECT(odc::sql::whereFilter("select * where obstype not between 1 and 2").empty());
+    EXPECT(odc::sql::whereFilter("select * from a, b where obstype = 7").empty());
+    EXPECT(odc::sql::whereFilter("select * where obstype in (select x where y = 2)").empty());
+    EXPECT(odc::sql::whereFilter("select * where obstype = 7 + 1").empty());
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,177 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/ODBAPISettings.h"
+#include "odc/api/ColumnInfo.h"
+#include "odc/core/DecodeTarget.h"
+#include "odc/core/Encoder.h"
+#include "odc/core/TablesReader.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    const size_t numTables = 40;
+    const size_t rowsPerTable = 500;
+
+    // Encode a sequence of tables, each containing values that identify the table and row
+
+    size_t encodeTables(eckit::MemoryHandle& dh) {
+
+        std::vector<odc::api::ColumnInfo> columns {
+            {"table", odc::api::INTEGER, sizeof(double), {}},
+            {"value", odc::api::DOUBLE,  sizeof(double), {}},
+        };
+
+        dh.openForWrite(0);
+        eckit::AutoClose closer(dh);
+
+        for (size_t t = 0; t < numTables; ++t) {
+
+            std::vector<double> table(rowsPerTable, t);
+            std::vector<double> values(rowsPerTable);
+            for (size_t row = 0; row < rowsPerTable; ++row) values[row] = t * 1000.0 + row / 7.0;
+
+            std::vector<odc::api::ConstStridedData> strides {
+                {&table[0], rowsPerTable, sizeof(double), sizeof(double)},
+                {&values[0], rowsPerTable, sizeof(double), sizeof(double)},
+            };
+            odc::core::encodeFrame(dh, columns, strides, {});
+        }
+
+        return dh.position();
+    }
+
+    // Decode the tables as they are iterated, checking the values
+
+    void decodeTables(odc::core::TablesReader& reader) {
+
+        size_t t = 0;
+        for (auto& table : reader) {
+
+            EXPECT(table.rowCount() == rowsPerTable);
+
+            std::vector<double> values(2 * rowsPerTable);
+            std::vector<odc::api::StridedData> strides {
+                {&values[0], rowsPerTable, sizeof(double), sizeof(double)},
+                {&values[rowsPerTable], rowsPerTable, sizeof(double), sizeof(double)},
+            };
+
+            odc::core::DecodeTarget target({"table", "value"}, strides);
+            table.decode(target);
+
+            for (size_t row = 0; row < rowsPerTable; ++row) {
+                EXPECT(values[row] == t);
+                EXPECT(values[rowsPerTable + row] == t * 1000.0 + row / 7.0);
+            }
+            ++t;
+        }
+
+        EXPECT(t == numTables);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Tables decode correctly with read-ahead") {
+
+    eckit::MemoryHandle encoded;
+    size_t size = encodeTables(encoded);
+
+    for (size_t nframes : {0, 1, 3, 100}) {
+        for (size_t memory : {1, 20000, 1024 * 1024}) {
+
+            eckit::MemoryHandle dh(encoded.data(), size);
+            dh.openForRead();
+            eckit::AutoClose closer(dh);
+
+            odc::core::TablesReader reader(dh);
+            reader.readAhead(nframes, memory);
+            decodeTables(reader);
+
+            // Every table has either been prefetched, or the decoder had to wait for it
+
+            size_t hits;
+            size_t stalls;
+            reader.readAheadStatistics(hits, stalls);
+            EXPECT(hits + stalls == (nframes == 0 ? 0 : numTables));
+        }
+    }
+}
+
+CASE("Read-ahead stops cleanly when the reader is destroyed early") {
+
+    eckit::MemoryHandle encoded;
+    size_t size = encodeTables(encoded);
+
+    eckit::MemoryHandle dh(encoded.data(), size);
+    dh.openForRead();
+    eckit::AutoClose closer(dh);
+
+    odc::core::TablesReader reader(dh);
+    reader.readAhead(8, 1024 * 1024);
+
+    auto it = reader.begin();
+    EXPECT(it != reader.end());
+    EXPECT(it->rowCount() == rowsPerTable);
+}
+
+CASE("Read-ahead headers are decoded with the settings of the reading thread") {
+
+    eckit::MemoryHandle encoded;
+    size_t size = encodeTables(encoded);
+
+    // With integers as longs, the integer codecs decode 64-bit integers rather than doubles. The
+    // background thread, which reads the headers and so constructs the codecs, must do the same.
+
+    odc::ODBAPISettings::instance().treatIntegersAsDoubles(false);
+
+    eckit::MemoryHandle dh(encoded.data(), size);
+    dh.openForRead();
+    eckit::AutoClose closer(dh);
+
+    odc::core::TablesReader reader(dh);
+    reader.readAhead(3, 1024 * 1024);
+
+    size_t t = 0;
+    for (auto& table : reader) {
+
+        std::vector<int64_t> values(rowsPerTable);
+        std::vector<odc::api::StridedData> strides {
+            {&values[0], rowsPerTable, sizeof(int64_t), sizeof(int64_t)},
+        };
+
+        odc::core::DecodeTarget target({"table"}, strides);
+        table.decode(target);
+
+        for (size_t row = 0; row < rowsPerTable; ++row) EXPECT(values[row] == int64_t(t));
+        ++t;
+    }
+
+    odc::ODBAPISettings::instance().treatIntegersAsDoubles(true);
+
+    EXPECT(t == numTables);
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
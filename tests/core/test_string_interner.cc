@@ -0,0 +1,108 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "odc/codec/StringInterner.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+namespace {
+
+    // A zero padded string cell of the given width
+
+    std::vector<char> cell(const char* s, size_t width) {
+        std::vector<char> c(width, 0);
+        ::memcpy(&c[0], s, std::min(::strlen(s), width));
+        return c;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("Strings are numbered in the order that they are first seen") {
+
+    odc::codec::StringInterner interner;
+    EXPECT(interner.width() == 8);
+    EXPECT(interner.size() == 0);
+    EXPECT(interner.find(&cell("abc", 8)[0]) == -1);
+
+    bool added;
+    EXPECT(interner.intern(&cell("abc", 8)[0], added) == 0);
+    EXPECT(added);
+    EXPECT(interner.intern(&cell("12345678", 8)[0], added) == 1);
+    EXPECT(added);
+    EXPECT(interner.intern(&cell("abc", 8)[0], added) == 0);
+    EXPECT(!added);
+    EXPECT(interner.intern(&cell("", 8)[0], added) == 2);
+    EXPECT(added);
+
+    EXPECT(interner.size() == 3);
+    EXPECT(interner.find(&cell("12345678", 8)[0]) == 1);
+    EXPECT(interner.find(&cell("", 8)[0]) == 2);
+    EXPECT(interner.find(&cell("abcd", 8)[0]) == -1);
+}
+
+CASE("Strings end at the first null character") {
+
+    odc::codec::StringInterner interner;
+
+    const char padded[8] = {'a', 'b', 0, 0, 0, 0, 0, 0};
+    const char garbage[8] = {'a', 'b', 0, 'x', 'y', 0, 'z', 0};
+
+    bool added;
+    EXPECT(interner.intern(padded, added) == 0);
+    EXPECT(interner.intern(garbage, added) == 0);
+    EXPECT(!added);
+    EXPECT(interner.size() == 1);
+}
+
+CASE("Wide cells and many strings are interned correctly") {
+
+    for (size_t width : {8, 16, 32, 48}) {
+
+        odc::codec::StringInterner interner(width);
+        EXPECT(interner.width() == width);
+
+        // Enough strings that the table must grow several times
+
+        const size_t count = 5000;
+        char buffer[64];
+        bool added;
+        for (size_t i = 0; i < count; ++i) {
+            ::snprintf(buffer, sizeof(buffer), "%0*zu", int(width), i * 7919);
+            EXPECT(interner.intern(&cell(buffer, width)[0], added) == i);
+            EXPECT(added);
+        }
+
+        EXPECT(interner.size() == count);
+        for (size_t i = 0; i < count; ++i) {
+            ::snprintf(buffer, sizeof(buffer), "%0*zu", int(width), i * 7919);
+            EXPECT(interner.find(&cell(buffer, width)[0]) == int64_t(i));
+        }
+
+        interner.reset(sizeof(double));
+        EXPECT(interner.size() == 0);
+        EXPECT(interner.width() == sizeof(double));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 1996-2018 ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/testing/Test.h"
+
+#include "odc/core/ThreadPool.h"
+
+using namespace eckit::testing;
+
+// ------------------------------------------------------------------------------------------------------
+
+CASE("All of the tasks are run") {
+
+    for (size_t nthreads : {0, 1, 4}) {
+
+        odc::core::ThreadPool pool(nthreads);
+        EXPECT(pool.size() == nthreads);
+
+        std::vector<int> results(1000, 0);
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < results.size(); ++i) {
+            tasks.emplace_back([&results, i] { results[i] = int(i) * 2; });
+        }
+
+        pool.run(tasks);
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            EXPECT(results[i] == int(i) * 2);
+        }
+    }
+}
+
+CASE("Tasks may submit nested tasks") {
+
+    odc::core::ThreadPool pool(3);
+
+    std::atomic<size_t> count(0);
+    std::vector<std::function<void()>> tasks;
+
+    for (size_t i = 0; i < 8; ++i) {
+        tasks.emplace_back([&pool, &count] {
+            std::vector<std::function<void()>> inner;
+            for (size_t j = 0; j < 8; ++j) {
+                inner.emplace_back([&count] { ++count; });
+            }
+            pool.run(inner);
+        });
+    }
+
+    pool.run(tasks);
+    EXPECT(count == 64);
+}
+
+CASE("Exceptions thrown by tasks are rethrown once all tasks are complete") {
+
+    odc::core::ThreadPool pool(2);
+
+    std::atomic<size_t> count(0);
+    std::vector<std::function<void()>> tasks;
+
+    for (size_t i = 0; i < 10; ++i) {
+        tasks.emplace_back([&count, i] {
+            ++count;
+            if (i == 5) throw eckit::SeriousBug("Task failed", Here());
+        });
+    }
+
+    EXPECT_THROWS_AS(pool.run(tasks), eckit::SeriousBug);
+    EXPECT(count == 10);
+}
+
+CASE("The pool can be resized") {
+
+    odc::core::ThreadPool pool(2);
+
+    for (size_t nthreads : {4, 0, 1}) {
+
+        pool.resize(nthreads);
+        EXPECT(pool.size() == nthreads);
+
+        std::atomic<size_t> count(0);
+        std::vector<std::function<void()>> tasks(20, [&count] { ++count; });
+        pool.run(tasks);
+        EXPECT(count == 20);
+    }
+}
+
+CASE("Callers only run their own tasks while they wait") {
+
+    odc::core::ThreadPool pool(1);
+
+    // Another caller's tasks block until released. Its thread and the worker each take one.
+
+    std::atomic<size_t> started(0);
+    std::atomic<bool> release(false);
+    std::vector<std::thread::id> otherThreads(4);
+    std::vector<std::function<void()>> otherTasks;
+    for (size_t i = 0; i < otherThreads.size(); ++i) {
+        otherTasks.emplace_back([&, i] {
+            otherThreads[i] = std::this_thread::get_id();
+            ++started;
+            while (!release) std::this_thread::yield();
+        });
+    }
+
+    std::thread other([&pool, &otherTasks] { pool.run(otherTasks); });
+    while (started < 2) std::this_thread::yield();
+
+    // Our tasks are run (by us) while the other caller's tasks are still queued
+
+    std::atomic<size_t> count(0);
+    std::vector<std::function<void()>> tasks(4, [&count] { ++count; });
+    pool.run(tasks);
+    EXPECT(count == 4);
+    EXPECT(started == 2);
+
+    release = true;
+    other.join();
+
+    EXPECT(started == 4);
+    for (const std::thread::id& id : otherThreads) EXPECT(id != std::this_thread::get_id());
+}
+
+// ------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}